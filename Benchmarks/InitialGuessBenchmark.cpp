@@ -0,0 +1,116 @@
+#include "HeadlessRenderer.h"
+
+#include "Util/Logger.h"
+
+#include <QGuiApplication>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <string>
+
+using namespace DiffusionCurveRenderer;
+
+namespace
+{
+    constexpr int SCENE_SIZE = 1024;
+    const QString SCENE = DCR_RESOURCES_DIR "/CurveData/zephyr.xml";
+
+    // Passes are counted by adaptive smoothing, the limit only ends levels that do not converge
+    constexpr int SMOOTH_ITERATIONS = 1000;
+    constexpr int REPETITIONS = 5;
+
+    // Passes of every level of the reference that both guesses are compared to
+    constexpr int REFERENCE_ITERATIONS = 1000;
+
+    const char* ToString(DiffusionInitialGuess guess)
+    {
+        return guess == DiffusionInitialGuess::JumpFlood ? "jump flood" : "downsampled";
+    }
+
+    const char* ToString(DiffusionPasses passes)
+    {
+        return passes == DiffusionPasses::Compute ? "compute" : "fragment";
+    }
+
+    // Solves the scene with "guess" and logs the passes of every level, the mean time of a solve and the difference to "reference"
+    void Run(HeadlessRenderer& renderer, DiffusionPasses passes, DiffusionInitialGuess guess, const QImage& reference)
+    {
+        DiffusionRenderer* diffusion = renderer.GetDiffusionRenderer();
+        diffusion->SetPasses(passes);
+        diffusion->SetInitialGuess(guess);
+
+        // First solve compiles and allocates, it is not timed
+        QImage result = renderer.Render();
+        double milliseconds = 0;
+
+        for (int i = 0; i < REPETITIONS; ++i)
+        {
+            // Setting the iterations drops the cached result, so every render solves again
+            diffusion->SetSmoothIterations(SMOOTH_ITERATIONS);
+
+            const auto start = std::chrono::steady_clock::now();
+            result = renderer.Render();
+            const auto end = std::chrono::steady_clock::now();
+
+            milliseconds += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        // Work in passes over the finest level, a pass over a coarser level costs its share of the pixels
+        const QVector<int>& levelPasses = diffusion->GetLevelPasses();
+        const QVector<QSize>& levels = diffusion->GetPyramid().levels;
+        const double finestPixels = double(levels[0].width()) * levels[0].height();
+
+        int totalPasses = 0;
+        double work = 0;
+        std::string passesPerLevel;
+
+        for (int i = 0; i < levelPasses.size(); ++i)
+        {
+            totalPasses += levelPasses[i];
+            work += levelPasses[i] * double(levels[i].width()) * levels[i].height() / finestPixels;
+            passesPerLevel += std::format("{}{}", i == 0 ? "" : ", ", levelPasses[i]);
+        }
+
+        const ImageDifference difference = CompareImages(result, reference, 2);
+
+        LOG_INFO("{} passes, {} guess: {} passes ({} from the finest level), work of {:.1f} finest level passes, {:.2f} ms per solve, "
+                 "mean difference to the reference is {:.4f}.",
+                 ToString(passes),
+                 ToString(guess),
+                 totalPasses,
+                 passesPerLevel,
+                 work,
+                 milliseconds / REPETITIONS,
+                 difference.mean);
+    }
+}
+
+// Solves a fixed scene with both initial guesses under adaptive smoothing until the mean change of a sweep is below the tolerance
+// and compares the results to REFERENCE_ITERATIONS passes of every level
+int main(int argc, char* argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    HeadlessRenderer renderer;
+
+    if (!renderer.Initialize(SCENE_SIZE) || !renderer.LoadScene(SCENE))
+        return EXIT_FAILURE;
+
+    DiffusionRenderer* diffusion = renderer.GetDiffusionRenderer();
+    diffusion->SetBackend(DiffusionBackend::Gpu);
+    diffusion->SetPasses(DiffusionPasses::Fragment);
+    diffusion->SetSmoothIterations(REFERENCE_ITERATIONS);
+
+    const QImage reference = renderer.Render();
+
+    diffusion->SetAdaptiveSmoothing(true);
+    diffusion->SetSmoothIterations(SMOOTH_ITERATIONS);
+
+    for (const DiffusionPasses passes : { DiffusionPasses::Fragment, DiffusionPasses::Compute })
+    {
+        Run(renderer, passes, DiffusionInitialGuess::Downsampled, reference);
+        Run(renderer, passes, DiffusionInitialGuess::JumpFlood, reference);
+    }
+
+    return EXIT_SUCCESS;
+}
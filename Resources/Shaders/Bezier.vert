@@ -1,10 +1,52 @@
 #version 450 core
 
-layout(location = 0) in float point;
+struct Patch
+{
+    int controlPointOffset;
+    int controlPointCount;
+    int leftColorOffset;
+    int leftColorCount;
+    int rightColorOffset;
+    int rightColorCount;
+    int curveIndex;
+    int curveType;
+    vec4 contourColor;
+    float contourThickness;
+    float diffusionWidth;
+    float diffusionGap;
+    int sampleOffset;
+};
+
+struct Sample
+{
+    vec2 position;
+    vec2 normal;
+    float parameter;
+    int patchIndex;
+};
+
+layout(std430, binding = 0) readonly buffer Patches
+{
+    Patch patches[];
+};
 
-out float gs_Point;
+layout(std430, binding = 4) readonly buffer Samples
+{
+    Sample samples[];
+};
+
+uniform mat4 projection;
+
+out vec4 fs_Color;
 
+// One triangle strip per patch, even vertices are on the left of the samples and odd vertices on the right
 void main()
 {
-    gs_Point = point;
+    Sample point = samples[gl_VertexID / 2];
+    Patch bezier = patches[point.patchIndex];
+
+    float offset = gl_VertexID % 2 == 0 ? 0.5 : -0.5;
+
+    gl_Position = projection * vec4(point.position + offset * bezier.contourThickness * point.normal, 0, 1);
+    fs_Color = bezier.contourColor;
 }
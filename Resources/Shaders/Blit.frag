@@ -2,11 +2,15 @@
 
 uniform sampler2D sourceTexture;
 
+// Maps the texture coordinates of the target to the source
+uniform vec2 scale;
+uniform vec2 offset;
+
 in vec2 fs_TextureCoords;
 
 out vec4 out_Color;
 
 void main()
 {
-    out_Color = texture(sourceTexture, fs_TextureCoords);
+    out_Color = texture(sourceTexture, offset + scale * fs_TextureCoords);
 }
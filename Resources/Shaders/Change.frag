@@ -0,0 +1,25 @@
+#version 450 core
+
+uniform sampler2D previousTexture;
+uniform sampler2D currentTexture;
+
+// Level of both textures that is compared
+uniform int level;
+
+// -1 compares every pixel, 0 or 1 only the pixels updated by a red-black pass of the same parity
+uniform int parity;
+
+// Largest channel difference of a pixel between the textures, the change of its last update. It is proportional
+// to the residual of the smoother but rounded like the RGBA8 textures.
+layout(location = 0) out float outChange;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+
+    if (0 <= parity && ((coords.x + coords.y) & 1) != parity)
+        discard;
+
+    vec4 difference = abs(texelFetch(currentTexture, coords, level) - texelFetch(previousTexture, coords, level));
+    outChange = max(max(difference.r, difference.g), max(difference.b, difference.a));
+}
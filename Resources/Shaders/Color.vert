@@ -0,0 +1,96 @@
+#version 450 core
+
+struct Patch
+{
+    int controlPointOffset;
+    int controlPointCount;
+    int leftColorOffset;
+    int leftColorCount;
+    int rightColorOffset;
+    int rightColorCount;
+    int curveIndex;
+    int curveType;
+    vec4 contourColor;
+    float contourThickness;
+    float diffusionWidth;
+    float diffusionGap;
+    int sampleOffset;
+};
+
+struct Sample
+{
+    vec2 position;
+    vec2 normal;
+    float parameter;
+    int patchIndex;
+};
+
+layout(std430, binding = 0) readonly buffer Patches
+{
+    Patch patches[];
+};
+
+layout(std430, binding = 4) readonly buffer Samples
+{
+    Sample samples[];
+};
+
+layout(std430, binding = 2) readonly buffer Colors
+{
+    vec4 colors[];
+};
+
+layout(std430, binding = 3) readonly buffer ColorPositions
+{
+    float colorPositions[];
+};
+
+uniform mat4 projection;
+
+out vec4 fs_Color;
+
+// Colors [offset, offset + count) of the color buffer interpolated at t
+vec4 colorAt(int offset, int count, float t)
+{
+    if (count == 0)
+        return vec4(0);
+
+    for (int i = offset + 1; i < offset + count; i++)
+    {
+        float t0 = colorPositions[i - 1];
+        float t1 = colorPositions[i];
+
+        if (t0 <= t && t <= t1)
+            return mix(colors[i - 1], colors[i], (t - t0) / (t1 - t0));
+    }
+
+    if (t < colorPositions[offset])
+        return colors[offset];
+
+    if (colorPositions[offset + count - 1] < t)
+        return colors[offset + count - 1];
+
+    return vec4(0);
+}
+
+// Two triangle strips per patch, the left side is instance 0 and the right side is instance 1.
+// Even vertices are on the inner edge of a strip, odd vertices on the outer edge.
+void main()
+{
+    Sample point = samples[gl_VertexID / 2];
+    Patch bezier = patches[point.patchIndex];
+
+    float t = point.parameter;
+    float offset = 0.5f * bezier.diffusionGap + (gl_VertexID % 2) * bezier.diffusionWidth;
+
+    if (gl_InstanceID == 0)
+    {
+        gl_Position = projection * vec4(point.position - offset * point.normal, 0, 1);
+        fs_Color = colorAt(bezier.leftColorOffset, bezier.leftColorCount, t);
+    }
+    else
+    {
+        gl_Position = projection * vec4(point.position + offset * point.normal, 0, 1);
+        fs_Color = colorAt(bezier.rightColorOffset, bezier.rightColorCount, t);
+    }
+}
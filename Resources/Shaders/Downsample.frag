@@ -2,28 +2,28 @@
 
 uniform sampler2D colorTexture;
 
-in vec2 fs_TextureCoords;
+// Level of "colorTexture" that is downsampled, the target pixel covers its texels 2x and 2x + 1
+uniform int sourceLevel;
 
 layout(location = 0) out vec4 outColor;
 
 void main()
 {
-    float uStep = 1.0f / textureSize(colorTexture, 0).x;
-    float vStep = 1.0f / textureSize(colorTexture, 0).y;
+    ivec2 last = textureSize(colorTexture, sourceLevel) - 1;
+    ivec2 c = min(2 * ivec2(gl_FragCoord.xy) + 1, last);
 
-    vec2 nw = vec2(fs_TextureCoords.s - uStep, fs_TextureCoords.t + vStep);
-    vec2 n = vec2(fs_TextureCoords.s, fs_TextureCoords.t + vStep);
-    vec2 ne = vec2(fs_TextureCoords.s + uStep, fs_TextureCoords.t + vStep);
+    ivec2 nw = clamp(c + ivec2(-1, 1), ivec2(0), last);
+    ivec2 n = clamp(c + ivec2(0, 1), ivec2(0), last);
+    ivec2 ne = clamp(c + ivec2(1, 1), ivec2(0), last);
 
-    vec2 w = vec2(fs_TextureCoords.s - uStep, fs_TextureCoords.t);
-    vec2 c = vec2(fs_TextureCoords.s, fs_TextureCoords.t);
-    vec2 e = vec2(fs_TextureCoords.s + uStep, fs_TextureCoords.t);
+    ivec2 w = clamp(c + ivec2(-1, 0), ivec2(0), last);
+    ivec2 e = clamp(c + ivec2(1, 0), ivec2(0), last);
 
-    vec2 sw = vec2(fs_TextureCoords.s - uStep, fs_TextureCoords.t - vStep);
-    vec2 s = vec2(fs_TextureCoords.s, fs_TextureCoords.t - vStep);
-    vec2 se = vec2(fs_TextureCoords.s + uStep, fs_TextureCoords.t - vStep);
+    ivec2 sw = clamp(c + ivec2(-1, -1), ivec2(0), last);
+    ivec2 s = clamp(c + ivec2(0, -1), ivec2(0), last);
+    ivec2 se = clamp(c + ivec2(1, -1), ivec2(0), last);
 
-    vec2 vectors[9];
+    ivec2 vectors[9];
     vectors[0] = nw;
     vectors[1] = n;
     vectors[2] = ne;
@@ -48,7 +48,7 @@ void main()
     vec4 colors[9];
 
     for (int i = 0; i < 9; i++)
-        colors[i] = texture(colorTexture, vectors[i]);
+        colors[i] = texelFetch(colorTexture, vectors[i], sourceLevel);
 
     float colorTotalWeight = 0;
     vec4 color = vec4(0);
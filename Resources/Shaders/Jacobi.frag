@@ -1,34 +1,41 @@
 #version 450 core
 
-in vec2 fs_TextureCoords;
-
 uniform sampler2D colorConstrainedTexture;
 uniform sampler2D colorTargetTexture;
 
+// -1 updates every pixel, 0 or 1 only the pixels with (x + y) % 2 == parity (red-black ordering)
+uniform int parity;
+
+// Relaxation factor, 1 replaces the pixel with the weighted mean of its neighbors
+uniform float omega;
+
+// Level of the textures that is smoothed
+uniform int level;
+
 layout(location = 0) out vec4 outColor;
 
 void main()
 {
-    float uStep = 1.0f / textureSize(colorConstrainedTexture, 0).x;
-    float vStep = 1.0f / textureSize(colorConstrainedTexture, 0).y;
+    ivec2 last = textureSize(colorConstrainedTexture, level) - 1;
 
     // nw n ne
     // w  c e
     // sw s se
 
-    vec2 nw = vec2(fs_TextureCoords.s - uStep, fs_TextureCoords.t + vStep);
-    vec2 n = vec2(fs_TextureCoords.s, fs_TextureCoords.t + vStep);
-    vec2 ne = vec2(fs_TextureCoords.s + uStep, fs_TextureCoords.t + vStep);
+    ivec2 c = ivec2(gl_FragCoord.xy);
+
+    ivec2 nw = clamp(c + ivec2(-1, 1), ivec2(0), last);
+    ivec2 n = clamp(c + ivec2(0, 1), ivec2(0), last);
+    ivec2 ne = clamp(c + ivec2(1, 1), ivec2(0), last);
 
-    vec2 w = vec2(fs_TextureCoords.s - uStep, fs_TextureCoords.t);
-    vec2 c = vec2(fs_TextureCoords.s, fs_TextureCoords.t);
-    vec2 e = vec2(fs_TextureCoords.s + uStep, fs_TextureCoords.t);
+    ivec2 w = clamp(c + ivec2(-1, 0), ivec2(0), last);
+    ivec2 e = clamp(c + ivec2(1, 0), ivec2(0), last);
 
-    vec2 sw = vec2(fs_TextureCoords.s - uStep, fs_TextureCoords.t - vStep);
-    vec2 s = vec2(fs_TextureCoords.s, fs_TextureCoords.t - vStep);
-    vec2 se = vec2(fs_TextureCoords.s + uStep, fs_TextureCoords.t - vStep);
+    ivec2 sw = clamp(c + ivec2(-1, -1), ivec2(0), last);
+    ivec2 s = clamp(c + ivec2(0, -1), ivec2(0), last);
+    ivec2 se = clamp(c + ivec2(1, -1), ivec2(0), last);
 
-    vec2 vectors[9];
+    ivec2 vectors[9];
     vectors[0] = nw;
     vectors[1] = n;
     vectors[2] = ne;
@@ -50,8 +57,26 @@ void main()
     weights[7] = 2; // s
     weights[8] = 1;
 
+    // Red-black passes use the 5-point stencil, diagonal neighbors have the same color
+    if (0 <= parity)
+    {
+        weights[0] = 0;
+        weights[2] = 0;
+        weights[4] = 0;
+        weights[6] = 0;
+        weights[8] = 0;
+    }
+
+    vec4 previous = texelFetch(colorTargetTexture, c, level);
+
+    if (0 <= parity && ((c.x + c.y) & 1) != parity)
+    {
+        outColor = previous;
+        return;
+    }
+
     // Colors
-    vec4 color = texture(colorConstrainedTexture, fs_TextureCoords);
+    vec4 color = texelFetch(colorConstrainedTexture, c, level);
 
     if (color.a > 0.1f)
     {
@@ -62,7 +87,7 @@ void main()
         vec4 colors[9];
 
         for (int i = 0; i < 9; i++)
-            colors[i] = texture(colorTargetTexture, vectors[i]);
+            colors[i] = texelFetch(colorTargetTexture, vectors[i], level);
 
         float totalWeight = 0;
         vec4 color = vec4(0, 0, 0, 0);
@@ -77,8 +102,8 @@ void main()
         }
 
         if (totalWeight > 0)
-            outColor = color / totalWeight;
+            outColor = mix(previous, color / totalWeight, omega);
         else
-            outColor = vec4(1, 1, 1, 1);
+            outColor = mix(previous, vec4(1, 1, 1, 1), omega);
     }
 }
@@ -0,0 +1,44 @@
+#version 450 core
+
+uniform sampler2D seedTexture;
+
+// Distance to the neighbors whose seeds are considered, halved after every pass
+uniform int step;
+
+layout(location = 0) out vec2 outSeed;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+    ivec2 last = textureSize(seedTexture, 0) - 1;
+
+    vec2 nearest = vec2(-1, -1);
+    float nearestDistance = 0;
+
+    for (int y = -1; y <= 1; y++)
+    {
+        for (int x = -1; x <= 1; x++)
+        {
+            ivec2 neighbor = coords + step * ivec2(x, y);
+
+            if (any(lessThan(neighbor, ivec2(0))) || any(greaterThan(neighbor, last)))
+                continue;
+
+            vec2 seed = texelFetch(seedTexture, neighbor, 0).xy;
+
+            if (seed.x < 0)
+                continue;
+
+            vec2 difference = seed - vec2(coords);
+            float distance = dot(difference, difference);
+
+            if (nearest.x < 0 || distance < nearestDistance)
+            {
+                nearest = seed;
+                nearestDistance = distance;
+            }
+        }
+    }
+
+    outSeed = nearest;
+}
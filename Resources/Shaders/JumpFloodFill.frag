@@ -0,0 +1,33 @@
+#version 450 core
+
+// Nearest seeds of the finest level
+uniform sampler2D seedTexture;
+uniform sampler2D constraintTexture;
+
+// Level of "constraintTexture" that is filled
+uniform int level;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+    vec4 constraint = texelFetch(constraintTexture, coords, level);
+
+    // Constrained pixels keep their downsampled color like the upsampling
+    if (constraint.a > 0.1f)
+    {
+        outColor = constraint;
+        return;
+    }
+
+    // Nearest seed of the finest pixel at the center of the pixel
+    ivec2 finest = min(coords * (1 << level) + (1 << level) / 2, textureSize(seedTexture, 0) - 1);
+    vec2 seed = texelFetch(seedTexture, finest, 0).xy;
+
+    // Without any constraint the level stays empty like the downsampled one
+    if (seed.x < 0)
+        outColor = vec4(0, 0, 0, 0);
+    else
+        outColor = texelFetch(constraintTexture, ivec2(seed), 0);
+}
@@ -0,0 +1,19 @@
+#version 450 core
+
+uniform sampler2D constraintTexture;
+
+// Level of "constraintTexture" whose constrained pixels are the seeds
+uniform int level;
+
+layout(location = 0) out vec2 outSeed;
+
+void main()
+{
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+
+    // Constrained pixels are their own seed, the others have none yet
+    if (texelFetch(constraintTexture, coords, level).a > 0.1f)
+        outSeed = vec2(coords);
+    else
+        outSeed = vec2(-1, -1);
+}
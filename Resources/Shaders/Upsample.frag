@@ -1,19 +1,22 @@
 #version 450 core
 
-in vec2 fs_TextureCoords;
-
 uniform sampler2D colorSourceTexture;
 uniform sampler2D colorTargetTexture;
 
+// Level of the target, the source is read one level coarser
+uniform int level;
+
 layout(location = 0) out vec4 outColor;
 
 void main()
 {
+    ivec2 coords = ivec2(gl_FragCoord.xy);
+
     // Color
-    vec4 color = texture(colorTargetTexture, fs_TextureCoords);
+    vec4 color = texelFetch(colorTargetTexture, coords, level);
 
     if (color.a > 0.1f)
         outColor = color;
     else
-        outColor = texture(colorSourceTexture, fs_TextureCoords);
+        outColor = texelFetch(colorSourceTexture, coords / 2, level + 1);
 }
@@ -8,8 +8,13 @@ namespace DiffusionCurveRenderer
     extern const std::string COLOR_RENDERER = "ColorRenderer";
     extern const std::string DOWNSAMPLE_RENDERER = "DownsampleRenderer";
     extern const std::string UPSAMPLE_RENDERER = "UpsampleRenderer";
+    extern const std::string UPSAMPLE_RENDERER_REFINE = "UpsampleRenderer::Refine";
+    extern const std::string CPU_DIFFUSION_RENDERER = "CpuDiffusionRenderer";
+    extern const std::string CPU_DIFFUSION_FACTORIZE = "CpuDiffusionRenderer::Factorize";
+    extern const std::string UPSAMPLE_RENDERER_LEVEL = "UpsampleRenderer::Level";
+    extern const std::string CPU_DIFFUSION_RENDERER_LEVEL = "CpuDiffusionRenderer::Level";
     extern const std::string BLUR_RENDERER = "BlurRenderer";
-    extern const std::string CURVE_SELECTION_RENDERER = "CurveSelectionRenderer";
+    extern const std::string PATCH_BUFFER = "PatchBuffer";
     extern const std::string RENDERER_MANAGER = "RendererManager";
     extern const std::string CURVE_CONTAINER_GET_CURVE_AROUND = "CurveContainer::GetCurveAround";
     extern const std::string BEZIER_FIND_COLOR_POINT_AROUND = "Bezier::FindColorPointAround";
@@ -19,8 +24,11 @@ namespace DiffusionCurveRenderer
         COLOR_RENDERER,
         DOWNSAMPLE_RENDERER,
         UPSAMPLE_RENDERER,
+        UPSAMPLE_RENDERER_REFINE,
+        CPU_DIFFUSION_RENDERER,
+        CPU_DIFFUSION_FACTORIZE,
         BLUR_RENDERER,
-        CURVE_SELECTION_RENDERER,
+        PATCH_BUFFER,
         RENDERER_MANAGER,
         CURVE_CONTAINER_GET_CURVE_AROUND,
         BEZIER_FIND_COLOR_POINT_AROUND
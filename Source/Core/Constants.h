@@ -17,12 +17,52 @@ namespace DiffusionCurveRenderer
     constexpr float DEFAULT_BLUR_STRENGTH = 0.25f;
     constexpr int DEFAULT_SMOOTH_ITERATIONS = 20;
 
+    // Smoothing
+    constexpr float DEFAULT_CHANGE_TOLERANCE = 0.0001f; // Mean absolute change of the last update of a pixel, colors are in [0, 1]
+    constexpr float DEFAULT_RELAXATION_FACTOR = 1.5f;   // Red-black SOR, 1 is Gauss-Seidel
+    constexpr int CHANGE_CHECK_INTERVAL = 2;            // Sweeps between two change measurements in adaptive mode
+
+    // Compute passes, same as the defines of Downsample.comp and Smooth.comp
+    constexpr int COMPUTE_DOWNSAMPLE_TILE_SIZE = 16; // Target texels per side of a work group
+    constexpr int COMPUTE_SMOOTH_TILE_SIZE = 32;     // Texels per side of a work group, without the halo
+    constexpr int COMPUTE_MAXIMUM_PASSES = 8;        // Smoothing passes per dispatch, the width of the halo
+
+    static_assert(2 * CHANGE_CHECK_INTERVAL <= COMPUTE_MAXIMUM_PASSES);
+
     // General render settings
     constexpr int NUMBER_OF_INTERVALS = 100;
     constexpr int DEFAULT_FRAMEBUFFER_SIZE = 2048;
+    constexpr int FRAMES_PER_RENDER_REQUEST = 3;
+
+    // Adaptive tessellation
+    constexpr int MIN_SEGMENTS_PER_PATCH = 4;
+    constexpr int MAX_SEGMENTS_PER_PATCH = 256;
+    constexpr float DEFAULT_TESSELLATION_TOLERANCE = 0.25f; // Pixels, distance between a patch and its segments
+    constexpr float MAXIMUM_SEGMENT_LENGTH = 16.0f;         // Pixels, keeps normals and colors smooth along straight patches
+    constexpr int DEFAULT_TESSELLATION_BUDGET = 1 << 21;    // Segments of all patches
+
+    // Diffusion pyramid
+    constexpr int MAXIMUM_FRAMEBUFFER_SIZE = 8192;
+    constexpr float DEFAULT_RESOLUTION_SCALE = 1.0f;     // Texels per pixel of the viewport
+    constexpr float MINIMUM_RESOLUTION_SCALE = 0.05f;
+    constexpr int DEFAULT_MINIMUM_LEVEL_SIZE = 4;        // Pixels, shorter side of the coarsest level, at least 4
+    constexpr int DEFAULT_DIFFUSION_MEMORY_BUDGET = 128; // MiB of framebuffers in the memory budget mode
 
-    // Curve selection (Obsolete)
-    constexpr float DEFAULT_CURVE_SELECTION_WIDTH = 20.0f;
+    // Diffusion cache
+    constexpr float DIFFUSION_CACHE_MARGIN = 0.25f;                // Added around the scene, relative to its size
+    constexpr float DIFFUSION_CACHE_MAXIMUM_MAGNIFICATION = 1.5f; // Screen pixels per texel before the cache is solved again
+
+    // Warm start, edits of single curves only smooth the previous result around them until the edits stop
+    constexpr int WARM_START_MARGIN = 32;            // Texels of the finest level smoothed around the changed curves
+    constexpr float WARM_START_MAXIMUM_AREA = 0.25f; // Of the finest level, larger changes are solved in full
+    constexpr int WARM_START_REFINE_FRAMES = 2;      // Frames without edits before the result is solved in full
+
+    // CPU diffusion
+    constexpr int DEFAULT_DIRECT_SOLVE_SIZE = 256; // Pixels, longer side of the finest level solved with the cached factorization
+
+    // Curve picking
+    constexpr float CURVE_PICKING_RADIUS_PX = 10.0f; // Pixels
+    constexpr float SPATIAL_INDEX_CELL_SIZE = 64.0f;  // World units
 
     // Overlay painter (Gui)
     constexpr float HANDLE_OUTER_DISK_RADIUS_PX = 15.0f; // Pixels
@@ -37,11 +77,18 @@ namespace DiffusionCurveRenderer
     extern const std::string COLOR_RENDERER;
     extern const std::string DOWNSAMPLE_RENDERER;
     extern const std::string UPSAMPLE_RENDERER;
+    extern const std::string UPSAMPLE_RENDERER_REFINE;
+    extern const std::string CPU_DIFFUSION_RENDERER;
+    extern const std::string CPU_DIFFUSION_FACTORIZE;
     extern const std::string BLUR_RENDERER;
-    extern const std::string CURVE_SELECTION_RENDERER;
+    extern const std::string PATCH_BUFFER;
     extern const std::string RENDERER_MANAGER;
     extern const std::string CURVE_CONTAINER_GET_CURVE_AROUND;
     extern const std::string BEZIER_FIND_COLOR_POINT_AROUND;
 
+    // Prefixes of the per level IDs
+    extern const std::string UPSAMPLE_RENDERER_LEVEL;
+    extern const std::string CPU_DIFFUSION_RENDERER_LEVEL;
+
     extern const std::vector<std::string> ALL_CHORONOMETER_IDs;
 }
@@ -132,6 +132,16 @@ DiffusionCurveRenderer::Controller::Controller(QObject* parent)
     connect(mVectorizationManager, &VectorizationManager::ImageLoaded, this, &Controller::OnImageLoaded, Qt::QueuedConnection);
     connect(mVectorizationManager, &VectorizationManager::VectorizationStageFinished, this, &Controller::OnVectorizationStageFinished, Qt::QueuedConnection);
     connect(mVectorizationManager, &VectorizationManager::VectorizationFinished, this, &Controller::OnVectorizationFinished, Qt::QueuedConnection);
+
+    // Frames are rendered on demand, input events request them in Window
+    connect(mVectorizationManager, &VectorizationManager::ProgressChanged, mWindow, &Window::RequestRender, Qt::QueuedConnection);
+    connect(mVectorizationManager, &VectorizationManager::VectorizationStageChanged, mWindow, &Window::RequestRender, Qt::QueuedConnection);
+    connect(mVectorizationManager, &VectorizationManager::ImageLoaded, mWindow, &Window::RequestRender, Qt::QueuedConnection);
+    connect(mVectorizationManager, &VectorizationManager::VectorizationStageFinished, mWindow, &Window::RequestRender, Qt::QueuedConnection);
+    connect(mVectorizationManager, &VectorizationManager::VectorizationFinished, mWindow, &Window::RequestRender, Qt::QueuedConnection);
+    connect(mEventHandler, &EventHandler::ControlPointAroundChanged, mWindow, &Window::RequestRender);
+    connect(mEventHandler, &EventHandler::ColorPointAroundChanged, mWindow, &Window::RequestRender);
+    connect(mImGuiWindow, &ImGuiWindow::ContinuousRenderingChanged, mWindow, &Window::SetContinuousRendering);
 }
 
 DiffusionCurveRenderer::Controller::~Controller()
@@ -185,8 +195,14 @@ void DiffusionCurveRenderer::Controller::Render(float ifps)
             mRendererManager->Clear();
 
             if (mRenderModes.testAnyFlag(RenderMode::Diffusion))
+            {
                 mRendererManager->RenderDiffusion();
 
+                // Frames until the warm started result is solved in full
+                if (mRendererManager->NeedsDiffusionRefinement())
+                    mWindow->RequestRender();
+            }
+
             if (mRenderModes.testAnyFlag(RenderMode::Contour))
                 mRendererManager->RenderContours();
 
@@ -234,11 +250,7 @@ void DiffusionCurveRenderer::Controller::Resize(int width, int height)
     mWidth = width * mDevicePixelRatio;
     mHeight = height * mDevicePixelRatio;
 
-    mWindow->makeCurrent();
     mCamera->Resize(mWidth, mHeight, mDevicePixelRatio);
-
-    mRendererManager->Resize(mWidth, mHeight);
-    mWindow->doneCurrent();
 }
 
 void DiffusionCurveRenderer::Controller::OnMousePressed(QMouseEvent* event)
@@ -258,16 +270,21 @@ void DiffusionCurveRenderer::Controller::OnMouseReleased(QMouseEvent* event)
 
 void DiffusionCurveRenderer::Controller::OnMouseMoved(QMouseEvent* event)
 {
-    if (ImGui::GetIO().WantCaptureMouse)
+    // ImGui highlights the widgets under the cursor, it needs frames while the cursor is over the controls
+    if (ImGui::GetIO().WantCaptureMouse || mImGuiWindow->Contains(event->position()))
     {
+        mWindow->RequestRender();
         return;
     }
 
-    mWindow->makeCurrent();
-    mRendererManager->RenderForCurveSelection();
-    mWindow->doneCurrent();
+    const quint64 cameraRevision = mCamera->GetRevision();
+    const quint64 curveRevision = mCurveContainer->GetRevision();
 
     mEventHandler->OnMouseMoved(event);
+
+    // Hover highlight changes request frames through the signals of EventHandler
+    if (cameraRevision != mCamera->GetRevision() || curveRevision != mCurveContainer->GetRevision())
+        mWindow->RequestRender();
 }
 
 void DiffusionCurveRenderer::Controller::OnWheelMoved(QWheelEvent* event)
@@ -3,24 +3,144 @@
 #include "Util/Chronometer.h"
 #include "Util/Logger.h"
 
+#include <algorithm>
+
 void DiffusionCurveRenderer::CurveContainer::AddCurve(CurvePtr curve)
 {
     mCurves << curve;
+    mSpatialIndex.Insert(curve);
+    RecordChange(curve, curve->GetBoundingBox(), false);
 }
 
 void DiffusionCurveRenderer::CurveContainer::AddCurves(QList<CurvePtr> curves)
 {
     mCurves.append(curves);
+
+    for (const auto& curve : curves)
+    {
+        mSpatialIndex.Insert(curve);
+        mStripWidths.insert(curve.get(), GetStripWidth(curve));
+    }
+
+    ++mRevision;
 }
 
 void DiffusionCurveRenderer::CurveContainer::RemoveCurve(CurvePtr curve)
 {
+    const BoundingBox box = mSpatialIndex.GetBoundingBox(curve);
+
     mCurves.removeAll(curve);
+    mSpatialIndex.Remove(curve);
+    RecordChange(curve, box, false);
+    mStripWidths.remove(curve.get());
 }
 
 void DiffusionCurveRenderer::CurveContainer::Clear()
 {
     mCurves.clear();
+    mSpatialIndex.Clear();
+    mStripWidths.clear();
+    ++mRevision;
+}
+
+void DiffusionCurveRenderer::CurveContainer::UpdateCurve(CurvePtr curve)
+{
+    // The index still has the boxes of the previous geometry
+    BoundingBox box = mSpatialIndex.GetBoundingBox(curve);
+
+    mSpatialIndex.Update(curve);
+
+    box.Expand(curve->GetBoundingBox());
+    RecordChange(curve, box, true);
+}
+
+void DiffusionCurveRenderer::CurveContainer::MarkAsChanged(CurvePtr curve)
+{
+    RecordChange(curve, curve->GetBoundingBox(), true);
+}
+
+bool DiffusionCurveRenderer::CurveContainer::GetChangedRegion(quint64 revision, BoundingBox& region) const
+{
+    region = BoundingBox();
+
+    int first;
+
+    if (!FindChanges(revision, first))
+        return false;
+
+    for (int i = first; i < mChanges.size(); ++i)
+        region.Expand(mChanges[i].region);
+
+    return true;
+}
+
+bool DiffusionCurveRenderer::CurveContainer::GetChangedCurves(quint64 revision, QVector<CurvePtr>& curves) const
+{
+    curves.clear();
+
+    int first;
+
+    if (!FindChanges(revision, first))
+        return false;
+
+    for (int i = first; i < mChanges.size(); ++i)
+    {
+        if (mChanges[i].curve == nullptr)
+            return false;
+
+        if (!curves.contains(mChanges[i].curve))
+            curves << mChanges[i].curve;
+    }
+
+    return true;
+}
+
+bool DiffusionCurveRenderer::CurveContainer::FindChanges(quint64 revision, int& first) const
+{
+    const quint64 numberOfChanges = mRevision - revision;
+
+    first = mChanges.size();
+
+    if (numberOfChanges == 0)
+        return true;
+
+    // Every revision after "revision" must be a recorded change
+    if (quint64(mChanges.size()) < numberOfChanges)
+        return false;
+
+    first = mChanges.size() - int(numberOfChanges);
+
+    return mChanges.last().revision == mRevision && mChanges[first].revision == revision + 1;
+}
+
+void DiffusionCurveRenderer::CurveContainer::RecordChange(const CurvePtr& curve, const BoundingBox& box, bool inPlace)
+{
+    ++mRevision;
+
+    if (mChanges.size() == MAX_RECORDED_CHANGES)
+        mChanges.removeFirst();
+
+    // Colors are rendered into strips beside the curve
+    const float stripWidth = GetStripWidth(curve);
+    const float previousStripWidth = mStripWidths.value(curve.get(), stripWidth);
+
+    mChanges << Change{ mRevision, box.Padded(std::max(stripWidth, previousStripWidth)), inPlace ? curve : nullptr };
+    mStripWidths.insert(curve.get(), stripWidth);
+}
+
+float DiffusionCurveRenderer::CurveContainer::GetStripWidth(const CurvePtr& curve)
+{
+    return 0.5f * curve->GetDiffusionGap() + curve->GetDiffusionWidth();
+}
+
+DiffusionCurveRenderer::BoundingBox DiffusionCurveRenderer::CurveContainer::GetBoundingBox() const
+{
+    BoundingBox box;
+
+    for (const auto& curve : mCurves)
+        box.Expand(curve->GetBoundingBox());
+
+    return box;
 }
 
 DiffusionCurveRenderer::CurvePtr DiffusionCurveRenderer::CurveContainer::GetCurve(int index)
@@ -33,32 +153,27 @@ DiffusionCurveRenderer::CurvePtr DiffusionCurveRenderer::CurveContainer::GetCurv
 {
     MEASURE_CALL_TIME(CURVE_CONTAINER_GET_CURVE_AROUND);
 
-    float minDistance = std::numeric_limits<float>::infinity();
-
-    CurvePtr result = nullptr;
-
-    for (const auto& curve : mCurves)
-    {
-        const float distance = curve->GetDistanceToPoint(test);
+    return mSpatialIndex.FindNearest(test, radius);
+}
 
-        if (distance < minDistance)
-        {
-            result = curve;
-            minDistance = distance;
-        }
-    }
+QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::CurveContainer::GetCurvesAround(const QVector2D& test, float radius)
+{
+    return mSpatialIndex.FindInRadius(test, radius);
+}
 
-    if (radius < minDistance)
-    {
-        result = nullptr;
-    }
+QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::CurveContainer::GetCurvesInRectangle(const QVector2D& topLeft, const QVector2D& bottomRight)
+{
+    BoundingBox rectangle;
+    rectangle.Expand(topLeft);
+    rectangle.Expand(bottomRight);
 
-    return result;
+    return mSpatialIndex.FindInRectangle(rectangle);
 }
 
 void DiffusionCurveRenderer::CurveContainer::SetGlobalContourThickness(float val)
 {
     mGlobalContourThickness = val;
+    ++mRevision;
 
     for (const auto& curve : mCurves)
     {
@@ -69,26 +184,31 @@ void DiffusionCurveRenderer::CurveContainer::SetGlobalContourThickness(float val
 void DiffusionCurveRenderer::CurveContainer::SetGlobalDiffusionWidth(float val)
 {
     mGlobalDiffusionWidth = val;
+    ++mRevision;
 
     for (const auto& curve : mCurves)
     {
         curve->SetDiffusionWidth(mGlobalDiffusionWidth);
+        mStripWidths.insert(curve.get(), GetStripWidth(curve));
     }
 }
 
 void DiffusionCurveRenderer::CurveContainer::SetGlobalDiffusionGap(float val)
 {
     mGlobalDiffusionGap = val;
+    ++mRevision;
 
     for (const auto& curve : mCurves)
     {
         curve->SetDiffusionWidth(mGlobalDiffusionGap);
+        mStripWidths.insert(curve.get(), GetStripWidth(curve));
     }
 }
 
 void DiffusionCurveRenderer::CurveContainer::SetGlobalBlurStrength(float val)
 {
     mGlobalBlurStrength = val;
+    ++mRevision;
 
     for (const auto& curve : mCurves)
     {
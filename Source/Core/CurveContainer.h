@@ -1,9 +1,11 @@
 #pragma once
 
+#include "Core/SpatialIndex.h"
 #include "Curve/Bezier.h"
 #include "Curve/Spline.h"
 #include "Util/Macros.h"
 
+#include <QHash>
 #include <QVector>
 
 namespace DiffusionCurveRenderer
@@ -18,10 +20,32 @@ namespace DiffusionCurveRenderer
         void RemoveCurve(CurvePtr curve);
         void Clear();
 
+        // Must be called after the geometry of a curve in the container changes
+        void UpdateCurve(CurvePtr curve);
+
+        // Must be called after anything else of a curve in the container changes, e.g. its colors or widths
+        void MarkAsChanged(CurvePtr curve);
+
+        // Incremented whenever the curves change, renderers compare against it to reuse their results
+        quint64 GetRevision() const { return mRevision; }
+
+        // World region of the changes after "revision", the boxes of the changed curves padded by their color strips.
+        // False if anything else changed since then, e.g. a global setting, or the revision is too old.
+        bool GetChangedRegion(quint64 revision, BoundingBox& region) const;
+
+        // Curves changed in place after "revision", each once. False if curves were added or removed since then
+        // or anything else changed, same as GetChangedRegion.
+        bool GetChangedCurves(quint64 revision, QVector<CurvePtr>& curves) const;
+
         CurvePtr GetCurve(int index);
         CurvePtr GetCurveAround(const QVector2D& test, float radius = 8.0f);
+        QVector<CurvePtr> GetCurvesAround(const QVector2D& test, float radius);
+        QVector<CurvePtr> GetCurvesInRectangle(const QVector2D& topLeft, const QVector2D& bottomRight);
         int GetTotalNumberOfCurves() const { return mCurves.size(); }
 
+        // Union of the boxes of the curves
+        BoundingBox GetBoundingBox() const;
+
         float GetGlobalContourThickness() { return mGlobalContourThickness; }
         float GetGlobalDiffusionWidth() { return mGlobalDiffusionWidth; }
         float GetGlobalDiffusionGap() { return mGlobalDiffusionGap; }
@@ -33,11 +57,41 @@ namespace DiffusionCurveRenderer
         void SetGlobalBlurStrength(float val);
 
       private:
-        DEFINE_MEMBER(QList<CurvePtr>, Curves);
+        struct Change
+        {
+            quint64 revision;
+            BoundingBox region;
+            CurvePtr curve; // Null if the curve was added or removed
+        };
+
+        // Increments the revision and records "box" of "curve" as the region of the change
+        void RecordChange(const CurvePtr& curve, const BoundingBox& box, bool inPlace);
+
+        // Index of the change after "revision" in "mChanges", false if not every change since then is recorded
+        bool FindChanges(quint64 revision, int& first) const;
+
+        // Distance from the curve to the outer edge of its color strips
+        static float GetStripWidth(const CurvePtr& curve);
+
+        DEFINE_MEMBER_CONST(QList<CurvePtr>, Curves);
+
+        SpatialIndex mSpatialIndex;
 
         float mGlobalContourThickness{ DEFAULT_CONTOUR_THICKNESS };
         float mGlobalDiffusionWidth{ DEFAULT_DIFFUSION_WIDTH };
         float mGlobalDiffusionGap{ DEFAULT_DIFFUSION_GAP };
         float mGlobalBlurStrength{ DEFAULT_BLUR_STRENGTH };
+
+        quint64 mRevision{ 1 };
+
+        // Last changes of single curves in the order of their revisions, a revision missing in between is
+        // any other change
+        QVector<Change> mChanges;
+
+        // Strip widths of the curves as of the last revision, a change pads by the wider of the previous and
+        // the current strips so that narrowing a strip covers the pixels it no longer reaches
+        QHash<const Curve*, float> mStripWidths;
+
+        static constexpr int MAX_RECORDED_CHANGES = 64;
     };
 }
\ No newline at end of file
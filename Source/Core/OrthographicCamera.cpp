@@ -5,6 +5,7 @@ void DiffusionCurveRenderer::OrthographicCamera::Resize(int width, int height, f
     mWidth = width;
     mHeight = height;
     mPixelRatio = pixelRatio;
+    ++mRevision;
 }
 
 void DiffusionCurveRenderer::OrthographicCamera::OnMousePressed(QMouseEvent* event)
@@ -35,6 +36,7 @@ void DiffusionCurveRenderer::OrthographicCamera::OnMouseMoved(QMouseEvent* event
         mTop += mPixelRatio * mZoom * mMouse.dy;
         mMouse.dx = 0;
         mMouse.dy = 0;
+        ++mRevision;
     }
 }
 
@@ -53,6 +55,7 @@ void DiffusionCurveRenderer::OrthographicCamera::OnWheelMoved(QWheelEvent* event
     QPointF delta = cursorWorldPosition - newWorldPosition;
     mLeft += delta.x();
     mTop += delta.y();
+    ++mRevision;
 }
 
 const QMatrix4x4& DiffusionCurveRenderer::OrthographicCamera::GetProjectionMatrix()
@@ -67,6 +70,14 @@ const QMatrix4x4& DiffusionCurveRenderer::OrthographicCamera::GetProjectionMatri
     return mProjectionMatrix;
 }
 
+DiffusionCurveRenderer::BoundingBox DiffusionCurveRenderer::OrthographicCamera::GetVisibleRegion() const
+{
+    BoundingBox visible;
+    visible.Expand(QVector2D(mLeft, mTop));
+    visible.Expand(QVector2D(mLeft + mWidth * mZoom, mTop + mHeight * mZoom));
+    return visible;
+}
+
 float DiffusionCurveRenderer::OrthographicCamera::GetAspectRatio() const
 {
     return mWidth / mHeight;
@@ -120,6 +131,7 @@ void DiffusionCurveRenderer::OrthographicCamera::Reset()
     mZoom = 1.0f;
     mTop = 0.0f;
     mLeft = 0.0f;
+    ++mRevision;
 }
 
 QVector2D DiffusionCurveRenderer::OrthographicCamera::WorldToCamera(float x, float y)
@@ -2,6 +2,7 @@
 
 #include "Core/Constants.h"
 #include "Core/EventListener.h"
+#include "Structs/BoundingBox.h"
 #include "Structs/Mouse.h"
 #include "Util/Macros.h"
 
@@ -26,6 +27,9 @@ namespace DiffusionCurveRenderer
 
         float GetAspectRatio() const;
 
+        // World region shown by the camera
+        BoundingBox GetVisibleRegion() const;
+
         QVector2D CameraToWorld(float x, float y);
         QVector2D CameraToWorld(const QVector2D& camera);
         QPointF CameraToWorld(const QPointF& camera);
@@ -39,6 +43,9 @@ namespace DiffusionCurveRenderer
 
         void Reset();
 
+        // Incremented whenever the projection changes
+        quint64 GetRevision() const { return mRevision; }
+
       private:
         DEFINE_MEMBER(float, PixelRatio, 1.0f);
         DEFINE_MEMBER(int, Width, INITIAL_WIDTH);
@@ -56,5 +63,7 @@ namespace DiffusionCurveRenderer
         float mTimeElapsed{ 0 };
 
         QMatrix4x4 mProjectionMatrix;
+
+        quint64 mRevision{ 1 };
     };
 }
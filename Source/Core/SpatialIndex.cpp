@@ -0,0 +1,359 @@
+#include "SpatialIndex.h"
+
+#include "Curve/Spline.h"
+#include "Util/Logger.h"
+
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+DiffusionCurveRenderer::SpatialIndex::SpatialIndex(float cellSize)
+    : mCellSize(cellSize)
+{
+    DCR_ASSERT(cellSize > 0);
+}
+
+void DiffusionCurveRenderer::SpatialIndex::Insert(CurvePtr curve)
+{
+    if (mCurves.contains(curve.get()))
+    {
+        Update(curve);
+        return;
+    }
+
+    CurveRecord& record = mCurves[curve.get()];
+    record.curve = curve;
+
+    for (const auto& patch : GetPatches(curve))
+        record.entries << AddEntry(curve.get(), patch);
+}
+
+void DiffusionCurveRenderer::SpatialIndex::Remove(CurvePtr curve)
+{
+    const auto it = mCurves.find(curve.get());
+
+    if (it == mCurves.end())
+        return;
+
+    for (const int index : it->entries)
+        RemoveEntry(index);
+
+    mCurves.erase(it);
+}
+
+void DiffusionCurveRenderer::SpatialIndex::Update(CurvePtr curve)
+{
+    const auto it = mCurves.find(curve.get());
+
+    if (it == mCurves.end())
+    {
+        Insert(curve);
+        return;
+    }
+
+    const auto patches = GetPatches(curve);
+    auto& entries = it->entries;
+
+    // Patches were added or removed
+    while (entries.size() > patches.size())
+        RemoveEntry(entries.takeLast());
+
+    while (entries.size() < patches.size())
+        entries << AddEntry(curve.get(), patches[entries.size()]);
+
+    // Only the entries that moved to other cells are relinked
+    for (int i = 0; i < patches.size(); ++i)
+    {
+        Entry& entry = mEntries[entries[i]];
+        entry.patch = patches[i];
+        entry.box = patches[i]->GetBoundingBox();
+
+        const CellRange cells = GetCellRange(entry.box);
+
+        if (cells != entry.cells)
+        {
+            UnlinkEntry(entries[i]);
+            LinkEntry(entries[i]);
+        }
+    }
+}
+
+void DiffusionCurveRenderer::SpatialIndex::Clear()
+{
+    mEntries.clear();
+    mFreeEntries.clear();
+    mOversizedEntries.clear();
+    mCells.clear();
+    mCurves.clear();
+    mExtent = CellRange{ 0, 0, -1, -1 };
+}
+
+DiffusionCurveRenderer::CurvePtr DiffusionCurveRenderer::SpatialIndex::FindNearest(const QVector2D& point, float radius, float* distance) const
+{
+    // Candidates are sorted by the distance to their boxes, which is a lower bound of the distance to their patches
+    QVarLengthArray<std::pair<float, int>, 64> candidates;
+
+    VisitEntries(BoundingBox{ point, point }.Padded(radius), [&](int index) {
+        const float bound = mEntries[index].box.DistanceTo(point);
+
+        if (bound <= radius)
+            candidates.append({ bound, index });
+    });
+
+    std::sort(candidates.begin(), candidates.end());
+
+    Curve* nearest = nullptr;
+    float minDistance = radius;
+
+    for (const auto& [bound, index] : candidates)
+    {
+        if (bound > minDistance)
+            break;
+
+        float patchDistance;
+        mEntries[index].patch->Project(point, patchDistance, minDistance);
+
+        if (patchDistance <= minDistance)
+        {
+            minDistance = patchDistance;
+            nearest = mEntries[index].curve;
+        }
+    }
+
+    if (nearest == nullptr)
+        return nullptr;
+
+    if (distance)
+        *distance = minDistance;
+
+    return mCurves.value(nearest).curve;
+}
+
+QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::SpatialIndex::FindInRadius(const QVector2D& point, float radius) const
+{
+    QVector<CurvePtr> result;
+
+    const quint32 stamp = ++mQueryStamp;
+
+    VisitEntries(BoundingBox{ point, point }.Padded(radius), [&](int index) {
+        const Entry& entry = mEntries[index];
+        const CurveRecord& record = mCurves.constFind(entry.curve).value();
+
+        if (record.queryStamp == stamp || entry.box.DistanceTo(point) > radius)
+            return;
+
+        float patchDistance;
+        entry.patch->Project(point, patchDistance, radius);
+
+        if (patchDistance <= radius)
+        {
+            record.queryStamp = stamp;
+            result << record.curve;
+        }
+    });
+
+    return result;
+}
+
+QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::SpatialIndex::FindInRectangle(const BoundingBox& rectangle) const
+{
+    QVector<CurvePtr> result;
+
+    const quint32 stamp = ++mQueryStamp;
+
+    VisitEntries(rectangle, [&](int index) {
+        const Entry& entry = mEntries[index];
+        const CurveRecord& record = mCurves.constFind(entry.curve).value();
+
+        if (record.queryStamp == stamp || !entry.box.Intersects(rectangle))
+            return;
+
+        record.queryStamp = stamp;
+        result << record.curve;
+    });
+
+    return result;
+}
+
+template<typename Visitor>
+void DiffusionCurveRenderer::SpatialIndex::VisitEntries(const BoundingBox& rectangle, Visitor visitor) const
+{
+    for (const int index : mOversizedEntries)
+        visitor(index);
+
+    // No linked entry is outside the extent, far away rectangles are clamped to it before the cells are counted
+    CellRange cells = GetCellRange(rectangle);
+    cells.x0 = std::max(cells.x0, mExtent.x0);
+    cells.y0 = std::max(cells.y0, mExtent.y0);
+    cells.x1 = std::min(cells.x1, mExtent.x1);
+    cells.y1 = std::min(cells.y1, mExtent.y1);
+
+    if (cells.IsEmpty())
+        return;
+
+    const qint64 numberOfCells = cells.GetNumberOfCells();
+
+    // Walking the cells of a huge rectangle is slower than testing every entry
+    if (numberOfCells > mCells.size())
+    {
+        for (auto it = mCells.cbegin(); it != mCells.cend(); ++it)
+            for (const int index : it.value())
+                visitor(index);
+
+        return;
+    }
+
+    for (int y = cells.y0; y <= cells.y1; ++y)
+    {
+        for (int x = cells.x0; x <= cells.x1; ++x)
+        {
+            const auto it = mCells.constFind(GetCellKey(x, y));
+
+            if (it == mCells.cend())
+                continue;
+
+            for (const int index : it.value())
+                visitor(index);
+        }
+    }
+}
+
+DiffusionCurveRenderer::BoundingBox DiffusionCurveRenderer::SpatialIndex::GetBoundingBox(const CurvePtr& curve) const
+{
+    BoundingBox box;
+
+    const auto it = mCurves.constFind(curve.get());
+
+    if (it != mCurves.constEnd())
+        for (const int index : it->entries)
+            box.Expand(mEntries[index].box);
+
+    return box;
+}
+
+QVector<DiffusionCurveRenderer::BezierPtr> DiffusionCurveRenderer::SpatialIndex::GetPatches(const CurvePtr& curve)
+{
+    if (const auto bezier = std::dynamic_pointer_cast<Bezier>(curve))
+    {
+        return { bezier };
+    }
+    else if (const auto spline = std::dynamic_pointer_cast<Spline>(curve))
+    {
+        return spline->GetBezierPatches();
+    }
+    else
+    {
+        DCR_EXIT_FAILURE("SpatialIndex::GetPatches: Unknown curve type.");
+    }
+}
+
+DiffusionCurveRenderer::SpatialIndex::CellRange DiffusionCurveRenderer::SpatialIndex::GetCellRange(const BoundingBox& box) const
+{
+    if (box.IsEmpty())
+        return CellRange{ 0, 0, -1, -1 };
+
+    // Clamped so that absurd coordinates cannot overflow the cell keys
+    constexpr float limit = 1 << 30;
+
+    return CellRange{
+        static_cast<int>(std::floor(std::clamp(box.min.x() / mCellSize, -limit, limit))),
+        static_cast<int>(std::floor(std::clamp(box.min.y() / mCellSize, -limit, limit))),
+        static_cast<int>(std::floor(std::clamp(box.max.x() / mCellSize, -limit, limit))),
+        static_cast<int>(std::floor(std::clamp(box.max.y() / mCellSize, -limit, limit))),
+    };
+}
+
+quint64 DiffusionCurveRenderer::SpatialIndex::GetCellKey(int x, int y)
+{
+    return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+}
+
+int DiffusionCurveRenderer::SpatialIndex::AddEntry(Curve* curve, BezierPtr patch)
+{
+    int index;
+
+    if (mFreeEntries.isEmpty())
+    {
+        index = mEntries.size();
+        mEntries << Entry();
+    }
+    else
+    {
+        index = mFreeEntries.takeLast();
+    }
+
+    Entry& entry = mEntries[index];
+    entry.curve = curve;
+    entry.box = patch->GetBoundingBox();
+    entry.patch = std::move(patch);
+
+    LinkEntry(index);
+
+    return index;
+}
+
+void DiffusionCurveRenderer::SpatialIndex::RemoveEntry(int index)
+{
+    UnlinkEntry(index);
+
+    mEntries[index] = Entry();
+    mFreeEntries << index;
+}
+
+void DiffusionCurveRenderer::SpatialIndex::LinkEntry(int index)
+{
+    Entry& entry = mEntries[index];
+    entry.cells = GetCellRange(entry.box);
+
+    entry.oversized = entry.cells.GetNumberOfCells() > MAX_CELLS_PER_ENTRY;
+
+    if (entry.oversized)
+    {
+        mOversizedEntries << index;
+        return;
+    }
+
+    if (mExtent.IsEmpty())
+    {
+        mExtent = entry.cells;
+    }
+    else
+    {
+        mExtent.x0 = std::min(mExtent.x0, entry.cells.x0);
+        mExtent.y0 = std::min(mExtent.y0, entry.cells.y0);
+        mExtent.x1 = std::max(mExtent.x1, entry.cells.x1);
+        mExtent.y1 = std::max(mExtent.y1, entry.cells.y1);
+    }
+
+    for (int y = entry.cells.y0; y <= entry.cells.y1; ++y)
+        for (int x = entry.cells.x0; x <= entry.cells.x1; ++x)
+            mCells[GetCellKey(x, y)] << index;
+}
+
+void DiffusionCurveRenderer::SpatialIndex::UnlinkEntry(int index)
+{
+    const Entry& entry = mEntries[index];
+
+    if (entry.oversized)
+    {
+        mOversizedEntries.removeOne(index);
+        return;
+    }
+
+    for (int y = entry.cells.y0; y <= entry.cells.y1; ++y)
+    {
+        for (int x = entry.cells.x0; x <= entry.cells.x1; ++x)
+        {
+            const auto it = mCells.find(GetCellKey(x, y));
+
+            if (it == mCells.end())
+                continue;
+
+            it->removeOne(index);
+
+            if (it->isEmpty())
+                mCells.erase(it);
+        }
+    }
+}
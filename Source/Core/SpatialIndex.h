@@ -0,0 +1,91 @@
+#pragma once
+
+#include "Core/Constants.h"
+#include "Curve/Bezier.h"
+#include "Structs/BoundingBox.h"
+
+#include <QHash>
+#include <QVector>
+
+namespace DiffusionCurveRenderer
+{
+    // Hashed uniform grid over the bounding boxes of Bezier patches, a Bezier curve is a single patch
+    // and a spline contributes one entry per patch. Boxes spanning too many cells are kept in a
+    // separate list that every query checks. Curves must be updated after their geometry changes.
+    class SpatialIndex
+    {
+      public:
+        explicit SpatialIndex(float cellSize = SPATIAL_INDEX_CELL_SIZE);
+
+        void Insert(CurvePtr curve);
+        void Remove(CurvePtr curve);
+        void Update(CurvePtr curve);
+        void Clear();
+
+        // Nearest curve within "radius", writes its distance to "distance" if given
+        CurvePtr FindNearest(const QVector2D& point, float radius, float* distance = nullptr) const;
+        QVector<CurvePtr> FindInRadius(const QVector2D& point, float radius) const;
+        QVector<CurvePtr> FindInRectangle(const BoundingBox& rectangle) const;
+
+        // Union of the indexed patch boxes of "curve", the geometry of its last insert or update
+        BoundingBox GetBoundingBox(const CurvePtr& curve) const;
+
+        int GetNumberOfEntries() const { return mEntries.size() - mFreeEntries.size(); }
+
+      private:
+        struct CellRange
+        {
+            int x0, y0, x1, y1;
+
+            bool IsEmpty() const { return x1 < x0 || y1 < y0; }
+            qint64 GetNumberOfCells() const { return IsEmpty() ? 0 : (qint64(x1) - x0 + 1) * (qint64(y1) - y0 + 1); }
+
+            bool operator==(const CellRange&) const = default;
+        };
+
+        struct Entry
+        {
+            Curve* curve{ nullptr };
+            BezierPtr patch;
+            BoundingBox box;
+            CellRange cells;
+            bool oversized{ false };
+        };
+
+        struct CurveRecord
+        {
+            CurvePtr curve;
+            QVector<int> entries;
+            mutable quint32 queryStamp{ 0 };
+        };
+
+        static QVector<BezierPtr> GetPatches(const CurvePtr& curve);
+
+        CellRange GetCellRange(const BoundingBox& box) const;
+        static quint64 GetCellKey(int x, int y);
+
+        int AddEntry(Curve* curve, BezierPtr patch);
+        void RemoveEntry(int index);
+        void LinkEntry(int index);
+        void UnlinkEntry(int index);
+
+        // Calls "visitor" with the index of every entry whose cells overlap "rectangle", entries can be visited more than once
+        template<typename Visitor>
+        void VisitEntries(const BoundingBox& rectangle, Visitor visitor) const;
+
+        float mCellSize;
+
+        QVector<Entry> mEntries;
+        QVector<int> mFreeEntries;
+        QVector<int> mOversizedEntries;
+        QHash<quint64, QVector<int>> mCells;
+        QHash<Curve*, CurveRecord> mCurves;
+
+        // Cells that entries were linked to since the last clear, queries are clamped to it
+        CellRange mExtent{ 0, 0, -1, -1 };
+
+        mutable quint32 mQueryStamp{ 0 };
+
+        static constexpr int MAX_CELLS_PER_ENTRY = 64;
+    };
+}
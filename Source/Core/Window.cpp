@@ -1,5 +1,6 @@
 #include "Window.h"
 
+#include "Core/Constants.h"
 #include "Util/Logger.h"
 
 #include <QDateTime>
@@ -15,7 +16,22 @@ DiffusionCurveRenderer::Window::Window(QWindow* parent)
     setFormat(format);
 
     connect(this, &QOpenGLWindow::frameSwapped, [=]()
-            { update(); });
+            {
+                if (mContinuousRendering || 0 < mPendingFrames)
+                    update();
+            });
+}
+
+void DiffusionCurveRenderer::Window::RequestRender()
+{
+    mPendingFrames = FRAMES_PER_RENDER_REQUEST;
+    update();
+}
+
+void DiffusionCurveRenderer::Window::SetContinuousRendering(bool continuousRendering)
+{
+    mContinuousRendering = continuousRendering;
+    RequestRender();
 }
 
 void DiffusionCurveRenderer::Window::initializeGL()
@@ -31,6 +47,7 @@ void DiffusionCurveRenderer::Window::initializeGL()
 void DiffusionCurveRenderer::Window::resizeGL(int width, int height)
 {
     emit Resize(width, height);
+    RequestRender();
 }
 
 void DiffusionCurveRenderer::Window::paintGL()
@@ -39,27 +56,34 @@ void DiffusionCurveRenderer::Window::paintGL()
     const float ifps = (mCurrentTime - mPreviousTime) * 0.001f;
     mPreviousTime = mCurrentTime;
 
+    if (0 < mPendingFrames)
+        --mPendingFrames;
+
     emit Render(ifps);
 }
 
 void DiffusionCurveRenderer::Window::keyPressEvent(QKeyEvent* event)
 {
     emit KeyPressed(event);
+    RequestRender();
 }
 
 void DiffusionCurveRenderer::Window::keyReleaseEvent(QKeyEvent* event)
 {
     emit KeyReleased(event);
+    RequestRender();
 }
 
 void DiffusionCurveRenderer::Window::mousePressEvent(QMouseEvent* event)
 {
     emit MousePressed(event);
+    RequestRender();
 }
 
 void DiffusionCurveRenderer::Window::mouseReleaseEvent(QMouseEvent* event)
 {
     emit MouseReleased(event);
+    RequestRender();
 }
 
 void DiffusionCurveRenderer::Window::mouseMoveEvent(QMouseEvent* event)
@@ -70,4 +94,5 @@ void DiffusionCurveRenderer::Window::mouseMoveEvent(QMouseEvent* event)
 void DiffusionCurveRenderer::Window::wheelEvent(QWheelEvent* event)
 {
     emit WheelMoved(event);
+    RequestRender();
 }
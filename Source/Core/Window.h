@@ -12,6 +12,13 @@ namespace DiffusionCurveRenderer
       public:
         Window(QWindow* parent = nullptr);
 
+      public slots:
+        // Frames are only rendered on demand, every request renders FRAMES_PER_RENDER_REQUEST frames
+        // so that ImGui can settle after an input. Mouse moves only request frames through Controller
+        // if they change what is drawn.
+        void RequestRender();
+        void SetContinuousRendering(bool continuousRendering);
+
       private:
         void initializeGL() override;
         void resizeGL(int width, int height) override;
@@ -40,5 +47,8 @@ namespace DiffusionCurveRenderer
       private:
         long long mPreviousTime;
         long long mCurrentTime;
+
+        int mPendingFrames{ 0 };
+        bool mContinuousRendering{ false };
     };
 }
@@ -0,0 +1,166 @@
+#include "ArcLengthTable.h"
+
+#include "Util/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    // 5-point Gauss-Legendre rule on [-1, 1], exact for polynomials up to degree 9
+    constexpr float GAUSS_NODES[5] = { 0.0f, -0.5384693101056831f, 0.5384693101056831f, -0.9061798459386640f, 0.9061798459386640f };
+    constexpr float GAUSS_WEIGHTS[5] = { 0.5688888888888889f, 0.4786286704993665f, 0.4786286704993665f, 0.2369268850562389f, 0.2369268850562389f };
+}
+
+void DiffusionCurveRenderer::ArcLengthTable::Build(std::span<const QVector2D> points, float tolerance)
+{
+    DCR_ASSERT(points.size() <= Bernstein::MAX_ORDER);
+
+    mOrder = points.size();
+    std::copy(points.begin(), points.end(), mPoints.begin());
+    mNodes.clear();
+
+    if (mOrder == 0)
+        return;
+
+    mNodes << Node{ 0.0f, 0.0f, SpeedAt(0.0f) };
+
+    if (mOrder == 1)
+    {
+        mNodes << Node{ 1.0f, 0.0f, 0.0f };
+        return;
+    }
+
+    float polygonLength = 0.0f;
+
+    for (int i = 0; i + 1 < mOrder; ++i)
+        polygonLength += points[i].distanceToPoint(points[i + 1]);
+
+    // Absolute tolerance per unit parameter
+    const float absoluteTolerance = std::max(tolerance * polygonLength, 1e-7f);
+
+    for (int i = 0; i < INITIAL_SEGMENTS; ++i)
+    {
+        const float a = float(i) / INITIAL_SEGMENTS;
+        const float b = float(i + 1) / INITIAL_SEGMENTS;
+        Subdivide(a, b, Integrate(a, b), absoluteTolerance, 0);
+    }
+
+    mNodes.last().t = 1.0f;
+}
+
+void DiffusionCurveRenderer::ArcLengthTable::Subdivide(float a, float b, float estimate, float tolerance, int depth)
+{
+    const float middle = 0.5f * (a + b);
+    const float left = Integrate(a, middle);
+    const float right = Integrate(middle, b);
+
+    if (depth < MAX_DEPTH && std::abs(left + right - estimate) > tolerance * (b - a))
+    {
+        Subdivide(a, middle, left, tolerance, depth + 1);
+        Subdivide(middle, b, right, tolerance, depth + 1);
+        return;
+    }
+
+    // Accepted, breakpoints are appended in increasing t
+    const float length = mNodes.last().length;
+    mNodes << Node{ middle, length + left, SpeedAt(middle) };
+    mNodes << Node{ b, length + left + right, SpeedAt(b) };
+}
+
+float DiffusionCurveRenderer::ArcLengthTable::LengthAt(float t) const
+{
+    if (mNodes.isEmpty())
+        return 0.0f;
+
+    t = std::clamp(t, 0.0f, 1.0f);
+
+    const int segment = FindSegment(&Node::t, t);
+
+    return mNodes[segment].length + Integrate(mNodes[segment].t, t);
+}
+
+float DiffusionCurveRenderer::ArcLengthTable::ParameterAt(float length) const
+{
+    if (mNodes.isEmpty())
+        return 0.0f;
+
+    length = std::clamp(length, 0.0f, GetLength());
+
+    const int segment = FindSegment(&Node::length, length);
+
+    const Node& start = mNodes[segment];
+    const Node& end = mNodes[segment + 1];
+
+    const float dt = end.t - start.t;
+    const float ds = end.length - start.length;
+
+    if (ds <= 0.0f)
+        return start.t;
+
+    // Inverse of the cubic Hermite interpolant of s(t) on the segment, found with a few Newton steps on u in [0, 1]
+    const float m0 = start.speed * dt;
+    const float m1 = end.speed * dt;
+    const float target = length - start.length;
+
+    float u = target / ds;
+
+    for (int i = 0; i < NEWTON_ITERATIONS; ++i)
+    {
+        const float u2 = u * u;
+        const float u3 = u2 * u;
+
+        const float value = (u3 - 2 * u2 + u) * m0 + (-2 * u3 + 3 * u2) * ds + (u3 - u2) * m1;
+        const float derivative = (3 * u2 - 4 * u + 1) * m0 + (-6 * u2 + 6 * u) * ds + (3 * u2 - 2 * u) * m1;
+
+        if (derivative <= 0.0f)
+            break;
+
+        u = std::clamp(u - (value - target) / derivative, 0.0f, 1.0f);
+    }
+
+    // Newton steps on the exact s(t), the speed is the derivative
+    float t = start.t + u * dt;
+
+    for (int i = 0; i < NEWTON_ITERATIONS; ++i)
+    {
+        const float speed = SpeedAt(t);
+
+        if (speed <= 0.0f)
+            break;
+
+        const float error = Integrate(start.t, t) - target;
+        t = std::clamp(t - error / speed, start.t, end.t);
+
+        if (std::abs(error) <= 1e-6f * ds)
+            break;
+    }
+
+    return t;
+}
+
+float DiffusionCurveRenderer::ArcLengthTable::SpeedAt(float t) const
+{
+    return Bernstein::Derivative(std::span(mPoints.data(), mOrder), t).length();
+}
+
+float DiffusionCurveRenderer::ArcLengthTable::Integrate(float a, float b) const
+{
+    const float halfWidth = 0.5f * (b - a);
+    const float center = 0.5f * (a + b);
+
+    float sum = 0.0f;
+
+    for (int i = 0; i < 5; ++i)
+        sum += GAUSS_WEIGHTS[i] * SpeedAt(center + halfWidth * GAUSS_NODES[i]);
+
+    return halfWidth * sum;
+}
+
+int DiffusionCurveRenderer::ArcLengthTable::FindSegment(float Node::*key, float value) const
+{
+    const auto it = std::upper_bound(mNodes.begin(), mNodes.end(), value, [key](float value, const Node& node) { return value < node.*key; });
+    const int index = int(it - mNodes.begin()) - 1;
+
+    return std::clamp(index, 0, int(mNodes.size()) - 2);
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Curve/Bernstein.h"
+
+#include <QVector2D>
+#include <QVector>
+#include <array>
+#include <span>
+
+namespace DiffusionCurveRenderer
+{
+    // Arc length s(t) of a Bezier curve, tabulated at breakpoints chosen by adaptive Gauss-Legendre quadrature.
+    // Between two breakpoints s(t) is integrated with the same rule, so both directions are accurate to the
+    // tolerance, s -> t starts from a Hermite guess on the table and polishes it with Newton steps.
+    class ArcLengthTable
+    {
+      public:
+        ArcLengthTable() = default;
+
+        // "tolerance" is relative to the length of the control polygon
+        void Build(std::span<const QVector2D> points, float tolerance = 1e-5f);
+
+        float GetLength() const { return mNodes.isEmpty() ? 0.0f : mNodes.last().length; }
+        int GetNumberOfSegments() const { return std::max(0, int(mNodes.size()) - 1); }
+
+        // t -> s
+        float LengthAt(float t) const;
+
+        // s -> t, "length" is clamped to [0, GetLength()]
+        float ParameterAt(float length) const;
+
+        // Maps a fraction of the total length to a parameter
+        float ParameterAtFraction(float fraction) const { return ParameterAt(fraction * GetLength()); }
+
+      private:
+        struct Node
+        {
+            float t;
+            float length;
+            float speed;
+        };
+
+        float SpeedAt(float t) const;
+        float Integrate(float a, float b) const;
+        void Subdivide(float a, float b, float estimate, float tolerance, int depth);
+
+        // Index of the segment [mNodes[i], mNodes[i + 1]] containing the value
+        int FindSegment(float Node::*key, float value) const;
+
+        std::array<QVector2D, Bernstein::MAX_ORDER> mPoints;
+        int mOrder{ 0 };
+
+        QVector<Node> mNodes;
+
+        static constexpr int INITIAL_SEGMENTS = 4;
+        static constexpr int MAX_DEPTH = 12;
+        static constexpr int NEWTON_ITERATIONS = 3;
+    };
+}
@@ -0,0 +1,252 @@
+#include "Bernstein.h"
+
+#include "Util/Logger.h"
+#include "Util/Simd.h"
+
+#include <algorithm>
+
+template<typename Coefficient>
+QVector2D DiffusionCurveRenderer::Bernstein::Horner(int count, float t, Coefficient coefficient)
+{
+    const int n = count - 1;
+    const float s = 1.0f - t;
+
+    QVector2D value;
+    float scale = 1.0f;
+
+    if (t <= 0.5f)
+    {
+        const float ratio = t / s;
+
+        value = coefficient(n);
+
+        for (int i = n - 1; i >= 0; --i)
+        {
+            value = value * ratio + BINOMIALS[n][i] * coefficient(i);
+            scale *= s;
+        }
+    }
+    else
+    {
+        const float ratio = s / t;
+
+        value = coefficient(0);
+
+        for (int i = 1; i <= n; ++i)
+        {
+            value = value * ratio + BINOMIALS[n][i] * coefficient(i);
+            scale *= t;
+        }
+    }
+
+    return value * scale;
+}
+
+QVector2D DiffusionCurveRenderer::Bernstein::Evaluate(std::span<const QVector2D> points, float t)
+{
+    DCR_ASSERT(points.size() <= MAX_ORDER);
+
+    const float s = 1.0f - t;
+
+    switch (points.size())
+    {
+        case 0:
+            return QVector2D(0, 0);
+        case 1:
+            return points[0];
+        case 2:
+            return s * points[0] + t * points[1];
+        case 3:
+            return s * s * points[0] + 2 * s * t * points[1] + t * t * points[2];
+        case 4:
+            return s * s * s * points[0] + 3 * s * s * t * points[1] + 3 * s * t * t * points[2] + t * t * t * points[3];
+        default:
+            return Horner(points.size(), t, [&points](int i) { return points[i]; });
+    }
+}
+
+QVector2D DiffusionCurveRenderer::Bernstein::Derivative(std::span<const QVector2D> points, float t)
+{
+    DCR_ASSERT(points.size() <= MAX_ORDER);
+
+    const float s = 1.0f - t;
+
+    switch (points.size())
+    {
+        case 0:
+        case 1:
+            return QVector2D(0, 0);
+        case 2:
+            return points[1] - points[0];
+        case 3:
+            return 2 * (s * (points[1] - points[0]) + t * (points[2] - points[1]));
+        case 4:
+            return 3 * (s * s * (points[1] - points[0]) + 2 * s * t * (points[2] - points[1]) + t * t * (points[3] - points[2]));
+        default:
+            return float(points.size() - 1) * Horner(points.size() - 1, t, [&points](int i) { return points[i + 1] - points[i]; });
+    }
+}
+
+QVector2D DiffusionCurveRenderer::Bernstein::SecondDerivative(std::span<const QVector2D> points, float t)
+{
+    DCR_ASSERT(points.size() <= MAX_ORDER);
+
+    const int count = points.size();
+
+    switch (count)
+    {
+        case 0:
+        case 1:
+        case 2:
+            return QVector2D(0, 0);
+        case 3:
+            return 2 * (points[2] - 2 * points[1] + points[0]);
+        case 4:
+            return 6 * ((1.0f - t) * (points[2] - 2 * points[1] + points[0]) + t * (points[3] - 2 * points[2] + points[1]));
+        default:
+            return float((count - 1) * (count - 2)) * Horner(count - 2, t, [&points](int i) { return points[i + 2] - 2 * points[i + 1] + points[i]; });
+    }
+}
+
+void DiffusionCurveRenderer::Bernstein::Evaluate(std::span<const QVector2D> points, std::span<const float> parameters, std::span<float> xs, std::span<float> ys)
+{
+    DCR_ASSERT(points.size() <= MAX_ORDER);
+
+    float px[MAX_ORDER];
+    float py[MAX_ORDER];
+
+    for (int i = 0; i < int(points.size()); ++i)
+    {
+        px[i] = points[i].x();
+        py[i] = points[i].y();
+    }
+
+    EvaluateBatch(px, py, points.size(), 1.0f, parameters, xs, ys);
+}
+
+void DiffusionCurveRenderer::Bernstein::Derivative(std::span<const QVector2D> points, std::span<const float> parameters, std::span<float> xs, std::span<float> ys)
+{
+    DCR_ASSERT(points.size() <= MAX_ORDER);
+
+    // The hodograph is a Bezier curve of one degree less on the differences of the control points
+    float px[MAX_ORDER];
+    float py[MAX_ORDER];
+
+    const int count = std::max(0, int(points.size()) - 1);
+
+    for (int i = 0; i < count; ++i)
+    {
+        px[i] = points[i + 1].x() - points[i].x();
+        py[i] = points[i + 1].y() - points[i].y();
+    }
+
+    EvaluateBatch(px, py, count, float(count), parameters, xs, ys);
+}
+
+void DiffusionCurveRenderer::Bernstein::EvaluateBatch(const float* px, const float* py, int count, float factor, std::span<const float> parameters, std::span<float> xs, std::span<float> ys)
+{
+    DCR_ASSERT(xs.size() == parameters.size() && ys.size() == parameters.size());
+
+    if (count == 0)
+    {
+        std::fill(xs.begin(), xs.end(), 0.0f);
+        std::fill(ys.begin(), ys.end(), 0.0f);
+        return;
+    }
+
+    const int n = count - 1;
+
+    Simd::ForEach(parameters.size(), [&]<typename L>(int j) {
+        const auto t = L::Load(&parameters[j]);
+        const auto s = L::Sub(L::Set(1.0f), t);
+
+        typename L::Type x, y;
+
+        if (count <= 4)
+        {
+            typename L::Type basis[4];
+
+            switch (count)
+            {
+                case 1:
+                    basis[0] = L::Set(1.0f);
+                    break;
+                case 2:
+                    basis[0] = s;
+                    basis[1] = t;
+                    break;
+                case 3:
+                    basis[0] = L::Mul(s, s);
+                    basis[1] = L::Mul(L::Set(2.0f), L::Mul(s, t));
+                    basis[2] = L::Mul(t, t);
+                    break;
+                default:
+                    basis[0] = L::Mul(L::Mul(s, s), s);
+                    basis[1] = L::Mul(L::Set(3.0f), L::Mul(L::Mul(s, s), t));
+                    basis[2] = L::Mul(L::Set(3.0f), L::Mul(L::Mul(s, t), t));
+                    basis[3] = L::Mul(L::Mul(t, t), t);
+                    break;
+            }
+
+            x = L::Mul(basis[0], L::Set(px[0]));
+            y = L::Mul(basis[0], L::Set(py[0]));
+
+            for (int i = 1; i < count; ++i)
+            {
+                x = L::Add(x, L::Mul(basis[i], L::Set(px[i])));
+                y = L::Add(y, L::Mul(basis[i], L::Set(py[i])));
+            }
+        }
+        else
+        {
+            // Same scheme as Horner(), lanes with t <= 0.5 run from P(n) down to P(0), the others from P(0) up to P(n).
+            // Since C(n, k) = C(n, n - k), both directions share the binomial of each step.
+            const auto lower = L::LessEqual(t, L::Set(0.5f));
+            const auto ratio = L::Select(lower, L::Div(t, s), L::Div(s, t));
+            const auto base = L::Select(lower, s, t);
+
+            auto scale = L::Set(1.0f);
+            x = L::Select(lower, L::Set(px[n]), L::Set(px[0]));
+            y = L::Select(lower, L::Set(py[n]), L::Set(py[0]));
+
+            for (int k = 1; k <= n; ++k)
+            {
+                const float binomial = BINOMIALS[n][k];
+                x = L::Add(L::Mul(x, ratio), L::Select(lower, L::Set(binomial * px[n - k]), L::Set(binomial * px[k])));
+                y = L::Add(L::Mul(y, ratio), L::Select(lower, L::Set(binomial * py[n - k]), L::Set(binomial * py[k])));
+                scale = L::Mul(scale, base);
+            }
+
+            x = L::Mul(x, scale);
+            y = L::Mul(y, scale);
+        }
+
+        L::Store(&xs[j], L::Mul(x, L::Set(factor)));
+        L::Store(&ys[j], L::Mul(y, L::Set(factor)));
+    });
+}
+
+void DiffusionCurveRenderer::Bernstein::Split(std::span<const QVector2D> points, float t, std::span<QVector2D> left, std::span<QVector2D> right)
+{
+    DCR_ASSERT(points.size() <= MAX_ORDER);
+    DCR_ASSERT(left.size() == points.size() && right.size() == points.size());
+
+    const int count = points.size();
+
+    if (count == 0)
+        return;
+
+    QVector2D buffer[MAX_ORDER];
+
+    for (int i = 0; i < count; ++i)
+        buffer[i] = points[i];
+
+    for (int level = 0; level < count; ++level)
+    {
+        left[level] = buffer[0];
+        right[count - 1 - level] = buffer[count - 1 - level];
+
+        for (int i = 0; i < count - 1 - level; ++i)
+            buffer[i] = (1.0f - t) * buffer[i] + t * buffer[i + 1];
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QVector2D>
+#include <array>
+#include <span>
+
+namespace DiffusionCurveRenderer
+{
+    namespace Internal
+    {
+        template<int Order>
+        constexpr std::array<std::array<float, Order>, Order> CreateBinomialTable()
+        {
+            std::array<std::array<double, Order>, Order> pascal{};
+
+            for (int n = 0; n < Order; ++n)
+            {
+                pascal[n][0] = 1.0;
+                pascal[n][n] = 1.0;
+
+                for (int k = 1; k < n; ++k)
+                    pascal[n][k] = pascal[n - 1][k - 1] + pascal[n - 1][k];
+            }
+
+            std::array<std::array<float, Order>, Order> table{};
+
+            for (int n = 0; n < Order; ++n)
+                for (int k = 0; k <= n; ++k)
+                    table[n][k] = static_cast<float>(pascal[n][k]);
+
+            return table;
+        }
+    }
+
+    // Evaluation of Bezier polynomials given in Bernstein form.
+    // Binomial coefficients are tabulated at compile time up to MAX_DEGREE,
+    // general degrees are evaluated with a Horner scheme on the ratio t / (1 - t)
+    // (or its inverse for t > 0.5) which keeps every intermediate value bounded,
+    // degrees 1 to 3 use closed forms.
+    class Bernstein
+    {
+      public:
+        Bernstein() = delete;
+
+        static constexpr int MAX_DEGREE = 31;
+        static constexpr int MAX_ORDER = MAX_DEGREE + 1;
+
+        static constexpr float Binomial(int n, int k) { return BINOMIALS[n][k]; }
+
+        // B(t)
+        static QVector2D Evaluate(std::span<const QVector2D> points, float t);
+
+        // B'(t)
+        static QVector2D Derivative(std::span<const QVector2D> points, float t);
+
+        // B''(t)
+        static QVector2D SecondDerivative(std::span<const QVector2D> points, float t);
+
+        // Batched B(t) and B'(t), results are written to "xs" and "ys" which must have the size of "parameters"
+        static void Evaluate(std::span<const QVector2D> points, std::span<const float> parameters, std::span<float> xs, std::span<float> ys);
+        static void Derivative(std::span<const QVector2D> points, std::span<const float> parameters, std::span<float> xs, std::span<float> ys);
+
+        // De Casteljau subdivision of the curve at t, "left" and "right" must have the size of "points".
+        static void Split(std::span<const QVector2D> points, float t, std::span<QVector2D> left, std::span<QVector2D> right);
+
+      private:
+        // Sum of C(n, i) * coefficient(i) * t^i * (1 - t)^(n - i) where n = count - 1
+        template<typename Coefficient>
+        static QVector2D Horner(int count, float t, Coefficient coefficient);
+
+        // SoA kernel shared by the batched functions, every result is multiplied by "factor"
+        static void EvaluateBatch(const float* px, const float* py, int count, float factor, std::span<const float> parameters, std::span<float> xs, std::span<float> ys);
+
+        static constexpr std::array<std::array<float, MAX_ORDER>, MAX_ORDER> BINOMIALS = Internal::CreateBinomialTable<MAX_ORDER>();
+    };
+
+    static_assert(Bernstein::Binomial(4, 2) == 6.0f);
+    static_assert(Bernstein::Binomial(Bernstein::MAX_DEGREE, 1) == float(Bernstein::MAX_DEGREE));
+}
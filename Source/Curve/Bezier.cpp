@@ -1,38 +1,31 @@
 #include "Bezier.h"
+#include "Bernstein.h"
 
 #include "Util/Chronometer.h"
 #include "Util/Logger.h"
+#include "Util/Simd.h"
 
 #include <QObject>
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 QVector2D DiffusionCurveRenderer::Bezier::PositionAt(float t) const
 {
-    const int n = GetDegree();
-    QVector2D value = QVector2D(0, 0);
+    QVector2D positions[Bernstein::MAX_ORDER];
+    const int order = GatherControlPointPositions(positions);
 
-    for (int i = 0; i <= n; i++)
-    {
-        value += Choose(n, i) * pow(t, i) * pow(1 - t, n - i) * GetControlPointPosition(i);
-    }
-
-    return value;
+    return Bernstein::Evaluate(std::span(positions, order), t);
 }
 
 QVector2D DiffusionCurveRenderer::Bezier::TangentAt(float t) const
 {
-    const int order = GetDegree();
+    QVector2D positions[Bernstein::MAX_ORDER];
+    const int order = GatherControlPointPositions(positions);
 
-    QVector2D tangent = QVector2D(0, 0);
-
-    for (int i = 0; i <= order - 1; i++)
-    {
-        float coefficient = Choose(order - 1, i) * pow(t, i) * pow(1 - t, order - 1 - i);
-        tangent += coefficient * (GetControlPointPosition(i) - GetControlPointPosition(i + 1));
-    }
-
-    tangent.normalize();
-
-    return tangent;
+    // Tangent points from P(i + 1) to P(i), side of the colors depends on this convention.
+    return (-Bernstein::Derivative(std::span(positions, order), t)).normalized();
 }
 
 QVector2D DiffusionCurveRenderer::Bezier::NormalAt(float t) const
@@ -42,9 +35,135 @@ QVector2D DiffusionCurveRenderer::Bezier::NormalAt(float t) const
     return QVector2D(-tangent.y(), tangent.x());
 }
 
+void DiffusionCurveRenderer::Bezier::PositionsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    QVector2D positions[Bernstein::MAX_ORDER];
+    const int order = GatherControlPointPositions(positions);
+
+    Bernstein::Evaluate(std::span(positions, order), parameters, xs, ys);
+}
+
+void DiffusionCurveRenderer::Bezier::TangentsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    QVector2D positions[Bernstein::MAX_ORDER];
+    const int order = GatherControlPointPositions(positions);
+
+    Bernstein::Derivative(std::span(positions, order), parameters, xs, ys);
+    Simd::Normalize(xs, ys, -1.0f);
+}
+
+float DiffusionCurveRenderer::Bezier::ParameterAt(const QVector2D& point) const
+{
+    float distance;
+    return Project(point, distance);
+}
+
+float DiffusionCurveRenderer::Bezier::Project(const QVector2D& point, float& distance, float maxDistance) const
+{
+    QVector2D positions[Bernstein::MAX_ORDER];
+    const int order = GatherControlPointPositions(positions);
+    const auto points = std::span<const QVector2D>(positions, order);
+
+    distance = std::numeric_limits<float>::infinity();
+
+    if (order == 0)
+        return 0.0f;
+
+    if (order == 1)
+    {
+        distance = positions[0].distanceToPoint(point);
+        return 0.0f;
+    }
+
+    // Coarse search, closest points on the segments of the cached polyline
+    const auto& polyline = GetPolyline();
+    const int numberOfSegments = polyline.size() - 1;
+    const float dt = 1.0f / numberOfSegments;
+
+    // Squared distances
+    QVarLengthArray<float, 129> segmentDistances(numberOfSegments);
+    QVarLengthArray<float, 129> segmentParameters(numberOfSegments);
+    float minSegmentDistance = std::numeric_limits<float>::infinity();
+
+    for (int i = 0; i < numberOfSegments; ++i)
+    {
+        const QVector2D segment = polyline[i + 1] - polyline[i];
+        const float lengthSquared = segment.lengthSquared();
+        const float s = lengthSquared > 0 ? std::clamp(QVector2D::dotProduct(point - polyline[i], segment) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+
+        segmentDistances[i] = (polyline[i] + s * segment - point).lengthSquared();
+        segmentParameters[i] = (i + s) * dt;
+        minSegmentDistance = std::min(minSegmentDistance, segmentDistances[i]);
+    }
+
+    minSegmentDistance = std::sqrt(minSegmentDistance);
+
+    // The curve is within mPolylineError of its polyline
+    if (minSegmentDistance - mPolylineError >= maxDistance)
+        return 0.0f;
+
+    // Refine every local minimum along the polyline that can still be the closest one,
+    // more than one qualifies only where the curve nearly touches itself
+    float parameter = 0.0f;
+    float minDistanceSquared = std::numeric_limits<float>::infinity();
+
+    for (int i = 0; i < numberOfSegments; ++i)
+    {
+        const float previous = i > 0 ? segmentDistances[i - 1] : std::numeric_limits<float>::infinity();
+        const float next = i < numberOfSegments - 1 ? segmentDistances[i + 1] : std::numeric_limits<float>::infinity();
+
+        if (segmentDistances[i] > previous || segmentDistances[i] >= next)
+            continue;
+
+        if (std::sqrt(segmentDistances[i]) - mPolylineError > minSegmentDistance + mPolylineError)
+            continue;
+
+        // Newton iterations on f(t) = |B(t) - p|^2 / 2, kept around the segment
+        const float lower = std::max(0.0f, (i - 1) * dt);
+        const float upper = std::min(1.0f, (i + 2) * dt);
+
+        float t = segmentParameters[i];
+
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            const QVector2D difference = Bernstein::Evaluate(points, t) - point;
+            const QVector2D first = Bernstein::Derivative(points, t);
+            const QVector2D second = Bernstein::SecondDerivative(points, t);
+
+            const float numerator = QVector2D::dotProduct(difference, first);
+            const float denominator = QVector2D::dotProduct(first, first) + QVector2D::dotProduct(difference, second);
+
+            if (denominator <= 0.0f)
+                break;
+
+            const float step = numerator / denominator;
+            t = std::clamp(t - step, lower, upper);
+
+            if (std::abs(step) < 1e-6f)
+                break;
+        }
+
+        // Newton may walk uphill on degenerate curves, the coarse estimate is kept in that case
+        for (const float candidate : { t, segmentParameters[i] })
+        {
+            const float distanceSquared = (Bernstein::Evaluate(points, candidate) - point).lengthSquared();
+
+            if (distanceSquared < minDistanceSquared)
+            {
+                minDistanceSquared = distanceSquared;
+                parameter = candidate;
+            }
+        }
+    }
+
+    distance = std::sqrt(minDistanceSquared);
+    return parameter;
+}
+
 void DiffusionCurveRenderer::Bezier::Update()
 {
     mControlPointsDirty = true;
+    ++mGeometryRevision;
     mLeftColorsDirty = true;
     mLeftColorPositionsDirty = true;
     mRightColorsDirty = true;
@@ -53,300 +172,441 @@ void DiffusionCurveRenderer::Bezier::Update()
     mBlurPointStrengthsDirty = true;
 }
 
+const QVector<QVector2D>& DiffusionCurveRenderer::Bezier::GetPolyline() const
+{
+    if (mPolylineRevision != mGeometryRevision)
+    {
+        // Denser for higher degrees since they can wiggle more
+        const int numberOfSegments = std::clamp(8 * GetOrder(), 16, 128);
+
+        QVarLengthArray<float, 129> parameters(numberOfSegments + 1);
+        QVarLengthArray<float, 129> xs(numberOfSegments + 1);
+        QVarLengthArray<float, 129> ys(numberOfSegments + 1);
+
+        for (int i = 0; i <= numberOfSegments; ++i)
+            parameters[i] = float(i) / numberOfSegments;
+
+        PositionsAt(parameters, xs, ys);
+
+        mPolyline.resize(numberOfSegments + 1);
+
+        for (int i = 0; i <= numberOfSegments; ++i)
+            mPolyline[i] = QVector2D(xs[i], ys[i]);
+
+        // |B(t) - chord| <= dt^2 / 8 * max |B''| and |B''| <= n (n - 1) max |P(i + 2) - 2 P(i + 1) + P(i)|
+        const int n = GetDegree();
+        float maxSecondDifference = 0.0f;
+
+        for (int i = 0; i + 2 <= n; ++i)
+        {
+            const QVector2D secondDifference = GetControlPointPosition(i + 2) - 2 * GetControlPointPosition(i + 1) + GetControlPointPosition(i);
+            maxSecondDifference = std::max(maxSecondDifference, secondDifference.length());
+        }
+
+        const float dt = 1.0f / numberOfSegments;
+        mPolylineError = dt * dt / 8.0f * n * (n - 1) * maxSecondDifference;
+
+        mPolylineRevision = mGeometryRevision;
+    }
+
+    return mPolyline;
+}
+
+const DiffusionCurveRenderer::BoundingBox& DiffusionCurveRenderer::Bezier::GetBoundingBox() const
+{
+    if (mBoundingBoxRevision != mGeometryRevision)
+    {
+        QVector2D positions[Bernstein::MAX_ORDER];
+        const int order = GatherControlPointPositions(positions);
+        const auto points = std::span<const QVector2D>(positions, order);
+
+        mBoundingBox = BoundingBox();
+
+        if (order <= 4)
+        {
+            // Extrema are at the end points or at the roots of B'(t), solved per axis
+            if (order > 0)
+            {
+                mBoundingBox.Expand(positions[0]);
+                mBoundingBox.Expand(positions[order - 1]);
+            }
+
+            for (int axis = 0; axis < 2 && order >= 3; ++axis)
+            {
+                // B'(t) / n in power form a t^2 + b t + c, from the differences d(i) = P(i + 1) - P(i)
+                const float d0 = positions[1][axis] - positions[0][axis];
+                const float d1 = positions[2][axis] - positions[1][axis];
+                const float d2 = order == 4 ? positions[3][axis] - positions[2][axis] : 0.0f;
+
+                const float a = order == 4 ? d0 - 2 * d1 + d2 : 0.0f;
+                const float b = order == 4 ? 2 * (d1 - d0) : d1 - d0;
+                const float c = d0;
+
+                float roots[2];
+                int numberOfRoots = 0;
+
+                if (std::abs(a) < 1e-12f)
+                {
+                    if (std::abs(b) > 1e-12f)
+                        roots[numberOfRoots++] = -c / b;
+                }
+                else
+                {
+                    const float discriminant = b * b - 4 * a * c;
+
+                    if (discriminant >= 0)
+                    {
+                        const float root = std::sqrt(discriminant);
+                        roots[numberOfRoots++] = (-b + root) / (2 * a);
+                        roots[numberOfRoots++] = (-b - root) / (2 * a);
+                    }
+                }
+
+                for (int i = 0; i < numberOfRoots; ++i)
+                    if (0.0f < roots[i] && roots[i] < 1.0f)
+                        mBoundingBox.Expand(Bernstein::Evaluate(points, roots[i]));
+            }
+        }
+        else
+        {
+            // Each piece lies in the hull of its control points, which converge to the curve under subdivision
+            QVector2D left[Bernstein::MAX_ORDER];
+            QVector2D right[Bernstein::MAX_ORDER];
+            QVector2D remaining[Bernstein::MAX_ORDER];
+            std::copy(positions, positions + order, remaining);
+
+            for (int piece = 0; piece < BOUNDING_BOX_PIECES; ++piece)
+            {
+                const bool isLast = piece == BOUNDING_BOX_PIECES - 1;
+
+                if (!isLast)
+                {
+                    Bernstein::Split(std::span(remaining, order), 1.0f / (BOUNDING_BOX_PIECES - piece), std::span(left, order), std::span(right, order));
+                    std::copy(right, right + order, remaining);
+                }
+
+                for (int i = 0; i < order; ++i)
+                    mBoundingBox.Expand(isLast ? remaining[i] : left[i]);
+            }
+        }
+
+        mBoundingBoxRevision = mGeometryRevision;
+    }
+
+    return mBoundingBox;
+}
+
+float DiffusionCurveRenderer::Bezier::GetLength() const
+{
+    return GetArcLengthTable().GetLength();
+}
+
+const DiffusionCurveRenderer::ArcLengthTable& DiffusionCurveRenderer::Bezier::GetArcLengthTable() const
+{
+    if (mArcLengthTableRevision != mGeometryRevision)
+    {
+        QVector2D positions[Bernstein::MAX_ORDER];
+        const int order = GatherControlPointPositions(positions);
+
+        mArcLengthTable.Build(std::span(positions, order));
+        mArcLengthTableRevision = mGeometryRevision;
+    }
+
+    return mArcLengthTable;
+}
+
 DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::Bezier::GetControlPoint(int index)
 {
-    DCR_ASSERT(0 <= index && index < mControlPoints.size());
+    DCR_ASSERT(0 <= index && index < mControlPoints.Size());
 
-    return mControlPoints[index];
+    return MakeHandle(mControlPoints, &mControlPoints[index]);
 }
 
 QVector2D DiffusionCurveRenderer::Bezier::GetControlPointPosition(int index) const
 {
-    DCR_ASSERT(0 <= index && index < mControlPoints.size());
-    return mControlPoints[index]->position;
+    DCR_ASSERT(0 <= index && index < mControlPoints.Size());
+    return mControlPoints[index].position;
 }
 
 DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::Bezier::AddControlPoint(const QVector2D& position)
 {
-    if (mControlPoints.size() >= 32)
+    ControlPoint* point = mControlPoints.Append(ControlPoint{ position });
+
+    if (point == nullptr)
     {
         LOG_WARN("Bezier::AddControlPoint: ControlPoint could not be added because the total number of ControlPoints is 32.");
         return nullptr;
     }
 
-    ControlPointPtr point = std::make_shared<ControlPoint>();
-    point->position = position;
-    mControlPoints << point;
     mControlPointsDirty = true;
-    return point;
+    ++mGeometryRevision;
+    return MakeHandle(mControlPoints, point);
 }
 
 void DiffusionCurveRenderer::Bezier::RemoveControlPoint(ControlPointPtr point)
 {
-    for (int index = 0; index < mControlPoints.size(); ++index)
-    {
-        if (point == mControlPoints[index])
-        {
-            RemoveControlPoint(index);
-            return;
-        }
-    }
+    const int index = mControlPoints.IndexOf(point.get());
+
+    if (index != -1)
+        RemoveControlPoint(index);
 }
 
 void DiffusionCurveRenderer::Bezier::RemoveControlPoint(int index)
 {
-    DCR_ASSERT(0 <= index && index < mControlPoints.size());
+    DCR_ASSERT(0 <= index && index < mControlPoints.Size());
 
-    mControlPoints.removeAt(index);
+    mControlPoints.RemoveAt(index);
     Update();
 }
 
-const QVector<QVector2D>& DiffusionCurveRenderer::Bezier::GetControlPointPositions()
+std::span<const QVector2D> DiffusionCurveRenderer::Bezier::GetControlPointPositions()
 {
     if (mControlPointsDirty)
     {
-        mControlPointPositions.clear();
-
-        for (const auto& controlPoint : mControlPoints)
-            mControlPointPositions << controlPoint->position;
-
+        GatherControlPointPositions(mControlPointPositions.data());
         mControlPointsDirty = false;
     }
 
-    return mControlPointPositions;
+    return std::span(mControlPointPositions.data(), mControlPoints.Size());
 }
 
 void DiffusionCurveRenderer::Bezier::SetAllBlurPointsStrength(float strength)
 {
-    for (int index = 0; index < mBlurPoints.size(); ++index)
-        mBlurPoints[index]->strength = strength;
+    for (auto& blurPoint : mBlurPoints)
+        blurPoint.strength = strength;
 
     mBlurPointStrengthsDirty = true;
 }
 
-const QVector<float>& DiffusionCurveRenderer::Bezier::GetLeftColorPositions()
+std::span<const float> DiffusionCurveRenderer::Bezier::GetLeftColorPositions()
 {
     if (mLeftColorPositionsDirty)
     {
-        mLeftColorPositions.clear();
+        int count = 0;
 
-        for (const auto colorPoint : mColorPoints)
+        for (const auto& colorPoint : mColorPoints)
         {
-            if (colorPoint->type == ColorPointType::Left)
-                mLeftColorPositions << colorPoint->position;
+            if (colorPoint.type == ColorPointType::Left)
+                mLeftColorPositions[count++] = colorPoint.position;
         }
 
         mLeftColorPositionsDirty = false;
     }
 
-    return mLeftColorPositions;
+    return std::span(mLeftColorPositions.data(), GetNumberOfLeftColors());
 }
 
-const QVector<float>& DiffusionCurveRenderer::Bezier::GetRightColorPositions()
+std::span<const float> DiffusionCurveRenderer::Bezier::GetRightColorPositions()
 {
     if (mRightColorPositionsDirty)
     {
-        mRightColorPositions.clear();
+        int count = 0;
 
-        for (const auto colorPoint : mColorPoints)
+        for (const auto& colorPoint : mColorPoints)
         {
-            if (colorPoint->type == ColorPointType::Right)
-                mRightColorPositions << colorPoint->position;
+            if (colorPoint.type == ColorPointType::Right)
+                mRightColorPositions[count++] = colorPoint.position;
         }
 
         mRightColorPositionsDirty = false;
     }
 
-    return mRightColorPositions;
+    return std::span(mRightColorPositions.data(), GetNumberOfRightColors());
 }
 
-const QVector<float>& DiffusionCurveRenderer::Bezier::GetBlurPointPositions()
+std::span<const float> DiffusionCurveRenderer::Bezier::GetBlurPointPositions()
 {
     if (mBlurPointPositionsDirty)
     {
-        mBlurPointPositions.clear();
-
-        for (const auto& blurPoint : mBlurPoints)
-            mBlurPointPositions << blurPoint->position;
+        for (int i = 0; i < mBlurPoints.Size(); ++i)
+            mBlurPointPositions[i] = mBlurPoints[i].position;
 
         mBlurPointPositionsDirty = false;
     }
 
-    return mBlurPointPositions;
+    return std::span(mBlurPointPositions.data(), mBlurPoints.Size());
 }
 
-const QVector<QVector4D>& DiffusionCurveRenderer::Bezier::GetLeftColors()
+std::span<const QVector4D> DiffusionCurveRenderer::Bezier::GetLeftColors()
 {
     if (mLeftColorsDirty)
     {
-        mLeftColors.clear();
+        int count = 0;
 
-        for (const auto colorPoint : mColorPoints)
+        for (const auto& colorPoint : mColorPoints)
         {
-            if (colorPoint->type == ColorPointType::Left)
-                mLeftColors << colorPoint->color;
+            if (colorPoint.type == ColorPointType::Left)
+                mLeftColors[count++] = colorPoint.color;
         }
 
         mLeftColorsDirty = false;
     }
 
-    return mLeftColors;
+    return std::span(mLeftColors.data(), GetNumberOfLeftColors());
 }
 
-const QVector<QVector4D>& DiffusionCurveRenderer::Bezier::GetRightColors()
+std::span<const QVector4D> DiffusionCurveRenderer::Bezier::GetRightColors()
 {
     if (mRightColorsDirty)
     {
-        mRightColors.clear();
+        int count = 0;
 
-        for (const auto colorPoint : mColorPoints)
+        for (const auto& colorPoint : mColorPoints)
         {
-            if (colorPoint->type == ColorPointType::Right)
-                mRightColors << colorPoint->color;
+            if (colorPoint.type == ColorPointType::Right)
+                mRightColors[count++] = colorPoint.color;
         }
 
         mRightColorsDirty = false;
     }
 
-    return mRightColors;
+    return std::span(mRightColors.data(), GetNumberOfRightColors());
 }
 
-const QVector<float>& DiffusionCurveRenderer::Bezier::GetBlurPointStrengths()
+std::span<const float> DiffusionCurveRenderer::Bezier::GetBlurPointStrengths()
 {
     if (mBlurPointStrengthsDirty)
     {
-        mBlurPointStrenghts.clear();
-
-        for (const auto& blurPoint : mBlurPoints)
-            mBlurPointStrenghts << blurPoint->strength;
+        for (int i = 0; i < mBlurPoints.Size(); ++i)
+            mBlurPointStrengths[i] = mBlurPoints[i].strength;
 
         mBlurPointStrengthsDirty = false;
     }
 
-    return mBlurPointStrenghts;
+    return std::span(mBlurPointStrengths.data(), mBlurPoints.Size());
 }
 
 int DiffusionCurveRenderer::Bezier::GetNumberOfLeftColors() const
 {
-    return mLeftColors.size();
+    return std::count_if(mColorPoints.begin(), mColorPoints.end(), [](const ColorPoint& point) { return point.type == ColorPointType::Left; });
 }
 
 int DiffusionCurveRenderer::Bezier::GetNumberOfRightColors() const
 {
-    return mRightColors.size();
+    return std::count_if(mColorPoints.begin(), mColorPoints.end(), [](const ColorPoint& point) { return point.type == ColorPointType::Right; });
 }
 
 int DiffusionCurveRenderer::Bezier::GetNumberOfBlurPoints() const
 {
-    return mBlurPoints.size();
+    return mBlurPoints.Size();
 }
 
 void DiffusionCurveRenderer::Bezier::SortColorPoints()
 {
-    std::sort(mColorPoints.begin(), mColorPoints.end(), [](ColorPointPtr a, const ColorPointPtr b)
-              { return a->position < b->position; });
+    mColorPoints.Sort([](const ColorPoint& a, const ColorPoint& b) { return a.position < b.position; });
 }
 
 void DiffusionCurveRenderer::Bezier::SortBlurPoints()
 {
-    std::sort(mBlurPoints.begin(), mBlurPoints.end(), [](BlurPointPtr a, const BlurPointPtr b)
-              { return a->position < b->position; });
+    mBlurPoints.Sort([](const BlurPoint& a, const BlurPoint& b) { return a.position < b.position; });
 }
 
-QVector<float> DiffusionCurveRenderer::Bezier::GetCoefficients() const
+int DiffusionCurveRenderer::Bezier::GatherControlPointPositions(QVector2D* positions) const
 {
-    const int n = GetDegree();
-
-    QVector<float> coefficients;
+    const int order = mControlPoints.Size();
 
-    for (int i = 0; i <= n; ++i)
-    {
-        coefficients << Choose(n, i);
-    }
+    for (int i = 0; i < order; ++i)
+        positions[i] = mControlPoints[i].position;
 
-    return coefficients;
+    return order;
 }
 
-QVector<float> DiffusionCurveRenderer::Bezier::GetDerivativeCoefficients() const
+int DiffusionCurveRenderer::Bezier::GetOrder() const
 {
-    const int n = GetDegree();
-
-    QVector<float> coefficients;
-
-    for (int i = 0; i <= n - 1; ++i)
-    {
-        coefficients << Choose(n - 1, i);
-    }
-
-    return coefficients;
+    return mControlPoints.Size();
 }
 
-float DiffusionCurveRenderer::Bezier::Factorial(int n) const
+int DiffusionCurveRenderer::Bezier::GetDegree() const
 {
-    double result = 1.0;
-
-    for (int i = 1; i <= n; ++i)
-    {
-        result *= float(i);
-    }
-
-    return result;
+    return mControlPoints.Size() - 1;
 }
 
-float DiffusionCurveRenderer::Bezier::Choose(int n, int k) const
+void DiffusionCurveRenderer::Bezier::RemoveAllControlPoints()
 {
-    return Factorial(n) / (Factorial(k) * Factorial(n - k));
+    mControlPoints.Clear();
+    Update();
 }
 
-int DiffusionCurveRenderer::Bezier::GetOrder() const
+void DiffusionCurveRenderer::Bezier::SetControlPointPositions(std::span<const QVector2D> positions)
 {
-    return mControlPoints.size();
+    DCR_ASSERT(positions.size() <= Bernstein::MAX_ORDER);
+
+    const int size = positions.size();
+
+    mControlPoints.Resize(size);
+
+    for (int i = 0; i < size; ++i)
+        mControlPoints[i].position = positions[i];
+
+    mControlPointsDirty = true;
+    ++mGeometryRevision;
 }
 
-int DiffusionCurveRenderer::Bezier::GetDegree() const
+void DiffusionCurveRenderer::Bezier::RemapColorAndBlurPoints(float scale, float offset)
 {
-    return mControlPoints.size() - 1;
+    for (auto& colorPoint : mColorPoints)
+        colorPoint.position = offset + scale * colorPoint.position;
+
+    for (auto& blurPoint : mBlurPoints)
+        blurPoint.position = offset + scale * blurPoint.position;
+
+    mLeftColorPositionsDirty = true;
+    mRightColorPositionsDirty = true;
+    mBlurPointPositionsDirty = true;
 }
 
-void DiffusionCurveRenderer::Bezier::RemoveAllControlPoints()
+void DiffusionCurveRenderer::Bezier::TakeColorAndBlurPoints(Bezier& other)
 {
-    mControlPoints.clear();
-    mControlPointPositions.clear();
+    for (const auto& colorPoint : other.mColorPoints)
+    {
+        if (mColorPoints.Append(colorPoint) == nullptr)
+        {
+            LOG_WARN("Bezier::TakeColorAndBlurPoints: Some ColorPoints are dropped because the total number of ColorPoints is {}.", MAX_COLOR_POINTS);
+            break;
+        }
+    }
+
+    for (const auto& blurPoint : other.mBlurPoints)
+    {
+        if (mBlurPoints.Append(blurPoint) == nullptr)
+        {
+            LOG_WARN("Bezier::TakeColorAndBlurPoints: Some BlurPoints are dropped because the total number of BlurPoints is {}.", MAX_BLUR_POINTS);
+            break;
+        }
+    }
+
+    other.mColorPoints.Clear();
+    other.mBlurPoints.Clear();
+    other.Update();
+
+    SortColorPoints();
+    SortBlurPoints();
     Update();
 }
 
 DiffusionCurveRenderer::ColorPointPtr DiffusionCurveRenderer::Bezier::AddColorPoint(ColorPointType type, const QVector4D& color, float position)
 {
-    if (mColorPoints.size() >= 16)
+    ColorPoint* point = mColorPoints.Append(ColorPoint{ type, color, position });
+
+    if (point == nullptr)
     {
-        LOG_WARN("Bezier::AddColorPoint: ColorPoint could not be added because the total number of ColorPoints is 16.");
+        LOG_WARN("Bezier::AddColorPoint: ColorPoint could not be added because the total number of ColorPoints is {}.", MAX_COLOR_POINTS);
         return nullptr;
     }
 
-    ColorPointPtr point = std::make_shared<ColorPoint>(type, color, position);
-    mColorPoints << point;
     SortColorPoints();
     Update();
 
-    return point;
+    return MakeHandle(mColorPoints, point);
 }
 
 bool DiffusionCurveRenderer::Bezier::RemoveColorPoint(ColorPointPtr point)
 {
-    int index = -1;
-    for (int i = 0; i < mColorPoints.size(); ++i)
-    {
-        if (mColorPoints[i] == point)
-        {
-            index = i;
-            break;
-        }
-    }
+    const int index = mColorPoints.IndexOf(point.get());
 
     if (index != -1)
     {
-        mColorPoints.remove(index);
-        SortColorPoints();
+        mColorPoints.RemoveAt(index);
         Update();
 
         return true;
@@ -357,36 +617,27 @@ bool DiffusionCurveRenderer::Bezier::RemoveColorPoint(ColorPointPtr point)
 
 DiffusionCurveRenderer::BlurPointPtr DiffusionCurveRenderer::Bezier::AddBlurPoint(float position, float strength)
 {
-    if (mBlurPoints.size() >= 16)
+    BlurPoint* point = mBlurPoints.Append(BlurPoint{ position, strength });
+
+    if (point == nullptr)
     {
-        LOG_WARN("Bezier::AddBlurPoint: BlurPoint could not be added because the total number of BlurPoints is 16.");
+        LOG_WARN("Bezier::AddBlurPoint: BlurPoint could not be added because the total number of BlurPoints is {}.", MAX_BLUR_POINTS);
         return nullptr;
     }
 
-    BlurPointPtr point = std::make_shared<BlurPoint>(position, strength);
-    mBlurPoints << point;
     SortBlurPoints();
     Update();
 
-    return point;
+    return MakeHandle(mBlurPoints, point);
 }
 
 bool DiffusionCurveRenderer::Bezier::RemoveBlurPoint(BlurPointPtr point)
 {
-    int index = -1;
-    for (int i = 0; i < mBlurPoints.size(); ++i)
-    {
-        if (mBlurPoints[i] == point)
-        {
-            index = i;
-            break;
-        }
-    }
+    const int index = mBlurPoints.IndexOf(point.get());
 
     if (index != -1)
     {
-        mBlurPoints.remove(index);
-        SortBlurPoints();
+        mBlurPoints.RemoveAt(index);
         Update();
 
         return true;
@@ -399,36 +650,36 @@ DiffusionCurveRenderer::ColorPointPtr DiffusionCurveRenderer::Bezier::FindColorP
 {
     MEASURE_CALL_TIME(BEZIER_FIND_COLOR_POINT_AROUND);
 
-    ColorPointPtr result = nullptr;
+    ColorPoint* result = nullptr;
 
     float minDistance = std::numeric_limits<float>::infinity();
 
-    for (const auto& colorPoint : mColorPoints)
+    for (auto& colorPoint : mColorPoints)
     {
-        offset = colorPoint->type == ColorPointType::Left ? -offset : offset;
+        offset = colorPoint.type == ColorPointType::Left ? -offset : offset;
 
-        QVector2D positionOnCurve = PositionAt(colorPoint->position);
-        QVector2D translatedPosition = positionOnCurve + NormalAt(colorPoint->position) * offset;
+        QVector2D positionOnCurve = PositionAt(colorPoint.position);
+        QVector2D translatedPosition = positionOnCurve + NormalAt(colorPoint.position) * offset;
 
         float distance = translatedPosition.distanceToPoint(test);
 
         if (distance < minDistance)
         {
             minDistance = distance;
-            result = colorPoint;
+            result = &colorPoint;
         }
     }
 
     if (tolerance < minDistance)
         result = nullptr;
 
-    return result;
+    return MakeHandle(mColorPoints, result);
 }
 
 QVector4D DiffusionCurveRenderer::Bezier::GetLeftColorAt(float t)
 {
-    const auto& colors = GetLeftColors();
-    const auto& positions = GetLeftColorPositions();
+    const auto colors = GetLeftColors();
+    const auto positions = GetLeftColorPositions();
 
     DCR_ASSERT(colors.size() == positions.size());
 
@@ -437,7 +688,7 @@ QVector4D DiffusionCurveRenderer::Bezier::GetLeftColorAt(float t)
         return QVector4D(0, 0, 0, 0);
     }
 
-    for (int i = 1; i < positions.size(); ++i)
+    for (int i = 1; i < int(positions.size()); ++i)
     {
         if (positions[i - 1] <= t && t <= positions[i])
         {
@@ -451,8 +702,8 @@ QVector4D DiffusionCurveRenderer::Bezier::GetLeftColorAt(float t)
 
 QVector4D DiffusionCurveRenderer::Bezier::GetRightColorAt(float t)
 {
-    const auto& colors = GetRightColors();
-    const auto& positions = GetRightColorPositions();
+    const auto colors = GetRightColors();
+    const auto positions = GetRightColorPositions();
 
     DCR_ASSERT(colors.size() == positions.size());
 
@@ -461,7 +712,7 @@ QVector4D DiffusionCurveRenderer::Bezier::GetRightColorAt(float t)
         return QVector4D(0, 0, 0, 0);
     }
 
-    for (int i = 1; i < positions.size(); ++i)
+    for (int i = 1; i < int(positions.size()); ++i)
     {
         if (positions[i - 1] <= t && t <= positions[i])
         {
@@ -480,8 +731,8 @@ QJsonObject DiffusionCurveRenderer::Bezier::ToJsonObject()
     for (const auto& point : mControlPoints)
     {
         QJsonObject object;
-        object.insert("x", point->position.x());
-        object.insert("y", point->position.y());
+        object.insert("x", point.position.x());
+        object.insert("y", point.position.y());
         controlPoints.append(object);
     }
 
@@ -490,11 +741,11 @@ QJsonObject DiffusionCurveRenderer::Bezier::ToJsonObject()
     for (const auto& point : mColorPoints)
     {
         QJsonObject object;
-        object.insert("t", static_cast<int>(point->type));
-        object.insert("p", point->position);
-        object.insert("r", point->color.x());
-        object.insert("g", point->color.y());
-        object.insert("b", point->color.z());
+        object.insert("t", static_cast<int>(point.type));
+        object.insert("p", point.position);
+        object.insert("r", point.color.x());
+        object.insert("g", point.color.y());
+        object.insert("b", point.color.z());
 
         colorPoints.append(object);
     }
@@ -504,8 +755,8 @@ QJsonObject DiffusionCurveRenderer::Bezier::ToJsonObject()
     for (const auto& point : mBlurPoints)
     {
         QJsonObject object;
-        object.insert("p", point->position);
-        object.insert("s", point->strength);
+        object.insert("p", point.position);
+        object.insert("s", point.strength);
         colorPoints.append(object);
     }
 
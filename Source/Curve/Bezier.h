@@ -1,12 +1,16 @@
 #pragma once
 
+#include "ArcLengthTable.h"
+#include "Bernstein.h"
 #include "Curve.h"
+#include "Structs/SlotArray.h"
 #include "Util/Macros.h"
 
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QObject>
 #include <QVector>
+#include <limits>
 #include <memory>
 
 namespace DiffusionCurveRenderer
@@ -22,9 +26,16 @@ namespace DiffusionCurveRenderer
         QVector2D PositionAt(float t) const override;
         QVector2D TangentAt(float t) const override;
         QVector2D NormalAt(float t) const override;
+        float ParameterAt(const QVector2D& point) const override;
+
+        void PositionsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const override;
+        void TangentsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const override;
 
         void Update() override;
 
+        const BoundingBox& GetBoundingBox() const override;
+        float GetLength() const override;
+
         ControlPointPtr GetControlPoint(int index) override;
         QVector2D GetControlPointPosition(int index) const override;
 
@@ -32,9 +43,8 @@ namespace DiffusionCurveRenderer
         void RemoveControlPoint(ControlPointPtr point) override;
         void RemoveControlPoint(int index) override;
 
-        const QVector<ControlPointPtr>& GetControlPoints() const override { return mControlPoints; };
-        const QVector<QVector2D>& GetControlPointPositions() override;
-        int GetNumberOfControlPoints() const override { return mControlPoints.size(); };
+        std::span<const QVector2D> GetControlPointPositions() override;
+        int GetNumberOfControlPoints() const override { return mControlPoints.Size(); };
 
         ColorPointPtr AddColorPoint(ColorPointType type, const QVector4D& color, float position) override;
         bool RemoveColorPoint(ColorPointPtr point) override;
@@ -45,19 +55,27 @@ namespace DiffusionCurveRenderer
         ColorPointPtr FindColorPointAround(const QVector2D& test, float offset, float tolerance) override;
 
         // Bezier
+        // Closest point projection, returns the parameter and writes the distance to "distance".
+        // Gives up early with an infinite distance if the curve cannot be closer than "maxDistance".
+        float Project(const QVector2D& point, float& distance, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+        // Cached, for conversions between the parameter and the arc length
+        const ArcLengthTable& GetArcLengthTable() const;
+
         QVector4D GetLeftColorAt(float t);
         QVector4D GetRightColorAt(float t);
 
         void SetAllBlurPointsStrength(float strength);
 
-        const QVector<float>& GetLeftColorPositions();
-        const QVector<float>& GetRightColorPositions();
+        // SoA views for the renderers, rebuilt in place when dirty
+        std::span<const float> GetLeftColorPositions();
+        std::span<const float> GetRightColorPositions();
 
-        const QVector<QVector4D>& GetLeftColors();
-        const QVector<QVector4D>& GetRightColors();
+        std::span<const QVector4D> GetLeftColors();
+        std::span<const QVector4D> GetRightColors();
 
-        const QVector<float>& GetBlurPointPositions();
-        const QVector<float>& GetBlurPointStrengths();
+        std::span<const float> GetBlurPointPositions();
+        std::span<const float> GetBlurPointStrengths();
 
         int GetNumberOfLeftColors() const;
         int GetNumberOfRightColors() const;
@@ -71,21 +89,37 @@ namespace DiffusionCurveRenderer
 
         void RemoveAllControlPoints();
 
-        const QVector<ColorPointPtr>& GetColorPoints() const { return mColorPoints; };
-        const QVector<BlurPointPtr>& GetBlurPoints() const { return mBlurPoints; };
+        // Moves the existing control points in place, control points are added or removed at the end if the sizes differ
+        void SetControlPointPositions(std::span<const QVector2D> positions);
+
+        // Maps the parameter p of every color and blur point to offset + scale * p
+        void RemapColorAndBlurPoints(float scale, float offset);
+
+        // Moves the color and blur points of "other" into this curve without changing their parameters
+        void TakeColorAndBlurPoints(Bezier& other);
+
+        // Left and right color points share one capacity
+        static constexpr int MAX_COLOR_POINTS = 16;
+        static constexpr int MAX_BLUR_POINTS = 16;
+
+        using ControlPoints = SlotArray<ControlPoint, Bernstein::MAX_ORDER>;
+        using ColorPoints = SlotArray<ColorPoint, MAX_COLOR_POINTS>;
+        using BlurPoints = SlotArray<BlurPoint, MAX_BLUR_POINTS>;
+
+        const ColorPoints& GetColorPoints() const { return mColorPoints; };
+        const BlurPoints& GetBlurPoints() const { return mBlurPoints; };
 
         QJsonObject ToJsonObject();
         static CurvePtr FromJsonObject(QJsonObject object);
 
       private:
-        QVector<float> GetCoefficients() const;
-        QVector<float> GetDerivativeCoefficients() const;
-        float Factorial(int n) const;
-        float Choose(int n, int k) const;
+        int GatherControlPointPositions(QVector2D* positions) const;
+        const QVector<QVector2D>& GetPolyline() const;
 
-        QVector<ControlPointPtr> mControlPoints;
-        QVector<ColorPointPtr> mColorPoints;
-        QVector<BlurPointPtr> mBlurPoints;
+        // Stored inline, handles handed out by the getters point into these
+        ControlPoints mControlPoints;
+        ColorPoints mColorPoints;
+        BlurPoints mBlurPoints;
 
         // Cached
         DEFINE_MEMBER(bool, ControlPointsDirty, true);
@@ -96,15 +130,32 @@ namespace DiffusionCurveRenderer
         DEFINE_MEMBER(bool, BlurPointPositionsDirty, true);
         DEFINE_MEMBER(bool, BlurPointStrengthsDirty, true);
 
-        QVector<QVector2D> mControlPointPositions;
+        std::array<QVector2D, Bernstein::MAX_ORDER> mControlPointPositions;
+
+        std::array<float, MAX_COLOR_POINTS> mLeftColorPositions;
+        std::array<float, MAX_COLOR_POINTS> mRightColorPositions;
+        std::array<QVector4D, MAX_COLOR_POINTS> mLeftColors;
+        std::array<QVector4D, MAX_COLOR_POINTS> mRightColors;
+
+        std::array<float, MAX_BLUR_POINTS> mBlurPointPositions;
+        std::array<float, MAX_BLUR_POINTS> mBlurPointStrengths;
+
+        // Incremented whenever the control points change, lazily built geometry caches compare against it
+        quint64 mGeometryRevision{ 1 };
+
+        // Coarse polyline at uniform parameters for the projection
+        mutable QVector<QVector2D> mPolyline;
+        mutable float mPolylineError{ 0.0f };
+        mutable quint64 mPolylineRevision{ 0 };
+
+        // Tight box, exact up to cubics and the union of the hulls of subdivided pieces above
+        mutable BoundingBox mBoundingBox;
+        mutable quint64 mBoundingBoxRevision{ 0 };
 
-        QVector<float> mLeftColorPositions;
-        QVector<float> mRightColorPositions;
-        QVector<QVector4D> mLeftColors;
-        QVector<QVector4D> mRightColors;
+        static constexpr int BOUNDING_BOX_PIECES = 8;
 
-        QVector<float> mBlurPointPositions;
-        QVector<float> mBlurPointStrenghts;
+        mutable ArcLengthTable mArcLengthTable;
+        mutable quint64 mArcLengthTableRevision{ 0 };
     };
 
     using BezierPtr = std::shared_ptr<Bezier>;
@@ -1,5 +1,8 @@
 #include "Curve.h"
 
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::Curve::FindControlPointAround(const QVector2D& test, float radius)
@@ -30,46 +33,96 @@ DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::Curve::FindContr
 
 float DiffusionCurveRenderer::Curve::GetDistanceToPoint(const QVector2D& point, int intervals) const
 {
-    float minDistance = std::numeric_limits<float>::infinity();
+    QVarLengthArray<float, 128> parameters(intervals);
+    QVarLengthArray<float, 128> xs(intervals);
+    QVarLengthArray<float, 128> ys(intervals);
+
     const float dt = 1.0f / intervals;
-    float t = 0.0f;
 
     for (int i = 0; i < intervals; ++i)
-    {
-        const float distance = PositionAt(t).distanceToPoint(point);
+        parameters[i] = i * dt;
 
-        if (distance < minDistance)
-        {
-            minDistance = distance;
-        }
+    PositionsAt(parameters, xs, ys);
+
+    float minDistanceSquared = std::numeric_limits<float>::infinity();
 
-        t += dt;
+    for (int i = 0; i < intervals; ++i)
+    {
+        const float dx = xs[i] - point.x();
+        const float dy = ys[i] - point.y();
+        minDistanceSquared = std::min(minDistanceSquared, dx * dx + dy * dy);
     }
 
-    return minDistance;
+    return std::sqrt(minDistanceSquared);
 }
 
-float DiffusionCurveRenderer::Curve::ParameterAt(const QVector2D& point, int intervals) const
+float DiffusionCurveRenderer::Curve::ParameterAt(const QVector2D& point) const
 {
-    float t = 0;
-    float dt = 1.0f / intervals;
-    float minimumDistance = std::numeric_limits<float>::infinity();
+    constexpr int intervals = 1000;
+
+    QVarLengthArray<float, 1024> parameters(intervals + 1);
+    QVarLengthArray<float, 1024> xs(intervals + 1);
+    QVarLengthArray<float, 1024> ys(intervals + 1);
+
+    const float dt = 1.0f / intervals;
+
+    for (int i = 0; i <= intervals; ++i)
+        parameters[i] = i * dt;
+
+    PositionsAt(parameters, xs, ys);
+
+    float minimumDistanceSquared = std::numeric_limits<float>::infinity();
     float parameter = 0;
 
     for (int i = 0; i <= intervals; i++)
     {
-        float distance = PositionAt(t).distanceToPoint(point);
-        if (distance < minimumDistance)
+        const float dx = xs[i] - point.x();
+        const float dy = ys[i] - point.y();
+        const float distanceSquared = dx * dx + dy * dy;
+
+        if (distanceSquared < minimumDistanceSquared)
         {
-            minimumDistance = distance;
-            parameter = t;
+            minimumDistanceSquared = distanceSquared;
+            parameter = parameters[i];
         }
-        t += dt;
     }
 
     return parameter;
 }
 
+void DiffusionCurveRenderer::Curve::PositionsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        const QVector2D position = PositionAt(parameters[i]);
+        xs[i] = position.x();
+        ys[i] = position.y();
+    }
+}
+
+void DiffusionCurveRenderer::Curve::TangentsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        const QVector2D tangent = TangentAt(parameters[i]);
+        xs[i] = tangent.x();
+        ys[i] = tangent.y();
+    }
+}
+
+void DiffusionCurveRenderer::Curve::NormalsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    TangentsAt(parameters, xs, ys);
+
+    // Same as NormalAt, (x, y) -> (-y, x)
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        const float x = xs[i];
+        xs[i] = -ys[i];
+        ys[i] = x;
+    }
+}
+
 DiffusionCurveRenderer::ColorPointPtr DiffusionCurveRenderer::Curve::TryCreateColorPointAt(const QVector2D& worldPosition) const
 {
     if (GetNumberOfControlPoints() < 1)
@@ -93,17 +146,26 @@ DiffusionCurveRenderer::ColorPointPtr DiffusionCurveRenderer::Curve::TryCreateCo
 
 float DiffusionCurveRenderer::Curve::CalculateLength(int intervals) const
 {
-    float length = 0.0f;
-    float t = 0.0f;
+    QVarLengthArray<float, 128> parameters(intervals + 1);
+    QVarLengthArray<float, 128> xs(intervals + 1);
+    QVarLengthArray<float, 128> ys(intervals + 1);
+
     const float dt = 1.0f / static_cast<float>(intervals);
 
+    for (int i = 0; i <= intervals; ++i)
+        parameters[i] = i * dt;
+
+    PositionsAt(parameters, xs, ys);
+
+    float length = 0.0f;
+
     for (int i = 0; i < intervals; ++i)
-    {
-        QVector2D v1 = PositionAt(t);
-        QVector2D v2 = PositionAt(t + dt);
-        length += v1.distanceToPoint(v2);
-        t += dt;
-    }
+        length += std::hypot(xs[i + 1] - xs[i], ys[i + 1] - ys[i]);
 
     return length;
 }
+
+float DiffusionCurveRenderer::Curve::GetLength() const
+{
+    return CalculateLength();
+}
@@ -1,13 +1,16 @@
 #pragma once
 
 #include "Core/Constants.h"
+#include "Structs/BoundingBox.h"
 #include "Structs/Enums.h"
+#include "Structs/SlotHandle.h"
 #include "Util/Macros.h"
 
 #include <QVector2D>
 #include <QVector4D>
 #include <QVector>
 #include <memory>
+#include <span>
 
 namespace DiffusionCurveRenderer
 {
@@ -29,11 +32,11 @@ namespace DiffusionCurveRenderer
         float strength{ 0 };
     };
 
-    using ControlPointPtr = std::shared_ptr<ControlPoint>;
-    using ColorPointPtr = std::shared_ptr<ColorPoint>;
-    using BlurPointPtr = std::shared_ptr<BlurPoint>;
+    using ControlPointPtr = SlotHandle<ControlPoint>;
+    using ColorPointPtr = SlotHandle<ColorPoint>;
+    using BlurPointPtr = SlotHandle<BlurPoint>;
 
-    class Curve
+    class Curve : public std::enable_shared_from_this<Curve>
     {
       public:
         Curve() = default;
@@ -42,10 +45,18 @@ namespace DiffusionCurveRenderer
         virtual QVector2D PositionAt(float t) const = 0;
         virtual QVector2D TangentAt(float t) const = 0;
         virtual QVector2D NormalAt(float t) const = 0;
-        virtual float ParameterAt(const QVector2D& point, int intervals = 1000) const;
+        virtual float ParameterAt(const QVector2D& point) const;
+
+        // Batched evaluation into SoA buffers, "xs" and "ys" must have the size of "parameters"
+        virtual void PositionsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const;
+        virtual void TangentsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const;
+        virtual void NormalsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const;
 
         virtual void Update() = 0;
 
+        // Cached, valid after Update()
+        virtual const BoundingBox& GetBoundingBox() const = 0;
+
         virtual ControlPointPtr GetControlPoint(int index) = 0;
         virtual QVector2D GetControlPointPosition(int index) const = 0;
 
@@ -53,12 +64,11 @@ namespace DiffusionCurveRenderer
         virtual void RemoveControlPoint(ControlPointPtr point) = 0;
         virtual void RemoveControlPoint(int index) = 0;
 
-        virtual const QVector<ControlPointPtr>& GetControlPoints() const = 0;
         virtual int GetNumberOfControlPoints() const = 0;
 
         virtual ColorPointPtr FindColorPointAround(const QVector2D& test, float offset, float tolerance) = 0;
 
-        virtual const QVector<QVector2D>& GetControlPointPositions() = 0;
+        virtual std::span<const QVector2D> GetControlPointPositions() = 0;
 
         virtual ColorPointPtr AddColorPoint(ColorPointType type, const QVector4D& color, float position) = 0;
         virtual bool RemoveColorPoint(ColorPointPtr point) = 0;
@@ -74,6 +84,22 @@ namespace DiffusionCurveRenderer
 
         float CalculateLength(int intervals = 100) const;
 
+        // Arc length, curves that tabulate it override this
+        virtual float GetLength() const;
+
+      protected:
+        // Handle to a point stored in "storage" inside the curve. It shares the ownership of the curve, so no
+        // allocation is made and the point lives as long as the curve. Curves that are not owned by
+        // a shared pointer hand out non-owning handles.
+        template<typename Storage, typename T>
+        SlotHandle<T> MakeHandle(const Storage& storage, T* point) const
+        {
+            if (point == nullptr)
+                return nullptr;
+
+            return SlotHandle<T>(std::shared_ptr<T>(weak_from_this().lock(), point), storage.GetGeneration(point));
+        }
+
       private:
         DEFINE_MEMBER(QVector4D, ContourColor, QVector4D(0, 0, 0, 1));
         DEFINE_MEMBER(float, ContourThickness, DEFAULT_CONTOUR_THICKNESS);
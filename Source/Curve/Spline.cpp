@@ -2,6 +2,9 @@
 
 #include "Util/Logger.h"
 
+#include <QVarLengthArray>
+#include <algorithm>
+#include <cmath>
 #include <limits>
 
 DiffusionCurveRenderer::BezierPtr DiffusionCurveRenderer::Spline::GetBezierPatchAt(float t) const
@@ -37,8 +40,9 @@ int DiffusionCurveRenderer::Spline::GetBezierPatchIndexAt(float t) const
 
 float DiffusionCurveRenderer::Spline::TransformToPatch(float t) const
 {
+    // Relative to the patch returned by GetBezierPatchIndexAt, so that t = k / n maps to the end of patch k - 1
     int numberOfPatches = mBezierPatches.size();
-    return t * numberOfPatches - static_cast<int>(t * numberOfPatches);
+    return t * numberOfPatches - std::max(0, GetBezierPatchIndexAt(t));
 }
 
 float DiffusionCurveRenderer::Spline::TransformToSpline(int patchIndex, float t) const
@@ -75,6 +79,134 @@ QVector2D DiffusionCurveRenderer::Spline::NormalAt(float t) const
         return QVector2D();
 }
 
+float DiffusionCurveRenderer::Spline::ParameterAt(const QVector2D& point) const
+{
+    const int numberOfPatches = mBezierPatches.size();
+
+    if (numberOfPatches == 0)
+        return 0.0f;
+
+    // The distance to the box of a patch is a lower bound of the distance to the patch. The patch
+    // with the nearest box is projected first, then the others only if their box is closer.
+    QVarLengthArray<float, 64> bounds(numberOfPatches);
+    int nearest = 0;
+
+    for (int i = 0; i < numberOfPatches; ++i)
+    {
+        bounds[i] = mBezierPatches[i]->GetBoundingBox().DistanceTo(point);
+
+        if (bounds[i] < bounds[nearest])
+            nearest = i;
+    }
+
+    float minDistance;
+    float parameter = TransformToSpline(nearest, mBezierPatches[nearest]->Project(point, minDistance));
+
+    for (int i = 0; i < numberOfPatches; ++i)
+    {
+        if (i == nearest || bounds[i] >= minDistance)
+            continue;
+
+        float distance;
+        const float t = mBezierPatches[i]->Project(point, distance, minDistance);
+
+        if (distance < minDistance)
+        {
+            minDistance = distance;
+            parameter = TransformToSpline(i, t);
+        }
+    }
+
+    return parameter;
+}
+
+template<typename Evaluate>
+void DiffusionCurveRenderer::Spline::EvaluatePatches(std::span<const float> parameters, std::span<float> xs, std::span<float> ys, Evaluate evaluate) const
+{
+    const int numberOfPatches = mBezierPatches.size();
+    const int count = parameters.size();
+
+    QVarLengthArray<int, 64> offsets(numberOfPatches + 1);
+    QVarLengthArray<int, 256> patchIndices(count);
+
+    std::fill(offsets.begin(), offsets.end(), 0);
+
+    for (int i = 0; i < count; ++i)
+    {
+        // Same patch as GetBezierPatchIndexAt
+        const int index = std::clamp(static_cast<int>(std::ceil(parameters[i] * numberOfPatches)) - 1, 0, numberOfPatches - 1);
+        patchIndices[i] = index;
+        offsets[index + 1]++;
+    }
+
+    for (int i = 0; i < numberOfPatches; ++i)
+        offsets[i + 1] += offsets[i];
+
+    // Counting sort, consecutive parameters of the same patch stay consecutive
+    QVarLengthArray<int, 256> order(count);
+    QVarLengthArray<float, 256> localParameters(count);
+    QVarLengthArray<float, 256> localXs(count);
+    QVarLengthArray<float, 256> localYs(count);
+    QVarLengthArray<int, 64> cursors(offsets.begin(), offsets.end());
+
+    for (int i = 0; i < count; ++i)
+    {
+        const int index = patchIndices[i];
+        const int slot = cursors[index]++;
+        order[slot] = i;
+        localParameters[slot] = parameters[i] * numberOfPatches - index;
+    }
+
+    for (int index = 0; index < numberOfPatches; ++index)
+    {
+        const int begin = offsets[index];
+        const int size = offsets[index + 1] - begin;
+
+        if (size == 0)
+            continue;
+
+        evaluate(mBezierPatches[index],
+                 std::span<const float>(localParameters.data() + begin, size),
+                 std::span<float>(localXs.data() + begin, size),
+                 std::span<float>(localYs.data() + begin, size));
+    }
+
+    for (int slot = 0; slot < count; ++slot)
+    {
+        xs[order[slot]] = localXs[slot];
+        ys[order[slot]] = localYs[slot];
+    }
+}
+
+void DiffusionCurveRenderer::Spline::PositionsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    if (mBezierPatches.isEmpty())
+    {
+        const QVector2D position = mControlPoints.isEmpty() ? QVector2D() : mControlPoints.first()->position;
+        std::fill(xs.begin(), xs.end(), position.x());
+        std::fill(ys.begin(), ys.end(), position.y());
+        return;
+    }
+
+    EvaluatePatches(parameters, xs, ys, [](const BezierPtr& patch, auto localParameters, auto localXs, auto localYs) {
+        patch->PositionsAt(localParameters, localXs, localYs);
+    });
+}
+
+void DiffusionCurveRenderer::Spline::TangentsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const
+{
+    if (mBezierPatches.isEmpty())
+    {
+        std::fill(xs.begin(), xs.end(), 0.0f);
+        std::fill(ys.begin(), ys.end(), 0.0f);
+        return;
+    }
+
+    EvaluatePatches(parameters, xs, ys, [](const BezierPtr& patch, auto localParameters, auto localXs, auto localYs) {
+        patch->TangentsAt(localParameters, localXs, localYs);
+    });
+}
+
 DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::Spline::GetControlPoint(int index)
 {
     DCR_ASSERT(0 <= index && index < mControlPoints.size());
@@ -93,6 +225,11 @@ DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::Spline::AddContr
 {
     ControlPointPtr point = std::make_shared<ControlPoint>(position);
     mControlPoints << point;
+
+    // New knots are appended, existing patches keep their color points
+    if (mControlPoints.size() >= 2)
+        mBezierPatches << std::make_shared<Bezier>();
+
     mControlPointPositionsDirty = true;
     mIsPointAddedOrRemoved = true;
     Update();
@@ -113,10 +250,7 @@ void DiffusionCurveRenderer::Spline::RemoveControlPoint(ControlPointPtr point)
 
     if (index != -1)
     {
-        mControlPoints.remove(index);
-        mControlPointPositionsDirty = true;
-        mIsPointAddedOrRemoved = true;
-        Update();
+        RemoveControlPoint(index);
     }
     else
     {
@@ -126,180 +260,232 @@ void DiffusionCurveRenderer::Spline::RemoveControlPoint(ControlPointPtr point)
 
 void DiffusionCurveRenderer::Spline::RemoveControlPoint(int index)
 {
+    DCR_ASSERT(0 <= index && index < mControlPoints.size());
+
+    RemovePatchesAt(index);
+
     mControlPoints.removeAt(index);
     mControlPointPositionsDirty = true;
     mIsPointAddedOrRemoved = true;
     Update();
 }
 
-void DiffusionCurveRenderer::Spline::Update()
+void DiffusionCurveRenderer::Spline::RemovePatchesAt(int knotIndex)
 {
-    if (mIsPointAddedOrRemoved)
-    {
-        SaveColorPoints();
-
-        mBezierPatches.clear();
+    const int numberOfPatches = mBezierPatches.size();
 
-        for (int i = 0; i < mControlPoints.size() - 1; ++i)
-        {
-            mBezierPatches << std::make_shared<Bezier>();
-        }
-    }
+    if (numberOfPatches == 0)
+        return;
 
-    for (const auto& patch : mBezierPatches)
+    if (knotIndex == 0)
     {
-        patch->RemoveAllControlPoints();
+        mBezierPatches.removeFirst();
     }
-
-    if (mControlPoints.size() == 2)
+    else if (knotIndex >= numberOfPatches)
     {
-        for (int i = 0; i < mControlPoints.size(); ++i)
-        {
-            mBezierPatches[0]->AddControlPoint(mControlPoints[i]->position);
-        }
+        mBezierPatches.removeLast();
     }
-    else if (mControlPoints.size() == 3)
+    else
     {
+        // Interior knot, the two patches around it are merged into one
+        const auto& left = mBezierPatches[knotIndex - 1];
+        const auto& right = mBezierPatches[knotIndex];
 
-        for (int i = 0; i < 2; i++)
-        {
-            const auto cp0 = mControlPoints[i]->position;
-            const auto cp1 = (2.0f / 3.0f) * mControlPoints[i]->position + (1.0f / 3.0f) * mControlPoints[i + 1]->position;
-            const auto cp2 = (1.0f / 3.0f) * mControlPoints[i]->position + (2.0f / 3.0f) * mControlPoints[i + 1]->position;
-            const auto cp3 = mControlPoints[i + 1]->position;
-
-            mBezierPatches[i]->AddControlPoint(cp0);
-            mBezierPatches[i]->AddControlPoint(cp1);
-            mBezierPatches[i]->AddControlPoint(cp2);
-            mBezierPatches[i]->AddControlPoint(cp3);
-        }
+        left->RemapColorAndBlurPoints(0.5f, 0.0f);
+        right->RemapColorAndBlurPoints(0.5f, 0.5f);
+        left->TakeColorAndBlurPoints(*right);
+
+        mBezierPatches.removeAt(knotIndex);
     }
-    else if (mControlPoints.size() >= 4)
+}
+
+void DiffusionCurveRenderer::Spline::Update()
+{
+    const int n = mControlPoints.size();
+
+    // Find the knots that moved since the last update
+    int first = n;
+    int last = -1;
+
+    if (!mIsPointAddedOrRemoved && mKnotPositions.size() == n)
     {
-        QVector<QVector2D> splineControlPoints = GetSplineControlPoints();
+        for (int i = 0; i < n; ++i)
+        {
+            if (mKnotPositions[i] != mControlPoints[i]->position)
+            {
+                first = std::min(first, i);
+                last = i;
+            }
+        }
 
-        for (int i = 1; i < mControlPoints.size(); ++i)
+        // Nothing moved, the caller changed the colors
+        if (last == -1)
         {
-            const auto cp0 = mControlPoints[i - 1]->position;
-            const auto cp1 = (2.0f / 3.0f) * splineControlPoints[i - 1] + (1.0f / 3.0f) * splineControlPoints[i];
-            const auto cp2 = (1.0f / 3.0f) * splineControlPoints[i - 1] + (2.0f / 3.0f) * splineControlPoints[i];
-            const auto cp3 = mControlPoints[i]->position;
-
-            mBezierPatches[i - 1]->AddControlPoint(cp0);
-            mBezierPatches[i - 1]->AddControlPoint(cp1);
-            mBezierPatches[i - 1]->AddControlPoint(cp2);
-            mBezierPatches[i - 1]->AddControlPoint(cp3);
+            for (const auto& patch : mBezierPatches)
+                patch->Update();
+
+            return;
         }
     }
 
-    if (mIsPointAddedOrRemoved)
-    {
-        RestoreColorPoints();
-        mIsPointAddedOrRemoved = false;
-    }
+    if (last == -1 || n < 4 || ++mNumberOfLocalUpdates >= FULL_UPDATE_INTERVAL)
+        UpdateAllPatches();
+    else
+        UpdateMovedKnots(first, last);
+
+    mControlPointPositionsDirty = true;
+    mBoundingBoxDirty = true;
+    mIsPointAddedOrRemoved = false;
 }
 
-Eigen::MatrixXf DiffusionCurveRenderer::Spline::CreateCoefficientMatrix()
+float DiffusionCurveRenderer::Spline::GetLength() const
 {
-    int n = mControlPoints.size() - 2;
-    Eigen::MatrixXf coef(n, n);
+    float length = 0.0f;
 
-    for (int i = 0; i < n; ++i)
-    {
-        for (int j = 0; j < n; ++j)
-        {
-            coef(i, j) = 0;
-        }
-    }
+    for (const auto& patch : mBezierPatches)
+        length += patch->GetLength();
 
-    // First row
-    coef(0, 0) = 4;
-    coef(0, 1) = 1;
+    return length;
+}
 
-    for (int i = 1; i < n - 1; ++i)
+const DiffusionCurveRenderer::BoundingBox& DiffusionCurveRenderer::Spline::GetBoundingBox() const
+{
+    if (mBoundingBoxDirty)
     {
-        coef(i, i - 1) = 1;
-        coef(i, i) = 4;
-        coef(i, i + 1) = 1;
-    }
+        mBoundingBox = BoundingBox();
+
+        for (const auto& patch : mBezierPatches)
+            mBoundingBox.Expand(patch->GetBoundingBox());
 
-    // Last row
-    coef(n - 1, n - 2) = 1;
-    coef(n - 1, n - 1) = 4;
+        mBoundingBoxDirty = false;
+    }
 
-    return coef;
+    return mBoundingBox;
 }
 
-QVector<QVector2D> DiffusionCurveRenderer::Spline::GetSplineControlPoints()
+void DiffusionCurveRenderer::Spline::UpdateAllPatches()
 {
-    int n = mControlPoints.size();
+    const int n = mControlPoints.size();
+    const int numberOfPatches = std::max(0, n - 1);
+
+    if (mBezierPatches.size() > numberOfPatches)
+        mBezierPatches.resize(numberOfPatches);
 
-    Eigen::MatrixXf knotPoints(n, 2);
+    while (mBezierPatches.size() < numberOfPatches)
+        mBezierPatches << std::make_shared<Bezier>();
+
+    if (n >= 4)
+        SolveSplineControlPoints();
+
+    for (int i = 0; i < numberOfPatches; ++i)
+        UpdatePatch(i);
+
+    mKnotPositions.resize(n);
 
     for (int i = 0; i < n; ++i)
-    {
-        knotPoints(i, 0) = mControlPoints[i]->position.x();
-        knotPoints(i, 1) = mControlPoints[i]->position.y();
-    }
+        mKnotPositions[i] = mControlPoints[i]->position;
 
-    // Constants on the right side
-    Eigen::MatrixXf constants(n - 2, 2);
+    mNumberOfLocalUpdates = 0;
+}
 
-    for (int j = 0; j < 2; ++j)
-    {
-        constants(0, j) = 6 * knotPoints(1, j) - knotPoints(0, j);
-        constants(n - 3, j) = 6 * knotPoints(n - 2, j) - knotPoints(n - 1, j);
-    }
+void DiffusionCurveRenderer::Spline::UpdateMovedKnots(int first, int last)
+{
+    // The system is linear, so the spline control points change by the solution of the system whose
+    // right side is the change of the knots. The influence of a knot decays by 2 - sqrt(3) per index,
+    // so the change is solved on a window around the moved knots and assumed to be zero outside.
+    const int n = mControlPoints.size();
+    const int begin = std::max(1, first - LOCAL_UPDATE_MARGIN);
+    const int end = std::min(n - 2, last + LOCAL_UPDATE_MARGIN);
+
+    mSplineControlPointDeltas.resize(end - begin + 1);
+    std::fill(mSplineControlPointDeltas.begin(), mSplineControlPointDeltas.end(), QVector2D(0, 0));
 
-    for (int i = 1; i < n - 3; ++i)
+    for (int i = first; i <= last; ++i)
     {
-        for (int j = 0; j < 2; ++j)
-        {
-            constants(i, j) = 6 * knotPoints(i + 1, j);
-        }
-    }
+        const QVector2D delta = mControlPoints[i]->position - mKnotPositions[i];
 
-    // Compute B-Spline control points
-    Eigen::MatrixXf coef = CreateCoefficientMatrix();
-    Eigen::MatrixXf controlPoints = coef.inverse() * constants;
+        if (i == 0)
+            mSplineControlPointDeltas[1 - begin] -= delta;
+        else if (i == n - 1)
+            mSplineControlPointDeltas[n - 2 - begin] -= delta;
+        else
+            mSplineControlPointDeltas[i - begin] += 6 * delta;
 
-    // Result
-    QVector<QVector2D> result(n, QVector2D());
-    result[0] = QVector2D(knotPoints(0, 0), knotPoints(0, 1));
-    result[n - 1] = QVector2D(knotPoints(n - 1, 0), knotPoints(n - 1, 1));
-    for (int i = 0; i < n - 2; ++i)
-    {
-        result[i + 1] = QVector2D(controlPoints(i, 0), controlPoints(i, 1));
+        mKnotPositions[i] = mControlPoints[i]->position;
     }
 
-    return result;
+    mSolver.Solve(std::span(mSplineControlPointDeltas.data(), mSplineControlPointDeltas.size()));
+
+    for (int i = begin; i <= end; ++i)
+        mSplineControlPoints[i] += mSplineControlPointDeltas[i - begin];
+
+    mSplineControlPoints[0] = mControlPoints[0]->position;
+    mSplineControlPoints[n - 1] = mControlPoints[n - 1]->position;
+
+    // Patch i depends on the knots and spline control points i and i + 1
+    const int firstPatch = std::max(0, std::min(first, begin) - 1);
+    const int lastPatch = std::min(n - 2, std::max(last, end));
+
+    for (int i = firstPatch; i <= lastPatch; ++i)
+        UpdatePatch(i);
 }
 
-void DiffusionCurveRenderer::Spline::SaveColorPoints()
+void DiffusionCurveRenderer::Spline::UpdatePatch(int index)
 {
-    mColorsBeforeUpdate.clear();
-    for (int index = 0; index < mBezierPatches.size(); ++index)
+    const int n = mControlPoints.size();
+    const auto k0 = mControlPoints[index]->position;
+    const auto k1 = mControlPoints[index + 1]->position;
+
+    if (n == 2)
     {
-        const auto& patchColors = mBezierPatches[index]->GetColorPoints();
-        for (const auto color : patchColors)
-        {
-            ColorPointPtr point = std::make_shared<ColorPoint>(color->type, color->color, TransformToSpline(index, color->position));
-            mColorsBeforeUpdate << point;
-        }
+        const QVector2D positions[] = { k0, k1 };
+        mBezierPatches[index]->SetControlPointPositions(positions);
+    }
+    else if (n == 3)
+    {
+        const QVector2D positions[] = {
+            k0,
+            (2.0f / 3.0f) * k0 + (1.0f / 3.0f) * k1,
+            (1.0f / 3.0f) * k0 + (2.0f / 3.0f) * k1,
+            k1,
+        };
+
+        mBezierPatches[index]->SetControlPointPositions(positions);
+    }
+    else
+    {
+        const QVector2D positions[] = {
+            k0,
+            (2.0f / 3.0f) * mSplineControlPoints[index] + (1.0f / 3.0f) * mSplineControlPoints[index + 1],
+            (1.0f / 3.0f) * mSplineControlPoints[index] + (2.0f / 3.0f) * mSplineControlPoints[index + 1],
+            k1,
+        };
+
+        mBezierPatches[index]->SetControlPointPositions(positions);
     }
 }
 
-void DiffusionCurveRenderer::Spline::RestoreColorPoints()
+void DiffusionCurveRenderer::Spline::SolveSplineControlPoints()
 {
-    for (const auto color : mColorsBeforeUpdate)
-    {
-        AddColorPoint(color->type, color->color, color->position);
-    }
+    const int n = mControlPoints.size();
+
+    mSplineControlPoints.resize(n);
+
+    // Constants on the right side, the end knots are known so they are moved to the right side
+    for (int i = 1; i < n - 1; ++i)
+        mSplineControlPoints[i] = 6 * mControlPoints[i]->position;
+
+    mSplineControlPoints[1] -= mControlPoints[0]->position;
+    mSplineControlPoints[n - 2] -= mControlPoints[n - 1]->position;
+
+    // Compute B-Spline control points
+    mSolver.Solve(std::span(mSplineControlPoints.data() + 1, n - 2));
 
-    mColorsBeforeUpdate.clear();
+    mSplineControlPoints[0] = mControlPoints[0]->position;
+    mSplineControlPoints[n - 1] = mControlPoints[n - 1]->position;
 }
 
-const QVector<QVector2D>& DiffusionCurveRenderer::Spline::GetControlPointPositions()
+std::span<const QVector2D> DiffusionCurveRenderer::Spline::GetControlPointPositions()
 {
     if (mControlPointPositionsDirty)
     {
@@ -313,7 +499,7 @@ const QVector<QVector2D>& DiffusionCurveRenderer::Spline::GetControlPointPositio
         mControlPointPositionsDirty = false;
     }
 
-    return mControlPointPositions;
+    return std::span<const QVector2D>(mControlPointPositions.constData(), mControlPointPositions.size());
 }
 
 DiffusionCurveRenderer::ColorPointPtr DiffusionCurveRenderer::Spline::AddColorPoint(ColorPointType type, const QVector4D& color, float position)
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "Curve/Bezier.h"
+#include "Curve/TridiagonalSolver.h"
 
-#include <Eigen/Dense>
 #include <QVector>
 
 namespace DiffusionCurveRenderer
@@ -16,9 +16,16 @@ namespace DiffusionCurveRenderer
         QVector2D PositionAt(float t) const override;
         QVector2D TangentAt(float t) const override;
         QVector2D NormalAt(float t) const override;
+        float ParameterAt(const QVector2D& point) const override;
+
+        void PositionsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const override;
+        void TangentsAt(std::span<const float> parameters, std::span<float> xs, std::span<float> ys) const override;
 
         void Update() override;
 
+        const BoundingBox& GetBoundingBox() const override;
+        float GetLength() const override;
+
         ControlPointPtr GetControlPoint(int index) override;
         QVector2D GetControlPointPosition(int index) const override;
 
@@ -26,8 +33,7 @@ namespace DiffusionCurveRenderer
         void RemoveControlPoint(ControlPointPtr point) override;
         void RemoveControlPoint(int index) override;
 
-        const QVector<ControlPointPtr>& GetControlPoints() const override { return mControlPoints; }
-        const QVector<QVector2D>& GetControlPointPositions() override;
+        std::span<const QVector2D> GetControlPointPositions() override;
         int GetNumberOfControlPoints() const override { return mControlPoints.size(); }
 
         ColorPointPtr AddColorPoint(ColorPointType type, const QVector4D& color, float position) override;
@@ -39,6 +45,7 @@ namespace DiffusionCurveRenderer
         ColorPointPtr FindColorPointAround(const QVector2D& test, float offset, float tolerance) override;
 
         // Spline
+        const QVector<ControlPointPtr>& GetControlPoints() const { return mControlPoints; }
         const QVector<BezierPtr>& GetBezierPatches() const { return mBezierPatches; };
 
         BezierPtr GetBezierPatchAt(float t) const;
@@ -50,11 +57,16 @@ namespace DiffusionCurveRenderer
         static CurvePtr FromJsonObject(QJsonObject object);
 
       private:
-        Eigen::MatrixXf CreateCoefficientMatrix();
-        QVector<QVector2D> GetSplineControlPoints();
+        void SolveSplineControlPoints();
 
-        void SaveColorPoints();
-        void RestoreColorPoints();
+        // Buckets the parameters by patch and runs "evaluate" once per patch on the local parameters
+        template<typename Evaluate>
+        void EvaluatePatches(std::span<const float> parameters, std::span<float> xs, std::span<float> ys, Evaluate evaluate) const;
+
+        void UpdateAllPatches();
+        void UpdateMovedKnots(int first, int last);
+        void UpdatePatch(int index);
+        void RemovePatchesAt(int knotIndex);
 
       private:
         QVector<ControlPointPtr> mControlPoints;
@@ -65,7 +77,22 @@ namespace DiffusionCurveRenderer
 
         bool mIsPointAddedOrRemoved{ false };
 
-        QVector<ColorPointPtr> mColorsBeforeUpdate;
+        // Union of the boxes of the patches
+        mutable BoundingBox mBoundingBox;
+        mutable bool mBoundingBoxDirty{ true };
+
+        // Knot positions at the last update, used to find the knots that moved
+        QVector<QVector2D> mKnotPositions;
+
+        TridiagonalSolver mSolver;
+        QVector<QVector2D> mSplineControlPoints;
+        QVector<QVector2D> mSplineControlPointDeltas;
+
+        // Local updates are exact up to float precision, a full solve now and then keeps round-off from accumulating
+        int mNumberOfLocalUpdates{ 0 };
+
+        static constexpr int LOCAL_UPDATE_MARGIN = 16;
+        static constexpr int FULL_UPDATE_INTERVAL = 256;
     };
 
     using SplinePtr = std::shared_ptr<Spline>;
@@ -0,0 +1,43 @@
+#include "TridiagonalSolver.h"
+
+#include "Util/Logger.h"
+
+DiffusionCurveRenderer::TridiagonalSolver::TridiagonalSolver(float diagonal)
+    : mDiagonal(diagonal)
+{
+    DCR_ASSERT(diagonal > 2.0f); // Diagonally dominant, no pivoting is needed
+}
+
+void DiffusionCurveRenderer::TridiagonalSolver::Solve(std::span<QVector2D> values)
+{
+    const int n = values.size();
+
+    if (n == 0)
+        return;
+
+    if (mFactors.size() < n)
+        Factorize(n);
+
+    // Forward elimination
+    values[0] *= mFactors[0];
+
+    for (int i = 1; i < n; ++i)
+        values[i] = (values[i] - values[i - 1]) * mFactors[i];
+
+    // Back substitution
+    for (int i = n - 2; i >= 0; --i)
+        values[i] -= mFactors[i] * values[i + 1];
+}
+
+void DiffusionCurveRenderer::TridiagonalSolver::Factorize(int size)
+{
+    int i = mFactors.size();
+
+    mFactors.resize(size);
+
+    if (i == 0)
+        mFactors[i++] = 1.0f / mDiagonal;
+
+    for (; i < size; ++i)
+        mFactors[i] = 1.0f / (mDiagonal - mFactors[i - 1]);
+}
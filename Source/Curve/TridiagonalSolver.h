@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QVector2D>
+#include <QVector>
+#include <span>
+
+namespace DiffusionCurveRenderer
+{
+    // Thomas algorithm for the symmetric tridiagonal system with a constant main diagonal
+    // and ones on the off-diagonals, e.g. the 1-4-1 system of interpolating cubic splines.
+    // The elimination factors only depend on the row index, not on the right side or the size,
+    // so they are computed once, cached, and a solve is a single O(n) sweep without allocations.
+    class TridiagonalSolver
+    {
+      public:
+        explicit TridiagonalSolver(float diagonal = 4.0f);
+
+        // Overwrites the right side "values" with the solution
+        void Solve(std::span<QVector2D> values);
+
+      private:
+        void Factorize(int size);
+
+        float mDiagonal;
+
+        // 1 / (diagonal - factor[i - 1]), also the modified super-diagonal since it is 1
+        QVector<float> mFactors;
+    };
+}
@@ -25,6 +25,7 @@ void DiffusionCurveRenderer::EventHandler::OnKeyPressed(QKeyEvent* event)
             if (mSelectedCurve)
             {
                 mSelectedCurve->RemoveColorPoint(mSelectedColorPoint);
+                mCurveContainer->MarkAsChanged(mSelectedCurve);
                 SetSelectedControlPoint(nullptr);
             }
         }
@@ -33,6 +34,7 @@ void DiffusionCurveRenderer::EventHandler::OnKeyPressed(QKeyEvent* event)
             if (mSelectedCurve)
             {
                 mSelectedCurve->RemoveControlPoint(mSelectedControlPoint);
+                mCurveContainer->UpdateCurve(mSelectedCurve);
                 SetSelectedControlPoint(nullptr);
             }
         }
@@ -88,13 +90,19 @@ void DiffusionCurveRenderer::EventHandler::OnMousePressed(QMouseEvent* event)
                 if (const auto point = mSelectedCurve->TryCreateColorPointAt(CameraToWorld(mMouse.x, mMouse.y)))
                 {
                     if (ColorPointPtr added = mSelectedCurve->AddColorPoint(point->type, point->color, point->position))
+                    {
+                        mCurveContainer->MarkAsChanged(mSelectedCurve);
                         SelectedColorPointChanged(added);
+                    }
                 }
             }
             else
             {
                 if (ControlPointPtr point = mSelectedCurve->AddControlPoint(CameraToWorld(mMouse.x, mMouse.y)))
+                {
+                    mCurveContainer->UpdateCurve(mSelectedCurve);
                     SetSelectedControlPoint(point);
+                }
             }
         }
         else
@@ -130,6 +138,7 @@ void DiffusionCurveRenderer::EventHandler::OnMouseMoved(QMouseEvent* event)
         {
             mSelectedControlPoint->position = CameraToWorld(mMouse.x, mMouse.y);
             mSelectedCurve->Update();
+            mCurveContainer->UpdateCurve(mSelectedCurve);
         }
         else if (mSelectedColorPoint)
         {
@@ -137,6 +146,7 @@ void DiffusionCurveRenderer::EventHandler::OnMouseMoved(QMouseEvent* event)
             const auto colorPoint = mSelectedCurve->AddColorPoint(mSelectedColorPoint->type, mSelectedColorPoint->color, newPosition);
             mSelectedCurve->RemoveColorPoint(mSelectedColorPoint);
             mSelectedCurve->Update();
+            mCurveContainer->MarkAsChanged(mSelectedCurve);
             SetSelectedColorPoint(colorPoint);
         }
     }
@@ -163,14 +173,7 @@ void DiffusionCurveRenderer::EventHandler::OnWheelMoved(QWheelEvent* event)
 
 DiffusionCurveRenderer::CurvePtr DiffusionCurveRenderer::EventHandler::GetCurveAround(float x, float y)
 {
-    CurveQueryInfo info = mRendererManager->Query(QPoint(x, y));
-
-    if (info.result == 1)
-    {
-        return mCurveContainer->GetCurve(info.index);
-    }
-
-    return nullptr;
+    return mCurveContainer->GetCurveAround(CameraToWorld(x, y), CameraDistanceToWorldDistance(CURVE_PICKING_RADIUS_PX));
 }
 
 DiffusionCurveRenderer::ControlPointPtr DiffusionCurveRenderer::EventHandler::GetControlPointAround(float x, float y)
@@ -25,6 +25,7 @@ void DiffusionCurveRenderer::ImGuiWindow::Draw()
     mFrambufferSizeIndex = std::log2(mFrambufferSize / 1024);
 
     ImGui::Begin("Controls", nullptr, ImGuiWindowFlags_MenuBar);
+    mRect = QRectF(ImGui::GetWindowPos().x, ImGui::GetWindowPos().y, ImGui::GetWindowSize().x, ImGui::GetWindowSize().y);
     DrawMenuBar();
     DrawWorkModes();
     if (mWorkMode == WorkMode::Vectorization)
@@ -91,9 +92,19 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawVectorizationViewOptions()
                 ImGui::RadioButton("Spline", &option, 1);
                 mVectorizationCurveType = VectorizationCurveType(option);
 
+                if (mVectorizationCurveType == VectorizationCurveType::Bezier)
+                {
+                    ImGui::Checkbox("Split Into Cubic Patches", &mSplitIntoCubics);
+
+                    ImGui::BeginDisabled(!mSplitIntoCubics);
+                    ImGui::SliderFloat("Tolerance (px)", &mCubicTolerance, 0.1f, 4.0f);
+                    ImGui::EndDisabled();
+                }
+
                 if (ImGui::Button("Vectorize"))
                 {
-                    emit Vectorize(mVectorizationCurveType, mEdgeStackLayer);
+                    const bool splitIntoCubics = mSplitIntoCubics && mVectorizationCurveType == VectorizationCurveType::Bezier;
+                    emit Vectorize(mVectorizationCurveType, mEdgeStackLayer, splitIntoCubics ? mCubicTolerance : 0.0f);
                 }
             }
         }
@@ -120,6 +131,10 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawVectorizationViewOptions()
         {
             ImGui::Text("Status: Constructing Curves...");
         }
+        else if (mVectorizationStage == VectorizationStage::CubicNormalizer)
+        {
+            ImGui::Text("Status: Splitting Into Cubic Patches...");
+        }
         else if (mVectorizationStage == VectorizationStage::ColorSampler)
         {
             ImGui::Text("Status: Sampling Colors...");
@@ -256,11 +271,15 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawCurveHeader()
                 ImGui::Text("Curve Type: B-Spline");
             }
 
-            ImGui::Text("Number of Control Points: %d", mSelectedCurve->GetControlPoints().size());
-            ImGui::SliderFloat("Thickness", &mSelectedCurve->GetContourThickness_NonConst(), 1, 20);
-            ImGui::SliderFloat("Diffusion Width", &mSelectedCurve->GetDiffusionWidth_NonConst(), 0.5f, 4.0f);
-            ImGui::SliderFloat("Diffusion Gap", &mSelectedCurve->GetDiffusionGap_NonConst(), 0.5f, 4.0f);
-            ImGui::ColorEdit4("Contour Color", &mSelectedCurve->GetContourColor_NonConst()[0]);
+            ImGui::Text("Number of Control Points: %d", mSelectedCurve->GetNumberOfControlPoints());
+            bool changed = false;
+            changed |= ImGui::SliderFloat("Thickness", &mSelectedCurve->GetContourThickness_NonConst(), 1, 20);
+            changed |= ImGui::SliderFloat("Diffusion Width", &mSelectedCurve->GetDiffusionWidth_NonConst(), 0.5f, 4.0f);
+            changed |= ImGui::SliderFloat("Diffusion Gap", &mSelectedCurve->GetDiffusionGap_NonConst(), 0.5f, 4.0f);
+            changed |= ImGui::ColorEdit4("Contour Color", &mSelectedCurve->GetContourColor_NonConst()[0]);
+
+            if (changed)
+                mCurveContainer->MarkAsChanged(mSelectedCurve);
 
             if (ImGui::Button("Remove Curve"))
             {
@@ -275,11 +294,15 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawCurveHeader()
         {
             ImGui::Text("Control Point");
             if (ImGui::InputFloat2("Position (x,y)", &mSelectedControlPoint->position[0]))
+            {
                 mSelectedCurve->Update();
+                mCurveContainer->UpdateCurve(mSelectedCurve);
+            }
 
             if (ImGui::Button("Remove Control Point"))
             {
                 mSelectedCurve->RemoveControlPoint(mSelectedControlPoint);
+                mCurveContainer->UpdateCurve(mSelectedCurve);
                 SetSelectedControlPoint(nullptr);
             }
         }
@@ -291,16 +314,22 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawCurveHeader()
             ImGui::Text("Color Point");
 
             ImGui::Text("Direction: %s", mSelectedColorPoint->type == ColorPointType::Left ? "Left" : "Right");
-            ImGui::SliderFloat("Position", &mSelectedColorPoint->position, 0.0f, 1.0f);
+            if (ImGui::SliderFloat("Position", &mSelectedColorPoint->position, 0.0f, 1.0f))
+            {
+                mSelectedCurve->Update();
+                mCurveContainer->MarkAsChanged(mSelectedCurve);
+            }
 
             if (ImGui::ColorEdit4("Color", &mSelectedColorPoint->color[0]))
             {
                 mSelectedCurve->Update();
+                mCurveContainer->MarkAsChanged(mSelectedCurve);
             }
 
             if (ImGui::Button("Remove Color Point"))
             {
                 mSelectedCurve->RemoveColorPoint(mSelectedColorPoint);
+                mCurveContainer->MarkAsChanged(mSelectedCurve);
                 SetSelectedColorPoint(nullptr);
             }
         }
@@ -312,15 +341,102 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawRenderSettings()
 {
     if (ImGui::CollapsingHeader("Render Settings", ImGuiTreeNodeFlags_DefaultOpen))
     {
-        if (ImGui::SliderInt("Smooth Iterations", &mSmoothIterations, 2, 50))
+        bool adaptiveSmoothing = mRendererManager->GetAdaptiveSmoothing();
+
+        // Upper bound of the passes per level in adaptive mode
+        if (ImGui::SliderInt("Smooth Iterations", &mSmoothIterations, 2, adaptiveSmoothing ? 200 : 50))
             mRendererManager->SetSmoothIterations(mSmoothIterations);
 
-        if (ImGui::SliderInt("Frambuffer Size", &mFrambufferSizeIndex, 0, 2, FRAME_BUFFER_SIZES[mFrambufferSizeIndex]))
+        int smoother = static_cast<int>(mRendererManager->GetSmoother());
+        ImGui::Text("Smoother:");
+        ImGui::RadioButton("Jacobi##DiffusionSmoother", &smoother, 0);
+        ImGui::SameLine();
+        ImGui::RadioButton("Red-Black SOR##DiffusionSmoother", &smoother, 1);
+        mRendererManager->SetSmoother(DiffusionSmoother(smoother));
+
+        if (DiffusionSmoother(smoother) == DiffusionSmoother::RedBlackSor)
         {
-            mFrambufferSize = 1024 * std::exp2(mFrambufferSizeIndex);
-            mRendererManager->SetFramebufferSize(mFrambufferSize);
+            float relaxationFactor = mRendererManager->GetRelaxationFactor();
+
+            if (ImGui::SliderFloat("Relaxation Factor", &relaxationFactor, 1.0f, 1.95f))
+                mRendererManager->SetRelaxationFactor(relaxationFactor);
         }
 
+        if (ImGui::Checkbox("Adaptive Smoothing", &adaptiveSmoothing))
+        {
+            mRendererManager->SetAdaptiveSmoothing(adaptiveSmoothing);
+
+            if (!adaptiveSmoothing && 50 < mSmoothIterations)
+            {
+                mSmoothIterations = 50;
+                mRendererManager->SetSmoothIterations(mSmoothIterations);
+            }
+        }
+
+        if (adaptiveSmoothing)
+        {
+            float changeTolerance = mRendererManager->GetChangeTolerance();
+
+            if (ImGui::SliderFloat("Change Tolerance", &changeTolerance, 0.00001f, 0.001f, "%.5f", ImGuiSliderFlags_Logarithmic))
+                mRendererManager->SetChangeTolerance(changeTolerance);
+        }
+
+        bool adaptiveTessellation = mRendererManager->GetAdaptiveTessellation();
+
+        // Segments per patch follow the size and the flatness of the patch on screen instead of NUMBER_OF_INTERVALS
+        if (ImGui::Checkbox("Adaptive Tessellation", &adaptiveTessellation))
+            mRendererManager->SetAdaptiveTessellation(adaptiveTessellation);
+
+        if (adaptiveTessellation)
+        {
+            float tessellationTolerance = mRendererManager->GetTessellationTolerance();
+            int tessellationBudget = mRendererManager->GetTessellationBudget();
+
+            if (ImGui::SliderFloat("Tessellation Tolerance", &tessellationTolerance, 0.05f, 2.0f, "%.2f px", ImGuiSliderFlags_Logarithmic))
+                mRendererManager->SetTessellationTolerance(tessellationTolerance);
+
+            if (ImGui::SliderInt("Segment Budget", &tessellationBudget, 1 << 16, 1 << 24, "%d", ImGuiSliderFlags_Logarithmic))
+                mRendererManager->SetTessellationBudget(tessellationBudget);
+        }
+
+        // Fixed is a square framebuffer, the other modes follow the aspect of the viewport
+        int resolution = static_cast<int>(mRendererManager->GetDiffusionResolution());
+        ImGui::Text("Diffusion resolution:");
+        ImGui::RadioButton("Fixed##DiffusionResolution", &resolution, 0);
+        ImGui::SameLine();
+        ImGui::RadioButton("Viewport##DiffusionResolution", &resolution, 1);
+        ImGui::SameLine();
+        ImGui::RadioButton("Memory Budget##DiffusionResolution", &resolution, 2);
+        mRendererManager->SetDiffusionResolution(DiffusionResolution(resolution));
+
+        if (DiffusionResolution(resolution) == DiffusionResolution::Fixed)
+        {
+            if (ImGui::SliderInt("Frambuffer Size", &mFrambufferSizeIndex, 0, 2, FRAME_BUFFER_SIZES[mFrambufferSizeIndex]))
+            {
+                mFrambufferSize = 1024 * std::exp2(mFrambufferSizeIndex);
+                mRendererManager->SetFramebufferSize(mFrambufferSize);
+            }
+        }
+        else if (DiffusionResolution(resolution) == DiffusionResolution::Viewport)
+        {
+            float resolutionScale = mRendererManager->GetResolutionScale();
+
+            if (ImGui::SliderFloat("Resolution Scale", &resolutionScale, 0.25f, 2.0f, "%.2f"))
+                mRendererManager->SetResolutionScale(resolutionScale);
+        }
+        else
+        {
+            int memoryBudget = mRendererManager->GetDiffusionMemoryBudget();
+
+            if (ImGui::SliderInt("Memory Budget", &memoryBudget, 16, 2048, "%d MiB", ImGuiSliderFlags_Logarithmic))
+                mRendererManager->SetDiffusionMemoryBudget(memoryBudget);
+        }
+
+        int minimumLevelSize = mRendererManager->GetMinimumLevelSize();
+
+        if (ImGui::SliderInt("Minimum Level Size", &minimumLevelSize, 4, 64))
+            mRendererManager->SetMinimumLevelSize(minimumLevelSize);
+
         if (ImGui::SliderFloat("Global Thickness", &mGlobalContourThickness, 1.0f, 20.0f))
             mCurveContainer->SetGlobalContourThickness(mGlobalContourThickness);
 
@@ -333,6 +449,50 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawRenderSettings()
         if (ImGui::Checkbox("Use Multisample Framebuffer", &mUseMultisampleFramebuffer))
             emit UseMultisampleFramebufferChanged(mUseMultisampleFramebuffer);
 
+        // Frames are otherwise only rendered after inputs, continuous rendering keeps the stats up to date
+        if (ImGui::Checkbox("Render Continuously", &mContinuousRendering))
+            emit ContinuousRenderingChanged(mContinuousRendering);
+
+        int backend = static_cast<int>(mRendererManager->GetDiffusionBackend());
+        ImGui::Text("Diffusion backend:");
+        ImGui::RadioButton("GPU##DiffusionBackend", &backend, 0);
+        ImGui::SameLine();
+        ImGui::RadioButton("CPU##DiffusionBackend", &backend, 1);
+        mRendererManager->SetDiffusionBackend(DiffusionBackend(backend));
+
+        if (DiffusionBackend(backend) == DiffusionBackend::Cpu)
+        {
+            // Direct solver keeps its factorization while the geometry does not change
+            int solver = static_cast<int>(mRendererManager->GetCpuDiffusionSolver());
+            ImGui::RadioButton("Multigrid##DiffusionSolver", &solver, 0);
+            ImGui::SameLine();
+            ImGui::RadioButton("Direct##DiffusionSolver", &solver, 1);
+            mRendererManager->SetCpuDiffusionSolver(DiffusionSolver(solver));
+
+            // Levels finer than the direct solve are smoothed, none if the finest level fits
+            if (DiffusionSolver(solver) == DiffusionSolver::Direct)
+            {
+                int directSolveSize = mRendererManager->GetDirectSolveSize();
+
+                if (ImGui::SliderInt("Direct Solve Size", &directSolveSize, 64, 2048, "%d px", ImGuiSliderFlags_Logarithmic))
+                    mRendererManager->SetDirectSolveSize(directSolveSize);
+            }
+        }
+        else
+        {
+            // Compute passes smooth up to several iterations per dispatch in shared memory
+            int passes = static_cast<int>(mRendererManager->GetDiffusionPasses());
+            ImGui::RadioButton("Fragment##DiffusionPasses", &passes, 0);
+            ImGui::SameLine();
+            ImGui::RadioButton("Compute##DiffusionPasses", &passes, 1);
+            mRendererManager->SetDiffusionPasses(DiffusionPasses(passes));
+
+            // Edits only smooth the previous result around the changed curves until they stop
+            bool warmStart = mRendererManager->GetWarmStart();
+            if (ImGui::Checkbox("Warm Start Edits", &warmStart))
+                mRendererManager->SetWarmStart(warmStart);
+        }
+
         if (ImGui::Button("Clear Canvas"))
         {
             emit ClearCanvas();
@@ -347,7 +507,29 @@ void DiffusionCurveRenderer::ImGuiWindow::DrawStats()
         for (const auto& ID : ALL_CHORONOMETER_IDs)
             ImGui::Text(Chronometer::Print(ID).c_str());
 
+        // Passes and changes of the pyramid levels
+        for (const auto& prefix : { UPSAMPLE_RENDERER_LEVEL, CPU_DIFFUSION_RENDERER_LEVEL })
+            for (const auto& name : Chronometer::QueryNames(prefix))
+                ImGui::Text(Chronometer::Print(name).c_str());
+
         ImGui::Text("# of curves: %zu", mCurveContainer->GetTotalNumberOfCurves());
+
+        // Contour and selection passes draw one strip per patch, the color pass draws two
+        const int patches = mRendererManager->GetNumberOfPatches();
+        const int samples = mRendererManager->GetNumberOfTessellationSamples();
+        ImGui::Text("# of patches: %d, segments: %d", patches, samples - patches);
+        ImGui::Text("# of vertices: %d contour, %d color", 2 * samples, 4 * samples);
+        const Pyramid& pyramid = mRendererManager->GetDiffusionPyramid();
+        ImGui::Text("Diffusion pyramid: %dx%d, %d levels, %.1f MiB",
+                    pyramid.GetSize().width(),
+                    pyramid.GetSize().height(),
+                    int(pyramid.levels.size()),
+                    mRendererManager->GetDiffusionMemoryUsage() / double(1 << 20));
+        ImGui::Text("Framebuffer pool: %d framebuffers, %.1f MiB in use, %.1f MiB idle",
+                    mRendererManager->GetNumberOfPooledFramebuffers(),
+                    mRendererManager->GetAcquiredFramebufferBytes() / double(1 << 20),
+                    mRendererManager->GetIdleFramebufferBytes() / double(1 << 20));
+        ImGui::Text("# of patches drawn: %d, culled: %d", mRendererManager->GetNumberOfDrawnPatches(), mRendererManager->GetNumberOfCulledPatches());
         ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
     }
 }
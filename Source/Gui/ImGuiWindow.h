@@ -5,6 +5,7 @@
 #include "Util/Macros.h"
 
 #include <QObject>
+#include <QRectF>
 #include <QVariant>
 
 namespace DiffusionCurveRenderer
@@ -20,6 +21,9 @@ namespace DiffusionCurveRenderer
 
         void Draw();
 
+        // Whether "position", in logical pixels, is over the controls as of the last frame
+        bool Contains(const QPointF& position) const { return mRect.contains(position); }
+
         void SetSelectedCurve(CurvePtr selectedCurve);
         void SetSelectedControlPoint(ControlPointPtr point);
         void SetSelectedColorPoint(ColorPointPtr point);
@@ -41,6 +45,7 @@ namespace DiffusionCurveRenderer
 
         void RenderModesChanged(RenderModes modes);
         void UseMultisampleFramebufferChanged(bool val);
+        void ContinuousRenderingChanged(bool val);
 
         void ImportXml(const QString& path);
         void SaveAsPng(const QString& path);
@@ -53,7 +58,7 @@ namespace DiffusionCurveRenderer
         void GaussianStackLayerChanged(int layer);
         void EdgeStackLayerChanged(int layer);
         void LoadImage(const QString& path);
-        void Vectorize(VectorizationCurveType curveType, int edgeLevel);
+        void Vectorize(VectorizationCurveType curveType, int edgeLevel, float cubicTolerance);
         void ShowColorPointHandlesChanged(bool value);
 
       private:
@@ -68,6 +73,8 @@ namespace DiffusionCurveRenderer
         void DrawStats();
         void SetGaussianStackLayer(int layer);
 
+        QRectF mRect;
+
         CurvePtr mSelectedCurve{ nullptr };
         ControlPointPtr mSelectedControlPoint{ nullptr };
         ColorPointPtr mSelectedColorPoint{ nullptr };
@@ -80,6 +87,7 @@ namespace DiffusionCurveRenderer
         int mFrambufferSize;
         int mFrambufferSizeIndex;
         bool mUseMultisampleFramebuffer{ false };
+        bool mContinuousRendering{ false };
 
         WorkMode mWorkMode{ WorkMode::CurveEditing };
         VectorizationStage mVectorizationStage{ VectorizationStage::Initial };
@@ -95,6 +103,8 @@ namespace DiffusionCurveRenderer
         bool mShowColorPointHandles{ true };
 
         VectorizationCurveType mVectorizationCurveType{ VectorizationCurveType::Bezier };
+        bool mSplitIntoCubics{ false };
+        float mCubicTolerance{ 0.5f }; // Pixels
 
         DEFINE_MEMBER(float, VectorizationProgress, 0.0f); // [0,1]
         DEFINE_MEMBER(int, MaximumGaussianStackLayer, 10);
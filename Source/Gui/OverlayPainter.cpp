@@ -1,6 +1,7 @@
 #include "OverlayPainter.h"
 
 #include <QOpenGLPaintDevice>
+#include <QVarLengthArray>
 #include <cmath>
 
 DiffusionCurveRenderer::OverlayPainter::OverlayPainter(QObject* parent)
@@ -43,12 +44,12 @@ void DiffusionCurveRenderer::OverlayPainter::DrawControlPolygon()
     painter.setPen(mDashedPen);
     painter.setBrush(QBrush());
 
-    const auto& points = mSelectedCurve->GetControlPoints();
+    const auto points = mSelectedCurve->GetControlPointPositions();
 
-    for (int i = 0; i < points.size() - 1; ++i)
+    for (int i = 0; i < int(points.size()) - 1; ++i)
     {
-        QPointF p0 = WorldToCamera(points[i]->position);
-        QPointF p1 = WorldToCamera(points[i + 1]->position);
+        QPointF p0 = WorldToCamera(points[i]);
+        QPointF p1 = WorldToCamera(points[i + 1]);
         painter.drawLine(p0, p1);
     }
 }
@@ -76,26 +77,46 @@ void DiffusionCurveRenderer::OverlayPainter::PaintColorPointsHandles(BezierPtr b
     painter.setRenderHint(QPainter::Antialiasing, true);
 
     const auto& colorPoints = bezier->GetColorPoints();
+    const int numberOfColorPoints = colorPoints.Size();
 
-    for (const auto colorPoint : colorPoints)
+    QVarLengthArray<float, 16> parameters(numberOfColorPoints);
+    QVarLengthArray<float, 16> xs(numberOfColorPoints);
+    QVarLengthArray<float, 16> ys(numberOfColorPoints);
+    QVarLengthArray<float, 16> normalXs(numberOfColorPoints);
+    QVarLengthArray<float, 16> normalYs(numberOfColorPoints);
+
+    for (int i = 0; i < numberOfColorPoints; ++i)
+        parameters[i] = colorPoints[i].position;
+
+    bezier->PositionsAt(parameters, xs, ys);
+    bezier->NormalsAt(parameters, normalXs, normalYs);
+
+    const float handleOffset = mCamera->CameraDistanceToWorldDistance(HANDLE_OFFSET);
+
+    for (int i = 0; i < numberOfColorPoints; ++i)
     {
-        QPointF offset = GetColorPointHandlePosition(bezier, colorPoint, true);
-        QPointF inset = GetColorPointHandlePosition(bezier, colorPoint, false);
+        const auto& colorPoint = colorPoints[i];
+        const QVector2D position(xs[i], ys[i]);
+        const QVector2D normal(normalXs[i], normalYs[i]);
+        const float side = colorPoint.type == ColorPointType::Left ? handleOffset : -handleOffset;
+
+        QPointF offset = WorldToCamera(position + side * normal);
+        QPointF inset = WorldToCamera(position);
 
         // Draw a dashed line actual position to visual position
         painter.setPen(mDenseDashedPen);
         painter.drawLine(inset, offset);
 
         // Outer disk
-        float scaling = colorPoint == mColorPointAround ? 1.5 : 1.0f;
+        float scaling = &colorPoint == mColorPointAround.get() ? 1.5 : 1.0f;
         FillOuterDisk(painter, offset, scaling);
 
         // Inner disk
         FillInnerDisk(painter, offset, 1.0f,
-                      QColor(255 * colorPoint->color.x(),
-                             255 * colorPoint->color.y(),
-                             255 * colorPoint->color.z(),
-                             255 * colorPoint->color.w()));
+                      QColor(255 * colorPoint.color.x(),
+                             255 * colorPoint.color.y(),
+                             255 * colorPoint.color.z(),
+                             255 * colorPoint.color.w()));
     }
 }
 
@@ -117,9 +138,9 @@ void DiffusionCurveRenderer::OverlayPainter::FillInnerDisk(QPainter& painter, QP
 
 void DiffusionCurveRenderer::OverlayPainter::PaintControlPointsHandles()
 {
-    const auto& points = mSelectedCurve->GetControlPoints();
+    const int numberOfPoints = mSelectedCurve->GetNumberOfControlPoints();
 
-    if (points.empty())
+    if (numberOfPoints == 0)
         return;
 
     QPainter painter(mDevice);
@@ -128,17 +149,17 @@ void DiffusionCurveRenderer::OverlayPainter::PaintControlPointsHandles()
     QPointF center;
 
     // Last control point
-    center = WorldToCamera(points.last()->position);
+    center = WorldToCamera(mSelectedCurve->GetControlPointPosition(numberOfPoints - 1));
     FillOuterDisk(painter, center, 1.0f);
     FillInnerDisk(painter, center, 1.0f, QColor(0, 255, 0));
 
     // Other control points
-    for (int i = 0; i < points.size() - 1; ++i)
+    for (int i = 0; i < numberOfPoints - 1; ++i)
     {
-        if (mControlPointAround == points[i])
+        if (mControlPointAround == mSelectedCurve->GetControlPoint(i))
             continue;
 
-        center = WorldToCamera(points[i]->position);
+        center = WorldToCamera(mSelectedCurve->GetControlPointPosition(i));
         FillOuterDisk(painter, center, 1.0f);
         FillInnerDisk(painter, center, 1.0f);
     }
@@ -168,7 +189,7 @@ void DiffusionCurveRenderer::OverlayPainter::PaintControlPointsHandles()
     {
         center = WorldToCamera(mControlPointAround->position);
 
-        if (mControlPointAround == points.last())
+        if (mControlPointAround == mSelectedCurve->GetControlPoint(numberOfPoints - 1))
         {
             FillOuterDisk(painter, center, 1.5f);
             FillInnerDisk(painter, center, 1.5f, QColor(0, 255, 0));
@@ -190,12 +211,3 @@ QPointF DiffusionCurveRenderer::OverlayPainter::WorldToCamera(const QVector2D& w
 {
     return mCamera->WorldToCamera(world.toPointF());
 }
-
-QPointF DiffusionCurveRenderer::OverlayPainter::GetColorPointHandlePosition(CurvePtr curve, ColorPointPtr colorPoint, bool useOffset)
-{
-    float position = colorPoint->position;
-    float offset = colorPoint->type == ColorPointType::Left ? HANDLE_OFFSET : -HANDLE_OFFSET;
-    offset = mCamera->CameraDistanceToWorldDistance(offset);
-    QVector2D worldPosition = curve->PositionAt(position) + useOffset * offset * curve->NormalAt(position);
-    return WorldToCamera(worldPosition);
-}
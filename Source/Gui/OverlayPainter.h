@@ -33,7 +33,6 @@ namespace DiffusionCurveRenderer
         float GetZoomMultiplier() const;
 
         QPointF WorldToCamera(const QVector2D& world);
-        QPointF GetColorPointHandlePosition(CurvePtr curve, ColorPointPtr colorPoint, bool useOffset);
 
         QPen mDashedPen;
         QPen mDenseDashedPen;
@@ -0,0 +1,108 @@
+#include "FramebufferPool.h"
+
+#include "Util/Logger.h"
+
+#include <algorithm>
+
+DiffusionCurveRenderer::FramebufferPool::~FramebufferPool()
+{
+    for (const auto& entry : mEntries)
+        delete entry.framebuffer;
+}
+
+QOpenGLFramebufferObject* DiffusionCurveRenderer::FramebufferPool::Acquire(const QSize& size, const QOpenGLFramebufferObjectFormat& format)
+{
+    for (auto& entry : mEntries)
+    {
+        if (!entry.acquired && entry.framebuffer->size() == size && entry.format == format)
+        {
+            entry.acquired = true;
+            entry.used = true;
+            return entry.framebuffer;
+        }
+    }
+
+    Entry entry;
+    entry.framebuffer = new QOpenGLFramebufferObject(size, format);
+    entry.format = format;
+    entry.bytes = EstimateBytes(size, format);
+    entry.acquired = true;
+    mEntries << entry;
+
+    return entry.framebuffer;
+}
+
+void DiffusionCurveRenderer::FramebufferPool::Release(QOpenGLFramebufferObject* framebuffer)
+{
+    if (framebuffer == nullptr)
+        return;
+
+    const auto entry = std::find_if(mEntries.begin(), mEntries.end(), [=](const Entry& entry) { return entry.framebuffer == framebuffer; });
+
+    DCR_ASSERT(entry != mEntries.end() && entry->acquired);
+
+    entry->acquired = false;
+}
+
+void DiffusionCurveRenderer::FramebufferPool::TrimUnused()
+{
+    const auto unused = [](const Entry& entry) { return !entry.acquired && !entry.used; };
+
+    for (const auto& entry : mEntries)
+        if (unused(entry))
+            delete entry.framebuffer;
+
+    mEntries.removeIf(unused);
+
+    for (auto& entry : mEntries)
+        entry.used = entry.acquired;
+}
+
+quint64 DiffusionCurveRenderer::FramebufferPool::GetAcquiredBytes() const
+{
+    quint64 bytes = 0;
+
+    for (const auto& entry : mEntries)
+        if (entry.acquired)
+            bytes += entry.bytes;
+
+    return bytes;
+}
+
+quint64 DiffusionCurveRenderer::FramebufferPool::GetIdleBytes() const
+{
+    quint64 bytes = 0;
+
+    for (const auto& entry : mEntries)
+        if (!entry.acquired)
+            bytes += entry.bytes;
+
+    return bytes;
+}
+
+quint64 DiffusionCurveRenderer::FramebufferPool::EstimateBytes(const QSize& size, const QOpenGLFramebufferObjectFormat& format)
+{
+    quint64 bytesPerTexel;
+
+    switch (format.internalTextureFormat())
+    {
+        case GL_RGBA16F:
+        case GL_RG32F:
+            bytesPerTexel = 8;
+            break;
+        case GL_RGBA32F:
+            bytesPerTexel = 16;
+            break;
+        default: // GL_RGBA8, GL_R32F
+            bytesPerTexel = 4;
+            break;
+    }
+
+    quint64 bytes = quint64(size.width()) * size.height() * bytesPerTexel * std::max(format.samples(), 1);
+
+    // A full mip chain is a third of the base level
+    if (format.mipmap())
+        bytes += bytes / 3;
+
+    return bytes;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QOpenGLFramebufferObject>
+#include <QSize>
+#include <QVector>
+
+namespace DiffusionCurveRenderer
+{
+    // Framebuffers shared by the passes, keyed by size and format. Passes acquire their targets and release
+    // them once the contents are no longer needed, a later acquire with the same size and format gets the
+    // released framebuffer instead of a new allocation. Contents of an acquired framebuffer are undefined.
+    // Pyramid textures are acquired for as long as the pyramid is set, their contents are the result and
+    // the start of the warm start, so the byte counts cover all diffusion targets. Framebuffers with
+    // different sizes or formats never share memory, a size switch reuses them if it switches back before
+    // they are trimmed.
+    class FramebufferPool
+    {
+      public:
+        FramebufferPool() = default;
+        ~FramebufferPool();
+
+        QOpenGLFramebufferObject* Acquire(const QSize& size, const QOpenGLFramebufferObjectFormat& format);
+        void Release(QOpenGLFramebufferObject* framebuffer);
+
+        // Deletes the framebuffers that are neither acquired nor were acquired since the last call. Called once
+        // per solve, this keeps the framebuffers of the current settings and frees those of previous ones.
+        void TrimUnused();
+
+        int GetNumberOfFramebuffers() const { return mEntries.size(); }
+        quint64 GetAcquiredBytes() const;
+        quint64 GetIdleBytes() const;
+
+      private:
+        struct Entry
+        {
+            QOpenGLFramebufferObject* framebuffer{ nullptr };
+            QOpenGLFramebufferObjectFormat format;
+            quint64 bytes{ 0 };
+            bool acquired{ false };
+            bool used{ true }; // Acquired since the last call to TrimUnused
+        };
+
+        static quint64 EstimateBytes(const QSize& size, const QOpenGLFramebufferObjectFormat& format);
+
+        QVector<Entry> mEntries;
+    };
+}
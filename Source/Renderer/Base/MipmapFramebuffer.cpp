@@ -0,0 +1,117 @@
+#include "MipmapFramebuffer.h"
+
+#include "Util/Logger.h"
+
+DiffusionCurveRenderer::MipmapFramebuffer::MipmapFramebuffer(int numberOfTextures)
+{
+    initializeOpenGLFunctions();
+
+    glCreateFramebuffers(1, &mFramebuffer);
+
+    mPooledFramebuffers.resize(numberOfTextures);
+    mTextures.resize(numberOfTextures);
+
+    mFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+    mFormat.setSamples(0);
+    mFormat.setMipmap(true);
+    mFormat.setTextureTarget(GL_TEXTURE_2D);
+    mFormat.setInternalTextureFormat(GL_RGBA8);
+}
+
+DiffusionCurveRenderer::MipmapFramebuffer::~MipmapFramebuffer()
+{
+    ReleaseTextures();
+    glDeleteFramebuffers(1, &mFramebuffer);
+}
+
+void DiffusionCurveRenderer::MipmapFramebuffer::SetPyramid(const Pyramid& pyramid)
+{
+    ReleaseTextures();
+
+    mPyramid = pyramid;
+
+    if (mPyramid.IsEmpty())
+        return;
+
+    const QSize size = mPyramid.GetSize();
+
+    // Every level of the pyramid is exactly half of the previous one like the mip chain, which goes on to 1x1.
+    // Textures of a previous pyramid of the same size are reused.
+    for (int i = 0; i < mTextures.size(); ++i)
+    {
+        mPooledFramebuffers[i] = mFramebufferPool->Acquire(size, mFormat);
+        mTextures[i] = mPooledFramebuffers[i]->texture();
+
+        const GLuint texture = mTextures[i];
+        glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+}
+
+void DiffusionCurveRenderer::MipmapFramebuffer::Bind(int texture, int level)
+{
+    if (mAttachedTexture != texture || mAttachedLevel != level)
+    {
+        glNamedFramebufferTexture(mFramebuffer, GL_COLOR_ATTACHMENT0, mTextures[texture], level);
+        mAttachedTexture = texture;
+        mAttachedLevel = level;
+
+        DCR_ASSERT(glCheckNamedFramebufferStatus(mFramebuffer, GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+    }
+
+    const QSize size = GetSize(level);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+    glViewport(0, 0, size.width(), size.height());
+}
+
+void DiffusionCurveRenderer::MipmapFramebuffer::Release()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DiffusionCurveRenderer::MipmapFramebuffer::Copy(const MipmapFramebuffer& source, int sourceTexture, int texture, int level)
+{
+    Copy(source, sourceTexture, texture, level, QRect(QPoint(0, 0), GetSize(level)));
+}
+
+void DiffusionCurveRenderer::MipmapFramebuffer::Copy(const MipmapFramebuffer& source, int sourceTexture, int texture, int level, const QRect& region)
+{
+    DCR_ASSERT(source.GetSize(level) == GetSize(level));
+
+    if (region.isEmpty())
+        return;
+
+    DCR_ASSERT(QRect(QPoint(0, 0), GetSize(level)).contains(region));
+
+    glCopyImageSubData(source.GetTexture(sourceTexture), GL_TEXTURE_2D, level, region.x(), region.y(), 0, mTextures[texture], GL_TEXTURE_2D, level, region.x(), region.y(), 0, region.width(), region.height(), 1);
+}
+
+QImage DiffusionCurveRenderer::MipmapFramebuffer::ToImage(int texture, int level)
+{
+    QImage image(GetSize(level), QImage::Format_RGBA8888_Premultiplied);
+
+    glGetTextureImage(mTextures[texture], level, GL_RGBA, GL_UNSIGNED_BYTE, image.sizeInBytes(), image.bits());
+
+    return image;
+}
+
+void DiffusionCurveRenderer::MipmapFramebuffer::ReleaseTextures()
+{
+    // The texture may be acquired by another framebuffer, it must not stay attached
+    if (mAttachedTexture != -1)
+        glNamedFramebufferTexture(mFramebuffer, GL_COLOR_ATTACHMENT0, 0, 0);
+
+    for (auto& framebuffer : mPooledFramebuffers)
+    {
+        mFramebufferPool->Release(framebuffer);
+        framebuffer = nullptr;
+    }
+
+    mTextures.fill(0);
+
+    mAttachedTexture = -1;
+    mAttachedLevel = -1;
+}
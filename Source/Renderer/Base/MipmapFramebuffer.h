@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Renderer/Base/FramebufferPool.h"
+#include "Structs/Pyramid.h"
+#include "Util/Macros.h"
+
+#include <QImage>
+#include <QOpenGLFunctions_4_5_Core>
+#include <QRect>
+#include <QVector>
+
+namespace DiffusionCurveRenderer
+{
+    // RGBA8 textures whose mip chains hold the levels of a pyramid, rendered to through a single framebuffer
+    // by attaching the level of each pass. Shaders read the levels with texelFetch. Filtering is nearest
+    // without mipmaps, so a pass may read the other levels of the texture it renders to unless it renders
+    // to level 0, the base level. The textures are those of framebuffers acquired from the pool while the
+    // pyramid is set.
+    class MipmapFramebuffer : protected QOpenGLFunctions_4_5_Core
+    {
+      public:
+        explicit MipmapFramebuffer(int numberOfTextures);
+        ~MipmapFramebuffer();
+
+        // Releases the textures and acquires textures with a mip chain covering "pyramid", contents are undefined afterwards
+        void SetPyramid(const Pyramid& pyramid);
+
+        // Binds the framebuffer with "level" of "texture" attached and sets the viewport to the size of the level
+        void Bind(int texture, int level);
+        void Release();
+
+        // Copies "level" of "sourceTexture" of "source" into the same level of "texture"
+        void Copy(const MipmapFramebuffer& source, int sourceTexture, int texture, int level);
+
+        // Same for "region" of the level, in texels
+        void Copy(const MipmapFramebuffer& source, int sourceTexture, int texture, int level, const QRect& region);
+
+        // Raw RGBA8 of "level" of "texture", rows are bottom to top
+        QImage ToImage(int texture, int level);
+
+        GLuint GetHandle() const { return mFramebuffer; }
+        GLuint GetTexture(int texture) const { return mTextures[texture]; }
+        QSize GetSize(int level) const { return mPyramid.levels[level]; }
+        int GetNumberOfLevels() const { return mPyramid.levels.size(); }
+
+      private:
+        void ReleaseTextures();
+
+        GLuint mFramebuffer{ 0 };
+        QVector<QOpenGLFramebufferObject*> mPooledFramebuffers;
+        QVector<GLuint> mTextures;
+        QOpenGLFramebufferObjectFormat mFormat;
+        Pyramid mPyramid;
+
+        // Attachment of the framebuffer, only changed if a pass renders to another level
+        int mAttachedTexture{ -1 };
+        int mAttachedLevel{ -1 };
+
+        DEFINE_MEMBER_PTR(FramebufferPool, FramebufferPool);
+    };
+}
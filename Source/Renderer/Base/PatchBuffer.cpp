@@ -0,0 +1,601 @@
+#include "PatchBuffer.h"
+
+#include "Util/Chronometer.h"
+#include "Util/Logger.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+DiffusionCurveRenderer::PatchBuffer::PatchBuffer()
+{
+    initializeOpenGLFunctions();
+
+    glGenBuffers(1, &mPatchBuffer.buffer);
+    glGenBuffers(1, &mControlPointBuffer.buffer);
+    glGenBuffers(1, &mColorBuffer.buffer);
+    glGenBuffers(1, &mColorPositionBuffer.buffer);
+    glGenBuffers(1, &mSampleBuffer.buffer);
+    glGenBuffers(1, &mDrawCommandBuffer.buffer);
+    glGenBuffers(1, &mVisibleCommandBuffer.buffer);
+    glGenVertexArrays(1, &mVertexArray);
+
+    mFirstPatches.append(0);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Update()
+{
+    const int zoomLevel = mAdaptiveTessellation ? int(std::floor(std::log2(mCamera->GetZoom()))) : 0;
+
+    const bool settingsChanged = mPackedSettingsRevision != mSettingsRevision || mZoomLevel != zoomLevel;
+
+    if (mRevision == mCurveContainer->GetRevision() && !settingsChanged)
+        return;
+
+    MEASURE_CALL_TIME(PATCH_BUFFER);
+
+    const bool repacked = !settingsChanged && Repack();
+
+    mRevision = mCurveContainer->GetRevision();
+    mPackedSettingsRevision = mSettingsRevision;
+    mZoomLevel = zoomLevel;
+
+    if (repacked)
+        return;
+
+    Pack();
+
+    Upload(mPatchBuffer, mPatches, mUploadedPatches);
+    Upload(mControlPointBuffer, mControlPoints, mUploadedControlPoints);
+    Upload(mColorBuffer, mColors, mUploadedColors);
+    Upload(mColorPositionBuffer, mColorPositions, mUploadedColorPositions);
+    Upload(mDrawCommandBuffer, mDrawCommands, mUploadedDrawCommands);
+    Upload(mSampleBuffer, mSamples, mDirtySamples.first, mDirtySamples.last);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Bind()
+{
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PATCHES_BINDING, mPatchBuffer.buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CONTROL_POINTS_BINDING, mControlPointBuffer.buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COLORS_BINDING, mColorBuffer.buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COLOR_POSITIONS_BINDING, mColorPositionBuffer.buffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SAMPLES_BINDING, mSampleBuffer.buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mDrawCommandBuffer.buffer);
+    glBindVertexArray(mVertexArray);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Release()
+{
+    glBindVertexArray(0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+    for (GLuint binding = PATCHES_BINDING; binding <= SAMPLES_BINDING; ++binding)
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, 0);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Render(const View& view, int firstPatch, int numberOfPatches, int stripsPerPatch)
+{
+    DCR_ASSERT(1 <= stripsPerPatch && stripsPerPatch <= MAX_STRIPS_PER_PATCH);
+
+    if (numberOfPatches <= 0)
+        return;
+
+    const qsizetype firstCommand = (stripsPerPatch - 1) * mPatches.size() + firstPatch;
+
+    mVisibleCommands.clear();
+
+    for (int index = firstPatch; index < firstPatch + numberOfPatches; ++index)
+    {
+        const float extent = GetExtent(mPatches[index], view.extent) + view.padding;
+
+        if (mBounds[index].Padded(extent).Intersects(view.region))
+            mVisibleCommands.append(mDrawCommands[firstCommand + index - firstPatch]);
+    }
+
+    mNumberOfDrawnPatches += mVisibleCommands.size();
+    mNumberOfCulledPatches += numberOfPatches - mVisibleCommands.size();
+
+    if (mVisibleCommands.isEmpty())
+        return;
+
+    // Nothing culled, the commands are already on the GPU
+    if (mVisibleCommands.size() == numberOfPatches)
+    {
+        glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, reinterpret_cast<const void*>(firstCommand * sizeof(DrawCommand)), numberOfPatches, 0);
+        return;
+    }
+
+    Upload(mVisibleCommandBuffer, mVisibleCommands, mUploadedVisibleCommands);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mVisibleCommandBuffer.buffer);
+    glMultiDrawArraysIndirect(GL_TRIANGLE_STRIP, nullptr, mVisibleCommands.size(), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mDrawCommandBuffer.buffer);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Render(const View& view, int stripsPerPatch)
+{
+    Render(view, 0, mPatches.size(), stripsPerPatch);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::ResetStatistics()
+{
+    mNumberOfDrawnPatches = 0;
+    mNumberOfCulledPatches = 0;
+}
+
+float DiffusionCurveRenderer::PatchBuffer::GetExtent(const Patch& patch, PatchExtent extent) const
+{
+    switch (extent)
+    {
+        case PatchExtent::Contour:
+            return 0.5f * patch.contourThickness;
+        case PatchExtent::Diffusion:
+            return 0.5f * patch.diffusionGap + patch.diffusionWidth;
+        default:
+            return 0.0f;
+    }
+}
+
+void DiffusionCurveRenderer::PatchBuffer::SetAdaptiveTessellation(bool adaptiveTessellation)
+{
+    if (mAdaptiveTessellation == adaptiveTessellation)
+        return;
+
+    mAdaptiveTessellation = adaptiveTessellation;
+    ++mSettingsRevision;
+}
+
+void DiffusionCurveRenderer::PatchBuffer::SetTessellationTolerance(float tessellationTolerance)
+{
+    if (mTessellationTolerance == tessellationTolerance)
+        return;
+
+    mTessellationTolerance = tessellationTolerance;
+    ++mSettingsRevision;
+}
+
+void DiffusionCurveRenderer::PatchBuffer::SetTessellationBudget(int tessellationBudget)
+{
+    if (mTessellationBudget == tessellationBudget)
+        return;
+
+    mTessellationBudget = tessellationBudget;
+    ++mSettingsRevision;
+}
+
+template<typename Function>
+void DiffusionCurveRenderer::PatchBuffer::ForEachPatch(Function function)
+{
+    const auto& curves = mCurveContainer->GetCurves();
+
+    for (int index = 0; index < curves.size(); ++index)
+        ForEachPatch(curves[index], index, function);
+}
+
+template<typename Function>
+void DiffusionCurveRenderer::PatchBuffer::ForEachPatch(const CurvePtr& curve, int curveIndex, Function function)
+{
+    if (const auto bezier = std::dynamic_pointer_cast<Bezier>(curve))
+    {
+        function(bezier, curve, curveIndex, 0);
+    }
+    else if (const auto spline = std::dynamic_pointer_cast<Spline>(curve))
+    {
+        for (const auto& patch : spline->GetBezierPatches())
+            function(patch, curve, curveIndex, 1);
+    }
+    else
+    {
+        DCR_EXIT_FAILURE("PatchBuffer::ForEachPatch: Undefined curve type. Implement this branch!");
+    }
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Pack()
+{
+    std::swap(mSamples, mPreviousSamples);
+    mPreviousSources.clear();
+
+    for (int index = 0; index < mSources.size(); ++index)
+        mPreviousSources.insert(mSources[index], index);
+
+    mPatches.clear();
+    mControlPoints.clear();
+    mColors.clear();
+    mColorPositions.clear();
+    mFirstPatches.clear();
+    mBounds.clear();
+    mDrawCommands.clear();
+    mSamples.clear();
+    mSources.clear();
+    mCurveIndices.clear();
+
+    mDirtySamples = Range();
+
+    ChooseSegments();
+
+    ForEachPatch([this](BezierPtr bezier, CurvePtr curve, int curveIndex, int curveType) {
+        while (mFirstPatches.size() <= curveIndex)
+            mFirstPatches.append(mPatches.size());
+
+        AddPatch(bezier, curve, curveIndex, curveType);
+        mCurveIndices.insert(curve.get(), curveIndex);
+    });
+
+    while (mFirstPatches.size() <= mCurveContainer->GetTotalNumberOfCurves())
+        mFirstPatches.append(mPatches.size());
+
+    // Same commands again with one instance per side
+    for (int index = 0; index < mPatches.size(); ++index)
+    {
+        DrawCommand command = mDrawCommands[index];
+        command.instanceCount = 2;
+        mDrawCommands.append(command);
+    }
+
+    mPreviousSamples.clear();
+}
+
+bool DiffusionCurveRenderer::PatchBuffer::Repack()
+{
+    if (!mCurveContainer->GetChangedCurves(mRevision, mChangedCurves))
+        return false;
+
+    const auto& curves = mCurveContainer->GetCurves();
+
+    // Indices of the curves stay the same as long as none is added or removed
+    if (mFirstPatches.size() != curves.size() + 1)
+        return false;
+
+    for (const auto& curve : mChangedCurves)
+    {
+        const int index = mCurveIndices.value(curve.get(), -1);
+
+        if (index < 0 || curves[index] != curve)
+            return false;
+
+        int patch = mFirstPatches[index];
+        bool sameLayout = true;
+
+        ForEachPatch(curve, index, [&](BezierPtr bezier, CurvePtr, int, int) {
+            sameLayout = sameLayout && patch < mFirstPatches[index + 1] && HasSameLayout(bezier, patch);
+            ++patch;
+        });
+
+        if (!sameLayout || patch != mFirstPatches[index + 1])
+            return false;
+    }
+
+    Range patches;
+    Range controlPoints;
+    Range colors;
+
+    mDirtySamples = Range();
+
+    for (const auto& curve : mChangedCurves)
+    {
+        const int index = mCurveIndices.value(curve.get());
+
+        int patch = mFirstPatches[index];
+
+        ForEachPatch(curve, index, [&](BezierPtr bezier, CurvePtr, int, int) {
+            const Patch& packed = mPatches[patch];
+
+            RepackPatch(bezier, curve, patch);
+
+            patches.Add(patch, patch + 1);
+            controlPoints.Add(packed.controlPointOffset, packed.controlPointOffset + packed.controlPointCount);
+            colors.Add(packed.leftColorOffset, packed.rightColorOffset + packed.rightColorCount);
+            ++patch;
+        });
+    }
+
+    Upload(mPatchBuffer, mPatches, mUploadedPatches, patches);
+    Upload(mControlPointBuffer, mControlPoints, mUploadedControlPoints, controlPoints);
+    Upload(mColorBuffer, mColors, mUploadedColors, colors);
+    Upload(mColorPositionBuffer, mColorPositions, mUploadedColorPositions, colors);
+    Upload(mSampleBuffer, mSamples, mDirtySamples.first, mDirtySamples.last);
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    return true;
+}
+
+bool DiffusionCurveRenderer::PatchBuffer::HasSameLayout(BezierPtr bezier, int patch) const
+{
+    const Patch& packed = mPatches[patch];
+
+    if (packed.controlPointCount != int(bezier->GetControlPointPositions().size()) || packed.leftColorCount != int(bezier->GetLeftColors().size()) ||
+        packed.rightColorCount != int(bezier->GetRightColors().size()))
+        return false;
+
+    if (!mAdaptiveTessellation)
+        return true;
+
+    return ChooseSegments(bezier->GetControlPointPositions(), std::exp2(float(mZoomLevel))) == mDesiredSegments[patch];
+}
+
+void DiffusionCurveRenderer::PatchBuffer::RepackPatch(BezierPtr bezier, CurvePtr curve, int patch)
+{
+    Patch& packed = mPatches[patch];
+    packed.contourColor = curve->GetContourColor();
+    packed.contourThickness = curve->GetContourThickness();
+    packed.diffusionWidth = curve->GetDiffusionWidth();
+    packed.diffusionGap = curve->GetDiffusionGap();
+
+    const auto controlPoints = bezier->GetControlPointPositions();
+    QVector2D* packedControlPoints = mControlPoints.data() + packed.controlPointOffset;
+    const bool moved = std::memcmp(packedControlPoints, controlPoints.data(), controlPoints.size_bytes()) != 0;
+    std::copy(controlPoints.begin(), controlPoints.end(), packedControlPoints);
+
+    // Color positions are packed beside the colors
+    const auto leftColors = bezier->GetLeftColors();
+    const auto leftColorPositions = bezier->GetLeftColorPositions();
+    std::copy(leftColors.begin(), leftColors.end(), mColors.begin() + packed.leftColorOffset);
+    std::copy(leftColorPositions.begin(), leftColorPositions.end(), mColorPositions.begin() + packed.leftColorOffset);
+
+    const auto rightColors = bezier->GetRightColors();
+    const auto rightColorPositions = bezier->GetRightColorPositions();
+    std::copy(rightColors.begin(), rightColors.end(), mColors.begin() + packed.rightColorOffset);
+    std::copy(rightColorPositions.begin(), rightColorPositions.end(), mColorPositions.begin() + packed.rightColorOffset);
+
+    if (moved)
+    {
+        const int segments = mSegments[patch];
+
+        Tessellate(bezier, segments, patch, mSamples.data() + packed.sampleOffset);
+        mDirtySamples.Add(packed.sampleOffset, packed.sampleOffset + segments + 1);
+    }
+
+    mBounds[patch] = bezier->GetBoundingBox();
+    mSources[patch] = bezier.get();
+}
+
+void DiffusionCurveRenderer::PatchBuffer::ChooseSegments()
+{
+    mSegments.clear();
+    mDesiredSegments.clear();
+
+    if (!mAdaptiveTessellation)
+    {
+        ForEachPatch([this](BezierPtr, CurvePtr, int, int) { mSegments.append(NUMBER_OF_INTERVALS); });
+        return;
+    }
+
+    const float pixelSize = std::exp2(float(mZoomLevel));
+
+    qint64 total = 0;
+
+    ForEachPatch([&](BezierPtr bezier, CurvePtr, int, int) {
+        mSegments.append(ChooseSegments(bezier->GetControlPointPositions(), pixelSize));
+        total += mSegments.last();
+    });
+
+    mDesiredSegments = mSegments;
+
+    if (total <= mTessellationBudget)
+        return;
+
+    // Coarser tessellation for every patch if the scene does not fit into the budget. Patches at the minimum
+    // cannot get coarser, so the scale is the largest one whose total including them is within the budget.
+    const auto scaledTotal = [this](double scale) {
+        qint64 total = 0;
+
+        for (const int segments : mDesiredSegments)
+            total += qMax(MIN_SEGMENTS_PER_PATCH, int(segments * scale));
+
+        return total;
+    };
+
+    double scale = 0.0;
+
+    if (scaledTotal(0.0) <= mTessellationBudget)
+    {
+        double high = double(mTessellationBudget) / total;
+
+        for (int i = 0; i < 32; ++i)
+        {
+            const double middle = 0.5 * (scale + high);
+
+            if (scaledTotal(middle) <= mTessellationBudget)
+                scale = middle;
+            else
+                high = middle;
+        }
+    }
+    else
+    {
+        LOG_WARN("PatchBuffer::ChooseSegments: The tessellation budget of {} segments is below the minimum of {} segments for {} patches.",
+                 mTessellationBudget,
+                 scaledTotal(0.0),
+                 mSegments.size());
+    }
+
+    for (int index = 0; index < mSegments.size(); ++index)
+        mSegments[index] = qMax(MIN_SEGMENTS_PER_PATCH, int(mDesiredSegments[index] * scale));
+}
+
+int DiffusionCurveRenderer::PatchBuffer::ChooseSegments(std::span<const QVector2D> controlPoints, float pixelSize) const
+{
+    const int degree = controlPoints.size() - 1;
+
+    float hullLength = 0.0f;
+    float secondDifference = 0.0f;
+
+    for (int i = 0; i < degree; ++i)
+        hullLength += (controlPoints[i + 1] - controlPoints[i]).length();
+
+    for (int i = 0; i + 1 < degree; ++i)
+        secondDifference = qMax(secondDifference, (controlPoints[i + 2] - 2 * controlPoints[i + 1] + controlPoints[i]).length());
+
+    // |B''| <= n (n - 1) max |P(i + 2) - 2 P(i + 1) + P(i)| and a segment spanning h in t deviates from
+    // the patch by at most h^2 |B''| / 8, the curvature bound of the flattening
+    const float flatness = std::sqrt(degree * (degree - 1) * secondDifference / (8.0f * mTessellationTolerance * pixelSize));
+
+    // The control hull is not shorter than the patch
+    const float length = hullLength / (MAXIMUM_SEGMENT_LENGTH * pixelSize);
+
+    return std::clamp(int(std::ceil(qMax(flatness, length))), MIN_SEGMENTS_PER_PATCH, MAX_SEGMENTS_PER_PATCH);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::AddPatch(BezierPtr bezier, CurvePtr curve, int curveIndex, int curveType)
+{
+    const int index = mPatches.size();
+    const int segments = mSegments[index];
+
+    Patch patch;
+    patch.curveIndex = curveIndex;
+    patch.curveType = curveType;
+    patch.contourColor = curve->GetContourColor();
+    patch.contourThickness = curve->GetContourThickness();
+    patch.diffusionWidth = curve->GetDiffusionWidth();
+    patch.diffusionGap = curve->GetDiffusionGap();
+
+    const auto controlPoints = bezier->GetControlPointPositions();
+    patch.controlPointOffset = mControlPoints.size();
+    patch.controlPointCount = controlPoints.size();
+    std::copy(controlPoints.begin(), controlPoints.end(), std::back_inserter(mControlPoints));
+
+    const auto leftColors = bezier->GetLeftColors();
+    const auto leftColorPositions = bezier->GetLeftColorPositions();
+    patch.leftColorOffset = mColors.size();
+    patch.leftColorCount = leftColors.size();
+    std::copy(leftColors.begin(), leftColors.end(), std::back_inserter(mColors));
+    std::copy(leftColorPositions.begin(), leftColorPositions.end(), std::back_inserter(mColorPositions));
+
+    const auto rightColors = bezier->GetRightColors();
+    const auto rightColorPositions = bezier->GetRightColorPositions();
+    patch.rightColorOffset = mColors.size();
+    patch.rightColorCount = rightColors.size();
+    std::copy(rightColors.begin(), rightColors.end(), std::back_inserter(mColors));
+    std::copy(rightColorPositions.begin(), rightColorPositions.end(), std::back_inserter(mColorPositions));
+
+    patch.sampleOffset = mSamples.size();
+    mSamples.resize(mSamples.size() + segments + 1);
+
+    Sample* samples = mSamples.data() + patch.sampleOffset;
+
+    // Reuse the previous tessellation if the control points and the number of segments did not change
+    const int previous = mPreviousSources.value(bezier.get(), -1);
+    bool clean = false;
+
+    if (previous >= 0 && mUploadedDrawCommands[previous].count == GLuint(2 * (segments + 1)) &&
+        mUploadedPatches[previous].controlPointCount == patch.controlPointCount &&
+        std::memcmp(mUploadedControlPoints.constData() + mUploadedPatches[previous].controlPointOffset, controlPoints.data(), controlPoints.size_bytes()) == 0)
+    {
+        const int previousOffset = mUploadedPatches[previous].sampleOffset;
+
+        std::copy_n(mPreviousSamples.constData() + previousOffset, segments + 1, samples);
+
+        for (int i = 0; i <= segments; ++i)
+            samples[i].patchIndex = index;
+
+        clean = previousOffset == patch.sampleOffset && previous == index;
+    }
+    else
+    {
+        Tessellate(bezier, segments, index, samples);
+    }
+
+    if (!clean)
+        mDirtySamples.Add(patch.sampleOffset, mSamples.size());
+
+    DrawCommand command;
+    command.count = 2 * (segments + 1);
+    command.instanceCount = 1;
+    command.first = 2 * patch.sampleOffset;
+
+    mPatches.append(patch);
+    mBounds.append(bezier->GetBoundingBox());
+    mDrawCommands.append(command);
+    mSources.append(bezier.get());
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Tessellate(BezierPtr bezier, int segments, int patch, Sample* samples) const
+{
+    constexpr int count = MAX_SEGMENTS_PER_PATCH + 1;
+
+    float parameters[count];
+    float xs[count];
+    float ys[count];
+    float txs[count];
+    float tys[count];
+
+    const int n = segments + 1;
+
+    for (int i = 0; i < n; ++i)
+        parameters[i] = i / float(segments);
+
+    bezier->PositionsAt(std::span(parameters, n), std::span(xs, n), std::span(ys, n));
+    bezier->TangentsAt(std::span(parameters, n), std::span(txs, n), std::span(tys, n));
+
+    // Tangents are negated derivatives, same normals as CpuDiffusionRenderer::AddStrips
+    for (int i = 0; i < n; ++i)
+        samples[i] = Sample{ QVector2D(xs[i], ys[i]), QVector2D(tys[i], -txs[i]), parameters[i], patch };
+}
+
+template<typename T>
+void DiffusionCurveRenderer::PatchBuffer::Upload(StorageBuffer& target, const QVector<T>& data, QVector<T>& uploaded)
+{
+    // Edits usually touch a few consecutive patches, skip the common prefix and suffix
+    const qsizetype common = qMin(data.size(), uploaded.size());
+
+    qsizetype first = 0;
+
+    while (first < common && std::memcmp(&data[first], &uploaded[first], sizeof(T)) == 0)
+        ++first;
+
+    qsizetype last = data.size();
+
+    if (data.size() == uploaded.size())
+    {
+        while (first < last && std::memcmp(&data[last - 1], &uploaded[last - 1], sizeof(T)) == 0)
+            --last;
+    }
+
+    Upload(target, data, first, last);
+
+    uploaded = data;
+}
+
+template<typename T>
+void DiffusionCurveRenderer::PatchBuffer::Upload(StorageBuffer& target, const QVector<T>& data, QVector<T>& uploaded, const Range& range)
+{
+    DCR_ASSERT(data.size() == uploaded.size());
+
+    if (range.first < range.last)
+        std::copy(data.begin() + range.first, data.begin() + range.last, uploaded.begin() + range.first);
+
+    Upload(target, data, range.first, range.last);
+}
+
+template<typename T>
+void DiffusionCurveRenderer::PatchBuffer::Upload(StorageBuffer& target, const QVector<T>& data, qsizetype first, qsizetype last)
+{
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, target.buffer);
+
+    const qsizetype bytes = data.size() * sizeof(T);
+
+    // Grow geometrically, the previous contents are lost so everything is uploaded again
+    if (target.capacity == 0 || target.capacity < bytes)
+    {
+        target.capacity = qMax(qMax(bytes, 2 * target.capacity), qsizetype(sizeof(Patch)));
+        glBufferData(GL_SHADER_STORAGE_BUFFER, target.capacity, nullptr, GL_DYNAMIC_DRAW);
+
+        first = 0;
+        last = data.size();
+    }
+
+    if (first < last)
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, first * sizeof(T), (last - first) * sizeof(T), data.constData() + first);
+}
+
+void DiffusionCurveRenderer::PatchBuffer::Range::Add(qsizetype begin, qsizetype end)
+{
+    first = qMin(first, begin);
+    last = qMax(last, end);
+}
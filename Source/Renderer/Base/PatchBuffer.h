@@ -0,0 +1,252 @@
+#pragma once
+
+#include "Core/CurveContainer.h"
+#include "Core/OrthographicCamera.h"
+#include "Structs/BoundingBox.h"
+#include "Util/Macros.h"
+
+#include <QHash>
+#include <QOpenGLExtraFunctions>
+#include <QVector2D>
+#include <QVector4D>
+#include <QVector>
+#include <limits>
+
+namespace DiffusionCurveRenderer
+{
+    // Every Bezier patch of the curves in the container packed into shader storage buffers so that
+    // ColorRenderer and ContourRenderer draw all patches with a single multi-draw call. Bezier.vert and
+    // Color.vert declare the same layout. Buffers are updated only when the revision of the container
+    // changes. Curves changed in place whose layout stays the same, i.e. the same patches with the same
+    // numbers of control points, colors and segments, are rewritten in place and only their ranges are
+    // uploaded. Anything else repacks every patch and uploads the range of each buffer that differs from
+    // the previous upload.
+    // Patches are tessellated on the CPU into positions and normals which the passes pull as triangle
+    // strips, one draw command per patch. A patch is tessellated again only if its control points or its
+    // number of segments changed. The number of segments is NUMBER_OF_INTERVALS, or in adaptive mode is
+    // chosen from the size and the flatness of the patch at the zoom of the camera. The camera is the cache
+    // camera of DiffusionRenderer so that the colors of both backends are rasterized from the tessellation
+    // of the resolution they are solved at, contours share it.
+    // Patches whose strips cannot reach the region a pass draws are culled on the CPU and only the draw
+    // commands of the remaining patches are submitted.
+    class PatchBuffer : protected QOpenGLExtraFunctions
+    {
+      public:
+        PatchBuffer();
+
+        static constexpr GLuint PATCHES_BINDING = 0;
+        static constexpr GLuint CONTROL_POINTS_BINDING = 1;
+        static constexpr GLuint COLORS_BINDING = 2;
+        static constexpr GLuint COLOR_POSITIONS_BINDING = 3;
+        static constexpr GLuint SAMPLES_BINDING = 4;
+
+        static constexpr int MAX_STRIPS_PER_PATCH = 2;
+
+        // How far the strips of a pass reach out of the bounds of a patch
+        enum class PatchExtent
+        {
+            Curve,
+            Contour,
+            Diffusion
+        };
+
+        // World region drawn by a pass, "padding" is added to the extent of every patch
+        struct View
+        {
+            BoundingBox region;
+            PatchExtent extent{ PatchExtent::Curve };
+            float padding{ 0.0f };
+        };
+
+        void Update();
+
+        void Bind();
+        void Release();
+
+        // Draws "stripsPerPatch" triangle strips for each of the patches [firstPatch, firstPatch + numberOfPatches)
+        // that are visible in "view", gl_InstanceID is the index of the strip within its patch
+        void Render(const View& view, int firstPatch, int numberOfPatches, int stripsPerPatch = 1);
+        void Render(const View& view, int stripsPerPatch = 1);
+
+        int GetNumberOfPatches() const { return mPatches.size(); }
+        int GetNumberOfSamples() const { return mSamples.size(); }
+
+        // Patches drawn and culled by the passes since the last call to ResetStatistics
+        int GetNumberOfDrawnPatches() const { return mNumberOfDrawnPatches; }
+        int GetNumberOfCulledPatches() const { return mNumberOfCulledPatches; }
+        void ResetStatistics();
+
+        // Patches of the curve at "index" in the container are [GetFirstPatch(index), GetFirstPatch(index + 1))
+        int GetFirstPatch(int index) const { return mFirstPatches[index]; }
+
+        // Segments of the strips of a patch, its samples are at the parameters i / segments
+        int GetNumberOfSegments(int patch) const { return mSegments[patch]; }
+
+        void SetAdaptiveTessellation(bool adaptiveTessellation);
+        void SetTessellationTolerance(float tessellationTolerance);
+        void SetTessellationBudget(int tessellationBudget);
+
+        bool GetAdaptiveTessellation() const { return mAdaptiveTessellation; }
+        float GetTessellationTolerance() const { return mTessellationTolerance; }
+        int GetTessellationBudget() const { return mTessellationBudget; }
+
+        // Incremented when a setting changes the tessellation
+        quint64 GetSettingsRevision() const { return mSettingsRevision; }
+
+      private:
+        // std430
+        struct Patch
+        {
+            GLint controlPointOffset{ 0 };
+            GLint controlPointCount{ 0 };
+            GLint leftColorOffset{ 0 };
+            GLint leftColorCount{ 0 };
+            GLint rightColorOffset{ 0 };
+            GLint rightColorCount{ 0 };
+            GLint curveIndex{ 0 };
+            GLint curveType{ 0 };
+            QVector4D contourColor;
+            float contourThickness{ 0 };
+            float diffusionWidth{ 0 };
+            float diffusionGap{ 0 };
+            GLint sampleOffset{ 0 };
+        };
+
+        static_assert(sizeof(Patch) == 64);
+
+        // std430
+        struct Sample
+        {
+            QVector2D position;
+            QVector2D normal;
+            float parameter{ 0 };
+            GLint patchIndex{ 0 };
+        };
+
+        static_assert(sizeof(Sample) == 24);
+
+        // Layout of glMultiDrawArraysIndirect
+        struct DrawCommand
+        {
+            GLuint count{ 0 };
+            GLuint instanceCount{ 0 };
+            GLuint first{ 0 };
+            GLuint baseInstance{ 0 };
+        };
+
+        struct StorageBuffer
+        {
+            GLuint buffer{ 0 };
+            qsizetype capacity{ 0 };
+        };
+
+        // Range of a buffer written since the last upload
+        struct Range
+        {
+            qsizetype first{ std::numeric_limits<qsizetype>::max() };
+            qsizetype last{ 0 };
+
+            void Add(qsizetype begin, qsizetype end);
+        };
+
+        // Calls "function(bezier, curve, curveIndex, curveType)" for every patch in the container
+        template<typename Function>
+        void ForEachPatch(Function function);
+
+        // Same for the patches of the curve at "curveIndex"
+        template<typename Function>
+        void ForEachPatch(const CurvePtr& curve, int curveIndex, Function function);
+
+        void Pack();
+
+        // Rewrites and uploads the patches of the curves changed since the last update, false if the layout
+        // of the buffers has to change or the changes are not known
+        bool Repack();
+        bool HasSameLayout(BezierPtr bezier, int patch) const;
+        void RepackPatch(BezierPtr bezier, CurvePtr curve, int patch);
+        void ChooseSegments();
+        int ChooseSegments(std::span<const QVector2D> controlPoints, float pixelSize) const;
+        void AddPatch(BezierPtr bezier, CurvePtr curve, int curveIndex, int curveType);
+        void Tessellate(BezierPtr bezier, int segments, int patch, Sample* samples) const;
+        float GetExtent(const Patch& patch, PatchExtent extent) const;
+
+        // Uploads the range of "data" that differs from "uploaded" and remembers it
+        template<typename T>
+        void Upload(StorageBuffer& target, const QVector<T>& data, QVector<T>& uploaded);
+
+        // Uploads "range" of "data", which has the size of the previous upload, and copies it into "uploaded"
+        template<typename T>
+        void Upload(StorageBuffer& target, const QVector<T>& data, QVector<T>& uploaded, const Range& range);
+
+        // Uploads [first, last) of "data", or all of it if the buffer has to grow
+        template<typename T>
+        void Upload(StorageBuffer& target, const QVector<T>& data, qsizetype first, qsizetype last);
+
+        QVector<Patch> mPatches;
+        QVector<QVector2D> mControlPoints;
+        QVector<QVector4D> mColors;
+        QVector<float> mColorPositions;
+        QVector<int> mFirstPatches;
+        QVector<BoundingBox> mBounds;
+
+        // Commands for one strip per patch followed by the commands for two strips per patch
+        QVector<DrawCommand> mDrawCommands;
+
+        // Contents of the buffers on the GPU
+        QVector<Patch> mUploadedPatches;
+        QVector<QVector2D> mUploadedControlPoints;
+        QVector<QVector4D> mUploadedColors;
+        QVector<float> mUploadedColorPositions;
+        QVector<DrawCommand> mUploadedDrawCommands;
+
+        // Commands of the visible patches of the last draw that culled any
+        QVector<DrawCommand> mVisibleCommands;
+        QVector<DrawCommand> mUploadedVisibleCommands;
+
+        // Tessellation of the patches in "mPatches" and, while packing, of the previous packing.
+        // Patches are matched with their previous tessellation by address.
+        QVector<Sample> mSamples;
+        QVector<Sample> mPreviousSamples;
+        QVector<const Bezier*> mSources;
+        QHash<const Bezier*, int> mPreviousSources;
+        QVector<int> mSegments;
+        Range mDirtySamples;
+
+        // Segments of every patch before the budget is applied, a changed patch keeps its segments only if
+        // it would get the same number again
+        QVector<int> mDesiredSegments;
+
+        // Index in the container of every packed curve and the curves changed since the last update
+        QHash<const Curve*, int> mCurveIndices;
+        QVector<CurvePtr> mChangedCurves;
+
+        StorageBuffer mPatchBuffer;
+        StorageBuffer mControlPointBuffer;
+        StorageBuffer mColorBuffer;
+        StorageBuffer mColorPositionBuffer;
+        StorageBuffer mSampleBuffer;
+        StorageBuffer mDrawCommandBuffer;
+        StorageBuffer mVisibleCommandBuffer;
+
+        // Strips are generated from gl_VertexID, there are no attributes
+        GLuint mVertexArray{ 0 };
+
+        bool mAdaptiveTessellation{ false };
+        float mTessellationTolerance{ DEFAULT_TESSELLATION_TOLERANCE };
+        int mTessellationBudget{ DEFAULT_TESSELLATION_BUDGET };
+
+        quint64 mRevision{ 0 };
+        quint64 mSettingsRevision{ 1 };
+        quint64 mPackedSettingsRevision{ 0 };
+
+        // Adaptive mode tessellates for the zoom rounded down to a power of two so that zooming does
+        // not tessellate again on every frame
+        int mZoomLevel{ 0 };
+
+        int mNumberOfDrawnPatches{ 0 };
+        int mNumberOfCulledPatches{ 0 };
+
+        DEFINE_MEMBER_PTR(OrthographicCamera, Camera);
+        DEFINE_MEMBER_PTR(CurveContainer, CurveContainer);
+    };
+}
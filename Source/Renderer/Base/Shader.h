@@ -6,6 +6,7 @@
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLShader>
 #include <map>
+#include <span>
 
 namespace DiffusionCurveRenderer
 {
@@ -41,12 +42,18 @@ namespace DiffusionCurveRenderer
 
         template<typename T>
         void SetUniformValueArray(const QString& name, const QVector<T>& values)
+        {
+            SetUniformValueArray(name, std::span<const T>(values.constData(), values.size()));
+        }
+
+        template<typename T>
+        void SetUniformValueArray(const QString& name, std::span<const T> values)
         {
             const auto location = mProgram->uniformLocation(name);
 
             if (0 <= location)
             {
-                mProgram->setUniformValueArray(location, values.constData(), values.size());
+                mProgram->setUniformValueArray(location, values.data(), int(values.size()));
             }
             else
             {
@@ -54,13 +61,13 @@ namespace DiffusionCurveRenderer
             }
         }
 
-        void SetUniformValueFloatArray(const QString& name, const QVector<float>& values)
+        void SetUniformValueFloatArray(const QString& name, std::span<const float> values)
         {
             const auto location = mProgram->uniformLocation(name);
 
             if (0 <= location)
             {
-                mProgram->setUniformValueArray(location, values.constData(), values.size(), 1);
+                mProgram->setUniformValueArray(location, values.data(), int(values.size()), 1);
             }
             else
             {
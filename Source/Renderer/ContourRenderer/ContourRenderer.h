@@ -4,7 +4,7 @@
 #include "Core/CurveContainer.h"
 #include "Core/OrthographicCamera.h"
 #include "Curve/Spline.h"
-#include "Renderer/Base/Interval.h"
+#include "Renderer/Base/PatchBuffer.h"
 #include "Renderer/Base/Shader.h"
 
 #include <QOpenGLExtraFunctions>
@@ -24,12 +24,15 @@ namespace DiffusionCurveRenderer
         void RenderCurve(CurvePtr curve, QOpenGLFramebufferObject* target = nullptr);
 
       private:
-        void RenderCurveInner(CurvePtr curve);
+        void Bind(QOpenGLFramebufferObject* target);
+        void Release();
+
+        PatchBuffer::View GetView() const;
 
         Shader* mBezierShader;
-        Interval* mInterval;
 
         DEFINE_MEMBER_PTR(OrthographicCamera, Camera);
         DEFINE_MEMBER_PTR(CurveContainer, CurveContainer);
+        DEFINE_MEMBER_PTR(PatchBuffer, PatchBuffer);
     };
 }
\ No newline at end of file
@@ -0,0 +1,808 @@
+#include "CpuDiffusionRenderer.h"
+
+#include "Util/Chronometer.h"
+#include "Util/Logger.h"
+#include "Util/Simd.h"
+
+#include <QThread>
+#include <QtConcurrent>
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <numeric>
+#include <span>
+
+namespace
+{
+    using DiffusionCurveRenderer::Simd;
+
+    // Thresholds and 3x3 weights of Downsample.frag, Upsample.frag and Jacobi.frag
+    constexpr float CONSTRAINT_ALPHA = 0.1f;
+    constexpr float WEIGHTS[3][3] = { { 1, 2, 1 }, { 2, 4, 2 }, { 1, 2, 1 } };
+
+    constexpr int MINIMUM_ROWS_PER_BAND = 16;
+
+    // Lane k of a load at offset o is one if o + k is even, used to select the pixels of a red-black pass
+    constexpr float ALTERNATING[16] = { 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0 };
+
+    // Calls function(rowBegin, rowEnd) for bands of [0, rows) on the global thread pool
+    template<typename Function>
+    void ForEachRowBand(int rows, Function&& function)
+    {
+        const int numberOfBands = std::clamp(rows / MINIMUM_ROWS_PER_BAND, 1, 4 * QThread::idealThreadCount());
+
+        QVector<int> bands(numberOfBands);
+        std::iota(bands.begin(), bands.end(), 0);
+
+        QtConcurrent::blockingMap(bands, [&](int band) { function(rows * band / numberOfBands, rows * (band + 1) / numberOfBands); });
+    }
+
+    // Calls function(neighbor, weight) for the 8 neighbors of Jacobi.frag with clamped coordinates,
+    // a neighbor can be the pixel itself at the borders
+    template<typename Function>
+    void ForEachNeighbor(int width, int height, int x, int y, Function&& function)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            const int ny = std::clamp(y + j - 1, 0, height - 1);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                if (i == 1 && j == 1)
+                    continue;
+
+                const int nx = std::clamp(x + i - 1, 0, width - 1);
+                function(ny * width + nx, WEIGHTS[j][i]);
+            }
+        }
+    }
+
+    // Positive if "p" is on the left of a -> b
+    float Edge(const QVector2D& a, const QVector2D& b, const QVector2D& p)
+    {
+        return (b.x() - a.x()) * (p.y() - a.y()) - (b.y() - a.y()) * (p.x() - a.x());
+    }
+
+    // Top-left fill rule for counterclockwise triangles in window coordinates
+    bool IsTopLeft(const QVector2D& a, const QVector2D& b)
+    {
+        const float dx = b.x() - a.x();
+        const float dy = b.y() - a.y();
+        return dy < 0 || (dy == 0 && dx < 0);
+    }
+
+    // Same as colorAt of Color.vert
+    QVector4D ColorAt(std::span<const QVector4D> colors, std::span<const float> positions, float t)
+    {
+        const int count = colors.size();
+
+        if (count == 0)
+            return QVector4D(0, 0, 0, 0);
+
+        for (int i = 1; i < count; i++)
+        {
+            const float t0 = positions[i - 1];
+            const float t1 = positions[i];
+
+            if (t0 <= t && t <= t1)
+                return colors[i - 1] + (t - t0) / (t1 - t0) * (colors[i] - colors[i - 1]);
+        }
+
+        if (t < positions[0])
+            return colors[0];
+
+        if (positions[count - 1] < t)
+            return colors[count - 1];
+
+        return QVector4D(0, 0, 0, 0);
+    }
+
+    // One Jacobi.frag pass over the pixels [x, x + L::WIDTH) of row "y", "xm" and "xp" are the left and right neighbors
+    template<typename L>
+    void SmoothPixels(const float* constraint[4], const float* rows[3][4], float* target[4], int xm, int x, int xp, int y, int parity, float omega)
+    {
+        const int columns[3] = { xm, x, xp };
+
+        auto total = L::Set(0.0f);
+        typename L::Type sums[4] = { L::Set(0.0f), L::Set(0.0f), L::Set(0.0f), L::Set(0.0f) };
+
+        for (int j = 0; j < 3; ++j)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                // Red-black passes use the 5-point stencil, diagonal neighbors have the same color
+                if (0 <= parity && (i == 1) == (j == 1))
+                    continue;
+
+                const auto alpha = L::Load(rows[j][3] + columns[i]);
+                const auto weight = L::Select(L::Greater(alpha, L::Set(0.0f)), L::Set(WEIGHTS[j][i]), L::Set(0.0f));
+
+                total = L::Add(total, weight);
+
+                for (int c = 0; c < 3; ++c)
+                    sums[c] = L::Add(sums[c], L::Mul(weight, L::Load(rows[j][c] + columns[i])));
+
+                sums[3] = L::Add(sums[3], L::Mul(weight, alpha));
+            }
+        }
+
+        // White where no neighbor has been reached yet
+        const auto reached = L::Greater(total, L::Set(0.0f));
+        const auto constrained = L::Greater(L::Load(constraint[3] + x), L::Set(CONSTRAINT_ALPHA));
+
+        // mix() of the shader, exact for omega = 1
+        const auto keep = L::Set(1.0f - omega);
+        const auto relax = L::Set(omega);
+
+        for (int c = 0; c < 4; ++c)
+        {
+            const auto previous = L::Load(rows[1][c] + x);
+            const auto smoothed = L::Select(reached, L::Div(sums[c], total), L::Set(1.0f));
+            const auto relaxed = L::Add(L::Mul(previous, keep), L::Mul(smoothed, relax));
+            auto result = L::Select(constrained, L::Load(constraint[c] + x), relaxed);
+
+            if (0 <= parity)
+                result = L::Select(L::Greater(L::Load(ALTERNATING + ((x + y + parity) & 1)), L::Set(0.5f)), result, previous);
+
+            L::Store(target[c] + x, result);
+        }
+    }
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::Buffer::Resize(const QSize& size)
+{
+    width = size.width();
+    height = size.height();
+
+    for (auto& channel : channels)
+        channel.resize(width * height);
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::Render()
+{
+    MEASURE_CALL_TIME(CPU_DIFFUSION_RENDERER);
+
+    if (mLevels.isEmpty())
+        AllocateLevels();
+
+    CollectTriangles();
+
+    // Color pass into the finest constraint
+    Buffer& colors = mLevels[0].constraint;
+
+    BinTriangles(colors.height);
+
+    for (auto& channel : colors.channels)
+        channel.fill(0.0f);
+
+    ForEachRowBand(colors.height, [&](int rowBegin, int rowEnd) { Rasterize(colors, rowBegin, rowEnd); });
+
+    const auto downsample = [&](int i) {
+        const Buffer& source = mLevels[i - 1].constraint;
+        Buffer& target = mLevels[i].constraint;
+        ForEachRowBand(target.height, [&](int rowBegin, int rowEnd) { Downsample(source, target, rowBegin, rowEnd); });
+    };
+
+    // Levels are downsampled up to the coarsest one which is solved first, the direct solver starts at the
+    // finest level that fits and no coarser level is needed
+    int coarsest = mLevels.size() - 1;
+
+    if (mSolver == DiffusionSolver::Direct)
+    {
+        coarsest = 0;
+
+        while (coarsest < mLevels.size() - 1 && mDirectSolveSize < std::max(mLevels[coarsest].constraint.width, mLevels[coarsest].constraint.height))
+            ++coarsest;
+    }
+
+    for (int i = 1; i <= coarsest; ++i)
+        downsample(i);
+
+    if (mSolver != DiffusionSolver::Direct || !SolveDirect(mLevels[coarsest]))
+    {
+        for (int i = coarsest + 1; i < mLevels.size(); ++i)
+            downsample(i);
+
+        coarsest = mLevels.size() - 1;
+        mLevels[coarsest].target.channels = mLevels[coarsest].constraint.channels;
+    }
+
+    // Upsample and smooth the levels finer than the solved one
+    for (int i = coarsest - 1; 0 <= i; --i)
+    {
+        Level& level = mLevels[i];
+        const Buffer& source = mLevels[i + 1].target;
+
+        MEASURE_CALL_TIME_WITH_ARGS(LEVEL, "{} {:02}", CPU_DIFFUSION_RENDERER_LEVEL, i);
+
+        ForEachRowBand(level.target.height, [&](int rowBegin, int rowEnd) { Upsample(source, level.constraint, level.target, rowBegin, rowEnd); });
+
+        float change;
+        const int passes = Smooth(level, change);
+
+        Chronometer::Annotate(std::format("{} {:02}", CPU_DIFFUSION_RENDERER_LEVEL, i),
+                              change < 0 ? std::format("{} passes", passes) : std::format("{} passes, change {:.2e}", passes, change));
+    }
+
+    Pack(mLevels[0].target);
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::CollectTriangles()
+{
+    mTriangles.clear();
+
+    // World to window coordinates of the finest level, the camera projection is orthographic
+    const QMatrix4x4& projection = mCamera->GetProjectionMatrix();
+    const float halfWidth = 0.5f * mPyramid.GetSize().width();
+    const float halfHeight = 0.5f * mPyramid.GetSize().height();
+
+    mScaleX = projection(0, 0) * halfWidth;
+    mScaleY = projection(1, 1) * halfHeight;
+    mOffsetX = (projection(0, 3) + 1.0f) * halfWidth;
+    mOffsetY = (projection(1, 3) + 1.0f) * halfHeight;
+
+    // Patches are numbered like those of PatchBuffer
+    const auto segmentsOf = [this](int patch) { return mPatchBuffer ? mPatchBuffer->GetNumberOfSegments(patch) : NUMBER_OF_INTERVALS; };
+
+    int patch = 0;
+
+    for (const auto& curve : mCurveContainer->GetCurves())
+    {
+        if (const auto bezier = std::dynamic_pointer_cast<Bezier>(curve))
+        {
+            AddStrips(bezier, curve->GetDiffusionWidth(), curve->GetDiffusionGap(), segmentsOf(patch++));
+        }
+        else if (const auto spline = std::dynamic_pointer_cast<Spline>(curve))
+        {
+            for (const auto& bezier : spline->GetBezierPatches())
+                AddStrips(bezier, spline->GetDiffusionWidth(), spline->GetDiffusionGap(), segmentsOf(patch++));
+        }
+        else
+        {
+            DCR_EXIT_FAILURE("CpuDiffusionRenderer::CollectTriangles: Undefined curve type. Implement this branch!");
+        }
+    }
+
+    DCR_ASSERT(mPatchBuffer == nullptr || patch == mPatchBuffer->GetNumberOfPatches());
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::AddStrips(BezierPtr bezier, float width, float gap, int segments)
+{
+    // Same samples as PatchBuffer::Tessellate, strips are emitted for the segments between them
+    constexpr int maximumCount = std::max(NUMBER_OF_INTERVALS, MAX_SEGMENTS_PER_PATCH) + 1;
+
+    float parameters[maximumCount];
+    float xs[maximumCount];
+    float ys[maximumCount];
+    float txs[maximumCount];
+    float tys[maximumCount];
+
+    const int count = segments + 1;
+
+    for (int i = 0; i < count; ++i)
+        parameters[i] = i / float(segments);
+
+    bezier->PositionsAt(std::span(parameters, count), std::span(xs, count), std::span(ys, count));
+    bezier->TangentsAt(std::span(parameters, count), std::span(txs, count), std::span(tys, count));
+
+    const auto leftColors = bezier->GetLeftColors();
+    const auto leftPositions = bezier->GetLeftColorPositions();
+    const auto rightColors = bezier->GetRightColors();
+    const auto rightPositions = bezier->GetRightColorPositions();
+
+    const auto toWindow = [=](const QVector2D& world) { return QVector2D(mScaleX * world.x() + mOffsetX, mScaleY * world.y() + mOffsetY); };
+
+    Vertex left[2][2];
+    Vertex right[2][2];
+
+    for (int i = 0; i < count; ++i)
+    {
+        // Tangents are negated derivatives, so this is the normal of PatchBuffer
+        const QVector2D point(xs[i], ys[i]);
+        const QVector2D normal(tys[i], -txs[i]);
+
+        const int k = i % 2;
+
+        left[k][0] = Vertex{ toWindow(point - 0.5f * gap * normal), ColorAt(leftColors, leftPositions, parameters[i]) };
+        left[k][1] = Vertex{ toWindow(point - 0.5f * gap * normal - width * normal), left[k][0].color };
+        right[k][0] = Vertex{ toWindow(point + 0.5f * gap * normal), ColorAt(rightColors, rightPositions, parameters[i]) };
+        right[k][1] = Vertex{ toWindow(point + 0.5f * gap * normal + width * normal), right[k][0].color };
+
+        if (i == 0)
+            continue;
+
+        AddQuad(left[1 - k][0], left[1 - k][1], left[k][0], left[k][1]);
+        AddQuad(right[1 - k][0], right[1 - k][1], right[k][0], right[k][1]);
+    }
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::AddQuad(const Vertex& v0, const Vertex& v1, const Vertex& v2, const Vertex& v3)
+{
+    // Triangle strip
+    mTriangles << Triangle{ { v0, v1, v2 } };
+    mTriangles << Triangle{ { v1, v3, v2 } };
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::BinTriangles(int height)
+{
+    const int numberOfBins = (height + RASTER_BIN_ROWS - 1) / RASTER_BIN_ROWS;
+
+    // Pixel centers of triangle i are in the bins [first[i], last[i]]
+    QVector<int> first(mTriangles.size());
+    QVector<int> last(mTriangles.size());
+
+    mBinOffsets.fill(0, numberOfBins + 1);
+
+    for (int i = 0; i < mTriangles.size(); ++i)
+    {
+        const Vertex* vertices = mTriangles[i].vertices;
+
+        const float minY = std::min({ vertices[0].position.y(), vertices[1].position.y(), vertices[2].position.y() });
+        const float maxY = std::max({ vertices[0].position.y(), vertices[1].position.y(), vertices[2].position.y() });
+
+        const int y0 = std::max(0, int(std::ceil(minY - 0.5f)));
+        const int y1 = std::min(height - 1, int(std::floor(maxY - 0.5f)));
+
+        first[i] = y0 / RASTER_BIN_ROWS;
+        last[i] = y1 < y0 ? first[i] - 1 : y1 / RASTER_BIN_ROWS;
+
+        for (int bin = first[i]; bin <= last[i]; ++bin)
+            ++mBinOffsets[bin + 1];
+    }
+
+    std::partial_sum(mBinOffsets.begin(), mBinOffsets.end(), mBinOffsets.begin());
+
+    mBinnedTriangles.resize(mBinOffsets.last());
+
+    QVector<int> cursors(mBinOffsets.begin(), mBinOffsets.end() - 1);
+
+    for (int i = 0; i < mTriangles.size(); ++i)
+        for (int bin = first[i]; bin <= last[i]; ++bin)
+            mBinnedTriangles[cursors[bin]++] = i;
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::Rasterize(Buffer& target, int rowBegin, int rowEnd) const
+{
+    // A pixel is in one bin only and the bins keep the order of the triangles, so later triangles still win
+    for (int bin = rowBegin / RASTER_BIN_ROWS; bin * RASTER_BIN_ROWS < rowEnd; ++bin)
+    {
+        const int binBegin = std::max(rowBegin, bin * RASTER_BIN_ROWS);
+        const int binEnd = std::min(rowEnd, (bin + 1) * RASTER_BIN_ROWS);
+
+        for (int i = mBinOffsets[bin]; i < mBinOffsets[bin + 1]; ++i)
+            RasterizeTriangle(target, mTriangles[mBinnedTriangles[i]], binBegin, binEnd);
+    }
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::RasterizeTriangle(Buffer& target, const Triangle& triangle, int rowBegin, int rowEnd) const
+{
+    const int width = target.width;
+
+    const Vertex* a = &triangle.vertices[0];
+    const Vertex* b = &triangle.vertices[1];
+    const Vertex* c = &triangle.vertices[2];
+
+    float area = Edge(a->position, b->position, c->position);
+
+    if (area == 0.0f)
+        return;
+
+    if (area < 0.0f)
+    {
+        std::swap(b, c);
+        area = -area;
+    }
+
+    // Pixel centers are at half integers
+    const float minX = std::min({ a->position.x(), b->position.x(), c->position.x() });
+    const float maxX = std::max({ a->position.x(), b->position.x(), c->position.x() });
+    const float minY = std::min({ a->position.y(), b->position.y(), c->position.y() });
+    const float maxY = std::max({ a->position.y(), b->position.y(), c->position.y() });
+
+    const int x0 = std::max(0, int(std::ceil(minX - 0.5f)));
+    const int x1 = std::min(width - 1, int(std::floor(maxX - 0.5f)));
+    const int y0 = std::max(rowBegin, int(std::ceil(minY - 0.5f)));
+    const int y1 = std::min(rowEnd - 1, int(std::floor(maxY - 0.5f)));
+
+    if (x1 < x0 || y1 < y0)
+        return;
+
+    const bool topLeftA = IsTopLeft(b->position, c->position);
+    const bool topLeftB = IsTopLeft(c->position, a->position);
+    const bool topLeftC = IsTopLeft(a->position, b->position);
+
+    for (int y = y0; y <= y1; ++y)
+    {
+        float* rows[4] = { target.Row(0, y), target.Row(1, y), target.Row(2, y), target.Row(3, y) };
+
+        for (int x = x0; x <= x1; ++x)
+        {
+            const QVector2D p(x + 0.5f, y + 0.5f);
+
+            const float wa = Edge(b->position, c->position, p);
+            const float wb = Edge(c->position, a->position, p);
+            const float wc = Edge(a->position, b->position, p);
+
+            if ((wa < 0 || (wa == 0 && !topLeftA)) || (wb < 0 || (wb == 0 && !topLeftB)) || (wc < 0 || (wc == 0 && !topLeftC)))
+                continue;
+
+            const QVector4D color = (wa * a->color + wb * b->color + wc * c->color) / area;
+
+            for (int k = 0; k < 4; ++k)
+                rows[k][x] = color[k];
+        }
+    }
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::Downsample(const Buffer& source, Buffer& target, int rowBegin, int rowEnd) const
+{
+    const int lastRow = source.height - 1;
+    const int lastColumn = source.width - 1;
+
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        // Target pixel centers fall on the source texel 2x + 1
+        const int sourceRows[3] = { 2 * y, std::min(2 * y + 1, lastRow), std::min(2 * y + 2, lastRow) };
+
+        for (int x = 0; x < target.width; ++x)
+        {
+            const int sourceColumns[3] = { 2 * x, std::min(2 * x + 1, lastColumn), std::min(2 * x + 2, lastColumn) };
+
+            float total = 0.0f;
+            float sums[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            for (int j = 0; j < 3; ++j)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    const int index = sourceRows[j] * source.width + sourceColumns[i];
+
+                    if (source.channels[3][index] <= CONSTRAINT_ALPHA)
+                        continue;
+
+                    total += WEIGHTS[j][i];
+
+                    for (int c = 0; c < 4; ++c)
+                        sums[c] += WEIGHTS[j][i] * source.channels[c][index];
+                }
+            }
+
+            for (int c = 0; c < 4; ++c)
+                target.Row(c, y)[x] = 0.0f < total ? sums[c] / total : 0.0f;
+        }
+    }
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::Upsample(const Buffer& source, const Buffer& constraint, Buffer& target, int rowBegin, int rowEnd) const
+{
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        const float* constraintAlpha = constraint.Row(3, y);
+
+        for (int c = 0; c < 4; ++c)
+        {
+            const float* constraintRow = constraint.Row(c, y);
+            const float* sourceRow = source.Row(c, y / 2);
+            float* targetRow = target.Row(c, y);
+
+            for (int x = 0; x < target.width; ++x)
+                targetRow[x] = CONSTRAINT_ALPHA < constraintAlpha[x] ? constraintRow[x] : sourceRow[x / 2];
+        }
+    }
+}
+
+int DiffusionCurveRenderer::CpuDiffusionRenderer::Smooth(Level& level, float& change)
+{
+    // UpsampleRenderer writes an odd last iteration into its temporary framebuffer which is never read, so only pairs count
+    const int sweeps = mSmoothIterations / 2;
+    const int height = level.target.height;
+
+    const auto pass = [&](const Buffer& source, Buffer& target, int parity) {
+        const float omega = mSmoother == DiffusionSmoother::Jacobi ? 1.0f : mRelaxationFactor;
+        ForEachRowBand(height, [&](int rowBegin, int rowEnd) { SmoothPass(level.constraint, source, target, parity, omega, rowBegin, rowEnd); });
+    };
+
+    change = -1.0f;
+
+    for (int sweep = 0; sweep < sweeps; ++sweep)
+    {
+        const bool measure = mAdaptiveSmoothing && ((sweep + 1) % CHANGE_CHECK_INTERVAL == 0 || sweep + 1 == sweeps);
+        double totalChange = 0.0;
+
+        // Red-black passes update each pixel in one of the two passes
+        if (mSmoother == DiffusionSmoother::Jacobi)
+        {
+            pass(level.target, level.temporary, -1);
+            pass(level.temporary, level.target, -1);
+
+            if (measure)
+                totalChange = MeasureChange(level.target, level.temporary, -1);
+        }
+        else
+        {
+            pass(level.target, level.temporary, 0);
+
+            if (measure)
+                totalChange = MeasureChange(level.temporary, level.target, 0);
+
+            pass(level.temporary, level.target, 1);
+
+            if (measure)
+                totalChange += MeasureChange(level.target, level.temporary, 1);
+        }
+
+        if (measure)
+        {
+            change = float(totalChange / (double(level.target.width) * height));
+
+            if (change < mChangeTolerance)
+                return 2 * (sweep + 1);
+        }
+    }
+
+    return 2 * sweeps;
+}
+
+double DiffusionCurveRenderer::CpuDiffusionRenderer::MeasureChange(const Buffer& current, const Buffer& previous, int parity) const
+{
+    const int width = current.width;
+    const int height = current.height;
+
+    QVector<double> rowSums(height, 0.0);
+
+    ForEachRowBand(height, [&](int rowBegin, int rowEnd) {
+        for (int y = rowBegin; y < rowEnd; ++y)
+        {
+            // First pixel of the parity in the row
+            const int first = parity < 0 ? 0 : (y + parity) % 2;
+            const int step = parity < 0 ? 1 : 2;
+
+            for (int x = first; x < width; x += step)
+            {
+                float difference = 0.0f;
+
+                for (int c = 0; c < 4; ++c)
+                    difference = std::max(difference, std::abs(current.Row(c, y)[x] - previous.Row(c, y)[x]));
+
+                rowSums[y] += difference;
+            }
+        }
+    });
+
+    return std::accumulate(rowSums.cbegin(), rowSums.cend(), 0.0);
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::SmoothPass(const Buffer& constraint, const Buffer& source, Buffer& target, int parity, float omega, int rowBegin, int rowEnd) const
+{
+    const int width = target.width;
+    const int height = target.height;
+
+    for (int y = rowBegin; y < rowEnd; ++y)
+    {
+        // Clamp to edge
+        const int neighborRows[3] = { std::max(y - 1, 0), y, std::min(y + 1, height - 1) };
+
+        const float* rows[3][4];
+        const float* constraintRow[4];
+        float* targetRow[4];
+
+        for (int c = 0; c < 4; ++c)
+        {
+            for (int j = 0; j < 3; ++j)
+                rows[j][c] = source.Row(c, neighborRows[j]);
+
+            constraintRow[c] = constraint.Row(c, y);
+            targetRow[c] = target.Row(c, y);
+        }
+
+        // Levels are at least 4 pixels wide, only the first and the last columns are clamped
+        SmoothPixels<Simd::Scalar>(constraintRow, rows, targetRow, 0, 0, 1, y, parity, omega);
+
+        Simd::ForEach(width - 2, [&]<typename L>(int i) {
+            SmoothPixels<L>(constraintRow, rows, targetRow, i, i + 1, i + 2, y, parity, omega);
+        });
+
+        SmoothPixels<Simd::Scalar>(constraintRow, rows, targetRow, width - 2, width - 1, width - 1, y, parity, omega);
+    }
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::Pack(const Buffer& source)
+{
+    for (int y = 0; y < source.height; ++y)
+    {
+        uchar* pixels = mResult.scanLine(y);
+
+        for (int c = 0; c < 4; ++c)
+        {
+            const float* row = source.Row(c, y);
+
+            for (int x = 0; x < source.width; ++x)
+                pixels[4 * x + c] = uchar(std::clamp(row[x], 0.0f, 1.0f) * 255.0f + 0.5f);
+        }
+    }
+}
+
+bool DiffusionCurveRenderer::CpuDiffusionRenderer::SolveDirect(Level& level)
+{
+    const Buffer& constraint = level.constraint;
+
+    if (!Factorize(constraint))
+        return false;
+
+    const int width = constraint.width;
+    const int height = constraint.height;
+
+    // Constrained neighbors move to the right hand side
+    Eigen::MatrixXf rhs = Eigen::MatrixXf::Zero(mNumberOfUnknowns, 4);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int pixel = y * width + x;
+            const int row = mUnknowns[pixel];
+
+            if (row < 0)
+                continue;
+
+            ForEachNeighbor(width, height, x, y, [&](int neighbor, float weight) {
+                if (neighbor == pixel || !mFactorizedMask[neighbor])
+                    return;
+
+                for (int c = 0; c < 4; ++c)
+                    rhs(row, c) += weight * constraint.channels[c][neighbor];
+            });
+        }
+    }
+
+    Eigen::MatrixXf solution;
+
+    if (0 < mNumberOfUnknowns)
+        solution = mFactorization.solve(rhs);
+
+    // Pixels that no constraint reaches are white like in Jacobi.frag
+    for (int c = 0; c < 4; ++c)
+    {
+        float* target = level.target.channels[c].data();
+        const float* source = constraint.channels[c].constData();
+
+        for (int pixel = 0; pixel < width * height; ++pixel)
+        {
+            const int row = mUnknowns[pixel];
+
+            if (mFactorizedMask[pixel])
+                target[pixel] = source[pixel];
+            else
+                target[pixel] = 0 <= row ? solution(row, c) : 1.0f;
+        }
+    }
+
+    return true;
+}
+
+bool DiffusionCurveRenderer::CpuDiffusionRenderer::Factorize(const Buffer& constraint)
+{
+    const int width = constraint.width;
+    const int height = constraint.height;
+    const int numberOfPixels = width * height;
+    const float* alpha = constraint.channels[3].constData();
+
+    QVector<quint8> mask(numberOfPixels);
+
+    for (int pixel = 0; pixel < numberOfPixels; ++pixel)
+        mask[pixel] = CONSTRAINT_ALPHA < alpha[pixel];
+
+    // Same system as the last time, only the right hand side changes
+    if (mask == mFactorizedMask)
+        return mFactorizationValid;
+
+    MEASURE_CALL_TIME(CPU_DIFFUSION_FACTORIZE);
+
+    mFactorizedMask = mask;
+    mFactorizationValid = false;
+    ++mNumberOfFactorizations;
+
+    // Flood fill from the constraints, reached pixels are marked with -2 and numbered in raster order afterwards
+    mUnknowns.fill(-1, numberOfPixels);
+
+    QVector<int> queue;
+    queue.reserve(numberOfPixels);
+
+    for (int pixel = 0; pixel < numberOfPixels; ++pixel)
+        if (mask[pixel])
+            queue << pixel;
+
+    for (int head = 0; head < queue.size(); ++head)
+    {
+        const int x = queue[head] % width;
+        const int y = queue[head] / width;
+
+        ForEachNeighbor(width, height, x, y, [&](int neighbor, float) {
+            if (!mask[neighbor] && mUnknowns[neighbor] == -1)
+            {
+                mUnknowns[neighbor] = -2;
+                queue << neighbor;
+            }
+        });
+    }
+
+    mNumberOfUnknowns = 0;
+
+    for (int pixel = 0; pixel < numberOfPixels; ++pixel)
+        if (mUnknowns[pixel] == -2)
+            mUnknowns[pixel] = mNumberOfUnknowns++;
+
+    // Fixed point of the smoothing, every unknown is the weighted mean of its neighbors
+    QVector<Eigen::Triplet<float>> triplets;
+    triplets.reserve(9 * mNumberOfUnknowns);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int pixel = y * width + x;
+            const int row = mUnknowns[pixel];
+
+            if (row < 0)
+                continue;
+
+            float diagonal = 0.0f;
+
+            ForEachNeighbor(width, height, x, y, [&](int neighbor, float weight) {
+                if (neighbor == pixel)
+                    return;
+
+                diagonal += weight;
+
+                if (0 <= mUnknowns[neighbor])
+                    triplets << Eigen::Triplet<float>(row, mUnknowns[neighbor], -weight);
+            });
+
+            triplets << Eigen::Triplet<float>(row, row, diagonal);
+        }
+    }
+
+    if (mNumberOfUnknowns == 0)
+    {
+        mFactorizationValid = true;
+        return true;
+    }
+
+    Eigen::SparseMatrix<float> matrix(mNumberOfUnknowns, mNumberOfUnknowns);
+    matrix.setFromTriplets(triplets.begin(), triplets.end());
+
+    mFactorization.compute(matrix);
+    mFactorizationValid = mFactorization.info() == Eigen::Success;
+
+    if (!mFactorizationValid)
+        LOG_WARN("CpuDiffusionRenderer::Factorize: Factorization failed, falling back to the multigrid solver.");
+
+    return mFactorizationValid;
+}
+
+QImage DiffusionCurveRenderer::CpuDiffusionRenderer::ToImage() const
+{
+    return mResult.mirrored();
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::SetPyramid(const Pyramid& pyramid)
+{
+    // Buffers are allocated on the next render so that an unused backend costs no memory
+    mPyramid = pyramid;
+    mLevels.clear();
+    mFactorizedMask.clear();
+}
+
+void DiffusionCurveRenderer::CpuDiffusionRenderer::AllocateLevels()
+{
+    for (const auto& size : mPyramid.levels)
+    {
+        Level level;
+        level.constraint.Resize(size);
+        level.target.Resize(size);
+        level.temporary.Resize(size);
+        mLevels << level;
+    }
+
+    mResult = QImage(mPyramid.GetSize(), QImage::Format_RGBA8888);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Core/Constants.h"
+#include "Core/CurveContainer.h"
+#include "Core/OrthographicCamera.h"
+#include "Renderer/Base/PatchBuffer.h"
+#include "Structs/Enums.h"
+#include "Structs/Pyramid.h"
+#include "Util/Macros.h"
+
+#include <Eigen/SparseCholesky>
+
+#include <QImage>
+#include <QVector2D>
+#include <QVector4D>
+#include <QVector>
+#include <array>
+
+namespace DiffusionCurveRenderer
+{
+    // Software counterpart of DiffusionRenderer that does not need an OpenGL context unless a patch buffer is set.
+    // Color strips are rasterized exactly like Color.vert with the segments of the patch buffer, then the pyramid
+    // of DownsampleRenderer and UpsampleRenderer is solved on float buffers. Rows are processed in parallel bands
+    // and the Jacobi smoothing is vectorized.
+    // The direct solver replaces the finest level up to "DirectSolveSize" and every coarser level with an exact
+    // solve of the fixed point of the smoothing, only the finer levels are smoothed. Its factorization depends
+    // only on which pixels are constrained, so it is kept until the constraint mask changes. If the finest level
+    // of the pyramid fits, nothing is smoothed and edits that only change colors cost a back substitution.
+    class CpuDiffusionRenderer
+    {
+      public:
+        CpuDiffusionRenderer() = default;
+
+        void Render();
+
+        // RGBA8, rows are ordered bottom to top like the textures of DiffusionRenderer
+        const QImage& GetResult() const { return mResult; }
+
+        // Result with rows ordered top to bottom
+        QImage ToImage() const;
+
+        // Same levels as the framebuffers of DownsampleRenderer and UpsampleRenderer
+        void SetPyramid(const Pyramid& pyramid);
+        const Pyramid& GetPyramid() const { return mPyramid; }
+
+        // Factorizations of the direct solver so far
+        int GetNumberOfFactorizations() const { return mNumberOfFactorizations; }
+
+      private:
+        static constexpr int RASTER_BIN_ROWS = 16;
+
+        // Planar RGBA
+        struct Buffer
+        {
+            int width{ 0 };
+            int height{ 0 };
+            std::array<QVector<float>, 4> channels;
+
+            void Resize(const QSize& size);
+            float* Row(int channel, int y) { return channels[channel].data() + y * width; }
+            const float* Row(int channel, int y) const { return channels[channel].constData() + y * width; }
+        };
+
+        struct Vertex
+        {
+            QVector2D position; // Window coordinates, origin at the bottom left
+            QVector4D color;
+        };
+
+        struct Triangle
+        {
+            Vertex vertices[3];
+        };
+
+        struct Level
+        {
+            Buffer constraint;
+            Buffer target;
+            Buffer temporary;
+        };
+
+        void AllocateLevels();
+        void CollectTriangles();
+        // Same segments as the patch of PatchBuffer, NUMBER_OF_INTERVALS without a patch buffer
+        void AddStrips(BezierPtr bezier, float width, float gap, int segments);
+        void AddQuad(const Vertex& v0, const Vertex& v1, const Vertex& v2, const Vertex& v3);
+        // Sorts the triangles into bins of RASTER_BIN_ROWS rows of "height", keeping their order in each bin
+        void BinTriangles(int height);
+        void Rasterize(Buffer& target, int rowBegin, int rowEnd) const;
+        void RasterizeTriangle(Buffer& target, const Triangle& triangle, int rowBegin, int rowEnd) const;
+
+        void Downsample(const Buffer& source, Buffer& target, int rowBegin, int rowEnd) const;
+        void Upsample(const Buffer& source, const Buffer& constraint, Buffer& target, int rowBegin, int rowEnd) const;
+        // Same as UpsampleRenderer::Smooth, except that the change of a check is known at once and ends the smoothing
+        int Smooth(Level& level, float& change);
+        void SmoothPass(const Buffer& constraint, const Buffer& source, Buffer& target, int parity, float omega, int rowBegin, int rowEnd) const;
+        // Sum of the largest channel changes of the pixels updated by a pass of "parity", -1 is every pixel
+        double MeasureChange(const Buffer& current, const Buffer& previous, int parity) const;
+
+        void Pack(const Buffer& source);
+
+        // Exact solve into level.target, false if the system could not be factorized
+        bool SolveDirect(Level& level);
+        bool Factorize(const Buffer& constraint);
+
+        QVector<Level> mLevels;
+        QVector<Triangle> mTriangles;
+
+        // Triangles of bin i are mBinnedTriangles[mBinOffsets[i], mBinOffsets[i + 1])
+        QVector<int> mBinOffsets;
+        QVector<int> mBinnedTriangles;
+        QImage mResult;
+
+        Pyramid mPyramid;
+
+        // Projection from world to window coordinates of the finest level
+        float mScaleX{ 1.0f };
+        float mScaleY{ 1.0f };
+        float mOffsetX{ 0.0f };
+        float mOffsetY{ 0.0f };
+
+        // Direct solver, "mUnknowns" maps pixels to rows of the system, constrained pixels and
+        // pixels that no constraint can reach are negative
+        Eigen::SimplicialLDLT<Eigen::SparseMatrix<float>> mFactorization;
+        QVector<quint8> mFactorizedMask;
+        QVector<int> mUnknowns;
+        int mNumberOfUnknowns{ 0 };
+        bool mFactorizationValid{ false };
+        int mNumberOfFactorizations{ 0 };
+
+        DEFINE_MEMBER(int, SmoothIterations, DEFAULT_SMOOTH_ITERATIONS);
+        DEFINE_MEMBER(DiffusionSmoother, Smoother, DiffusionSmoother::Jacobi);
+        DEFINE_MEMBER(float, RelaxationFactor, DEFAULT_RELAXATION_FACTOR);
+        DEFINE_MEMBER(bool, AdaptiveSmoothing, false);
+        DEFINE_MEMBER(float, ChangeTolerance, DEFAULT_CHANGE_TOLERANCE);
+        DEFINE_MEMBER(DiffusionSolver, Solver, DiffusionSolver::Multigrid);
+        DEFINE_MEMBER(int, DirectSolveSize, DEFAULT_DIRECT_SOLVE_SIZE);
+
+        DEFINE_MEMBER_PTR(OrthographicCamera, Camera);
+        DEFINE_MEMBER_PTR(CurveContainer, CurveContainer);
+        DEFINE_MEMBER_PTR(PatchBuffer, PatchBuffer); // Optional, must be up to date when rendering
+    };
+}
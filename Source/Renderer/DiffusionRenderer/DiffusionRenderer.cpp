@@ -1,11 +1,18 @@
 #include "DiffusionRenderer.h"
 
 #include "Core/Constants.h"
+#include "Renderer/DiffusionRenderer/CpuDiffusionRenderer.h"
 #include "Renderer/DiffusionRenderer/Renderers/ColorRenderer.h"
 #include "Renderer/DiffusionRenderer/Renderers/DownsampleRenderer.h"
+#include "Renderer/DiffusionRenderer/Renderers/JumpFloodRenderer.h"
 #include "Renderer/DiffusionRenderer/Renderers/UpsampleRenderer.h"
 #include "Util/Chronometer.h"
 
+#include <QImage>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
 void DiffusionCurveRenderer::DiffusionRenderer::Initialize()
 {
     initializeOpenGLFunctions();
@@ -17,24 +24,103 @@ void DiffusionCurveRenderer::DiffusionRenderer::Initialize()
     mBlitter->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/Blit.frag");
     mBlitter->Initialize();
 
+    // Curves are colored and diffused in the world region of the cache camera instead of the view,
+    // and tessellated for its texel size
+    mPatchBuffer->SetCamera(&mCacheCamera);
+
     mColorRenderer = new ColorRenderer;
-    mColorRenderer->SetCamera(mCamera);
-    mColorRenderer->SetCurveContainer(mCurveContainer);
+    mColorRenderer->SetCamera(&mCacheCamera);
+    mColorRenderer->SetPatchBuffer(mPatchBuffer);
+    mColorRenderer->SetFramebufferPool(mFramebufferPool);
 
     mDownsampleRenderer = new DownsampleRenderer;
+    mDownsampleRenderer->SetFramebufferPool(mFramebufferPool);
+
+    mJumpFloodRenderer = new JumpFloodRenderer;
+    mJumpFloodRenderer->SetFramebufferPool(mFramebufferPool);
+
     mUpsampleRenderer = new UpsampleRenderer;
+    mUpsampleRenderer->SetFramebufferPool(mFramebufferPool);
+    mUpsampleRenderer->SetJumpFloodRenderer(mJumpFloodRenderer);
+
+    mCpuDiffusionRenderer = new CpuDiffusionRenderer;
+    mCpuDiffusionRenderer->SetCamera(&mCacheCamera);
+    mCpuDiffusionRenderer->SetCurveContainer(mCurveContainer);
+    mCpuDiffusionRenderer->SetPatchBuffer(mPatchBuffer);
 
-    mFramebufferFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
-    mFramebufferFormat.setSamples(0);
+    glGenTextures(1, &mCpuResultTexture);
 
-    SetFramebufferSize(DEFAULT_FRAMEBUFFER_SIZE);
+    // The cache is resampled, so bilinear instead of the nearest filtering of the framebuffer textures
+    glGenSamplers(1, &mCacheSampler);
+    glSamplerParameteri(mCacheSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glSamplerParameteri(mCacheSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(mCacheSampler, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glSamplerParameteri(mCacheSampler, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 }
 
 void DiffusionCurveRenderer::DiffusionRenderer::Render(QOpenGLFramebufferObject* target)
 {
-    mColorRenderer->Render(mFramebuffer.get());
-    mDownsampleRenderer->Downsample(mFramebuffer.get());
-    mUpsampleRenderer->Upsample(mDownsampleRenderer->GetFramebuffers());
+    FitPyramid();
+
+    const BoundingBox visible = mCamera->GetVisibleRegion();
+
+    // World units per texel of the cache and the finest the framebuffer can resolve for this view
+    const float cacheTexelSize = mCacheCamera.GetZoom();
+    const float bestTexelSize = GetBestTexelSize(visible);
+
+    const bool navigating = mCameraRevision != mCamera->GetRevision();
+    mCameraRevision = mCamera->GetRevision();
+
+    const bool edited = mCurveRevision != mCurveContainer->GetRevision();
+    const bool cacheValid = mResultValid && mTessellationRevision == mPatchBuffer->GetSettingsRevision() && CacheContains(visible);
+
+    bool solve = edited || !cacheValid;
+
+    // Zooming in magnifies the cache until the camera stops, it is solved at the new resolution afterwards
+    const bool magnified = DIFFUSION_CACHE_MAXIMUM_MAGNIFICATION * bestTexelSize < cacheTexelSize;
+
+    if (!solve && magnified)
+        solve = target != nullptr || !navigating;
+
+    // Warm started results are solved in full once the curves stayed the same for a few frames
+    if (!solve && mWarmStarted)
+        solve = target != nullptr || WARM_START_REFINE_FRAMES <= ++mFramesWithoutEdits;
+
+    if (solve)
+    {
+        QRect region;
+
+        // Small edits of single curves with the same camera start from the previous result
+        if (mWarmStart && mBackend == DiffusionBackend::Gpu && edited && cacheValid && !magnified && !navigating && target == nullptr &&
+            ChooseWarmStartRegion(region))
+        {
+            RefineGpu(region);
+
+            mWarmStarted = true;
+            mFramesWithoutEdits = 0;
+        }
+        else
+        {
+            UpdateCacheRegion(visible);
+
+            if (mBackend == DiffusionBackend::Cpu)
+                RenderCpu();
+            else
+                RenderGpu();
+
+            // Frees the framebuffers of previous settings, e.g. of a previous pyramid, a refinement
+            // acquires only a part of those of a full solve
+            mFramebufferPool->TrimUnused();
+
+            mWarmStarted = false;
+        }
+
+        mResultValid = true;
+        mCurveRevision = mCurveContainer->GetRevision();
+        mTessellationRevision = mPatchBuffer->GetSettingsRevision();
+    }
+
+    const GLuint result = mBackend == DiffusionBackend::Cpu ? mCpuResultTexture : mUpsampleRenderer->GetResult();
 
     if (target == nullptr)
     {
@@ -48,32 +134,356 @@ void DiffusionCurveRenderer::DiffusionRenderer::Render(QOpenGLFramebufferObject*
         glViewport(0, 0, target->width(), target->height());
     }
 
+    // Maps the texture coordinates of the view to the cache
+    const QVector2D cacheSize = GetCacheSize();
+    const QVector2D scale = (visible.max - visible.min) / cacheSize;
+    const QVector2D offset((visible.min.x() - mCacheCamera.GetLeft()) / cacheSize.x(), 1.0f - (visible.max.y() - mCacheCamera.GetTop()) / cacheSize.y());
+
     mBlitter->Bind();
-    mBlitter->SetSampler("sourceTexture", 0, mUpsampleRenderer->GetResult()->texture());
+    mBlitter->SetSampler("sourceTexture", 0, result);
+    mBlitter->SetUniformValue("scale", scale);
+    mBlitter->SetUniformValue("offset", offset);
+    glBindSampler(0, mCacheSampler);
     mQuad->Render();
+    glBindSampler(0, 0);
     mBlitter->Release();
 }
 
-void DiffusionCurveRenderer::DiffusionRenderer::SetFramebufferSize(int size)
+bool DiffusionCurveRenderer::DiffusionRenderer::CacheContains(const BoundingBox& region)
+{
+    const QVector2D cacheSize = GetCacheSize();
+
+    return mCacheCamera.GetLeft() <= region.min.x() && region.max.x() <= mCacheCamera.GetLeft() + cacheSize.x() &&
+           mCacheCamera.GetTop() <= region.min.y() && region.max.y() <= mCacheCamera.GetTop() + cacheSize.y();
+}
+
+QVector2D DiffusionCurveRenderer::DiffusionRenderer::GetCacheSize() const
+{
+    return mCacheCamera.GetZoom() * QVector2D(mCacheCamera.GetWidth(), mCacheCamera.GetHeight());
+}
+
+float DiffusionCurveRenderer::DiffusionRenderer::GetBestTexelSize(const BoundingBox& region) const
+{
+    const QSize size = mPyramid.GetSize();
+    const QVector2D regionSize = region.max - region.min;
+
+    return std::max({ mCamera->GetZoom(), regionSize.x() / size.width(), regionSize.y() / size.height() });
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::UpdateCacheRegion(const BoundingBox& visible)
+{
+    const QSize size = mPyramid.GetSize();
+
+    // Whole scene if it fits at full resolution, panning and zooming out are then free
+    BoundingBox scene = mCurveContainer->GetBoundingBox();
+    scene.Expand(visible);
+
+    const QVector2D sceneSize = (1.0f + DIFFUSION_CACHE_MARGIN) * (scene.max - scene.min);
+    const float sceneTexelSize = std::max(sceneSize.x() / size.width(), sceneSize.y() / size.height());
+
+    float texelSize = GetBestTexelSize(visible);
+    QVector2D center = 0.5f * (visible.min + visible.max);
+
+    if (sceneTexelSize <= texelSize)
+    {
+        texelSize = sceneTexelSize;
+        center = 0.5f * (scene.min + scene.max);
+    }
+
+    mCacheCamera.SetWidth(size.width());
+    mCacheCamera.SetHeight(size.height());
+    mCacheCamera.SetZoom(texelSize);
+    mCacheCamera.SetLeft(center.x() - 0.5f * texelSize * size.width());
+    mCacheCamera.SetTop(center.y() - 0.5f * texelSize * size.height());
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::RenderGpu()
+{
+    // Colors are rendered straight into the finest level of the downsample pyramid
+    mColorRenderer->Render(mDownsampleRenderer->GetFramebuffer());
+    mDownsampleRenderer->Downsample();
+    mUpsampleRenderer->Upsample(mDownsampleRenderer->GetFramebuffer());
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::RefineGpu(const QRect& region)
+{
+    // Only the finest level is smoothed, the coarser constraints are downsampled by the next full solve
+    mColorRenderer->Render(mDownsampleRenderer->GetFramebuffer());
+    mUpsampleRenderer->Refine(mDownsampleRenderer->GetFramebuffer(), region);
+}
+
+bool DiffusionCurveRenderer::DiffusionRenderer::ChooseWarmStartRegion(QRect& region) const
+{
+    BoundingBox changed;
+
+    if (!mCurveContainer->GetChangedRegion(mCurveRevision, changed) || changed.IsEmpty())
+        return false;
+
+    const QSize size = mPyramid.GetSize();
+    const float zoom = mCacheCamera.GetZoom();
+
+    // World to texels of the cache, rows are bottom to top
+    const float left = std::clamp((changed.min.x() - mCacheCamera.GetLeft()) / zoom - WARM_START_MARGIN, 0.0f, float(size.width()));
+    const float right = std::clamp((changed.max.x() - mCacheCamera.GetLeft()) / zoom + WARM_START_MARGIN, 0.0f, float(size.width()));
+    const float bottom = std::clamp(size.height() - (changed.max.y() - mCacheCamera.GetTop()) / zoom - WARM_START_MARGIN, 0.0f, float(size.height()));
+    const float top = std::clamp(size.height() - (changed.min.y() - mCacheCamera.GetTop()) / zoom + WARM_START_MARGIN, 0.0f, float(size.height()));
+
+    region.setCoords(int(std::floor(left)), int(std::floor(bottom)), int(std::ceil(right)) - 1, int(std::ceil(top)) - 1);
+
+    return double(region.width()) * region.height() <= WARM_START_MAXIMUM_AREA * double(size.width()) * size.height();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::RenderCpu()
+{
+    // Segments of the patches for the current cache region
+    mPatchBuffer->Update();
+    mCpuDiffusionRenderer->Render();
+
+    const QImage& image = mCpuDiffusionRenderer->GetResult();
+
+    // Rows of the result are already bottom to top
+    glBindTexture(GL_TEXTURE_2D, mCpuResultTexture);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image.width(), image.height(), GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+QImage DiffusionCurveRenderer::DiffusionRenderer::GetResultImage()
+{
+    if (mBackend == DiffusionBackend::Cpu)
+        return mCpuDiffusionRenderer->GetResult();
+
+    return mUpsampleRenderer->GetResultImage();
+}
+
+const QVector<int>& DiffusionCurveRenderer::DiffusionRenderer::GetLevelPasses() const
+{
+    return mUpsampleRenderer->GetLevelPasses();
+}
+
+DiffusionCurveRenderer::Pyramid DiffusionCurveRenderer::DiffusionRenderer::ChoosePyramid() const
 {
-    mFramebuffer = std::make_unique<QOpenGLFramebufferObject>(size, size, mFramebufferFormat);
+    if (mResolution == DiffusionResolution::Fixed)
+        return Pyramid::Create(mFramebufferSize, mFramebufferSize, mMinimumLevelSize);
+
+    // Viewport with a margin so that panning a little stays in the cache
+    const float width = (1.0f + DIFFUSION_CACHE_MARGIN) * mCamera->GetWidth();
+    const float height = (1.0f + DIFFUSION_CACHE_MARGIN) * mCamera->GetHeight();
+
+    const auto create = [=](float scale) {
+        const int scaledWidth = std::clamp(int(std::ceil(scale * width)), 1, MAXIMUM_FRAMEBUFFER_SIZE);
+        const int scaledHeight = std::clamp(int(std::ceil(scale * height)), 1, MAXIMUM_FRAMEBUFFER_SIZE);
+        return Pyramid::Create(scaledWidth, scaledHeight, mMinimumLevelSize);
+    };
+
+    if (mResolution == DiffusionResolution::Viewport)
+        return create(mResolutionScale);
+
+    // Memory grows with the square of the scale, the rounding of the levels is corrected afterwards
+    const double budget = double(mMemoryBudget) * (1 << 20);
 
-    mColorRenderer->SetFramebufferSize(size);
-    mDownsampleRenderer->SetFramebufferSize(size);
-    mUpsampleRenderer->SetFramebufferSize(size);
+    float scale = std::sqrt(budget / EstimateMemory(create(1.0f)));
+    Pyramid pyramid = create(scale);
+
+    while (MINIMUM_RESOLUTION_SCALE < scale && budget < EstimateMemory(pyramid))
+    {
+        scale *= 0.95f;
+        pyramid = create(scale);
+    }
+
+    return pyramid;
+}
+
+quint64 DiffusionCurveRenderer::DiffusionRenderer::EstimateMemory(const Pyramid& pyramid) const
+{
+    quint64 bytes = 0;
+
+    // Downsample, upsample and temporary levels are the mip chains of three RGBA8 textures. Changes are
+    // R32F padded to a power of two square with mipmaps, one per level, only acquired by adaptive smoothing.
+    for (const auto& size : pyramid.levels)
+    {
+        bytes += quint64(size.width()) * size.height() * 3 * 4;
+
+        if (mUpsampleRenderer->GetAdaptiveSmoothing())
+        {
+            const quint64 paddedSize = std::bit_ceil(quint64(std::max(size.width(), size.height())));
+            bytes += paddedSize * paddedSize * 4 * 4 / 3;
+        }
+    }
+
+    // Result texture of the CPU backend and the multisample framebuffer if used, colors are rendered into the finest downsample level
+    const QSize size = pyramid.GetSize();
+    bytes += quint64(size.width()) * size.height() * (4 + (mColorRenderer->GetUseMultisampleFramebuffer() ? 8 * 4 : 0));
+
+    return bytes;
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::FitPyramid()
+{
+    const Pyramid pyramid = ChoosePyramid();
+
+    if (mPyramid == pyramid)
+        return;
+
+    mPyramid = pyramid;
+    mResultValid = false;
+
+    const QSize size = mPyramid.GetSize();
+
+    mDownsampleRenderer->SetPyramid(mPyramid);
+    mUpsampleRenderer->SetPyramid(mPyramid);
+    mCpuDiffusionRenderer->SetPyramid(mPyramid);
+
+    // Same parameters as the textures of QOpenGLFramebufferObject
+    glBindTexture(GL_TEXTURE_2D, mCpuResultTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.width(), size.height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void DiffusionCurveRenderer::DiffusionRenderer::SetSmoothIterations(int smoothIterations)
 {
+    mResultValid = false;
     mUpsampleRenderer->SetSmoothIterations(smoothIterations);
+    mCpuDiffusionRenderer->SetSmoothIterations(smoothIterations);
 }
 
 void DiffusionCurveRenderer::DiffusionRenderer::SetUseMultisampleFramebuffer(bool val)
 {
+    mResultValid = false;
     mColorRenderer->SetUseMultisampleFramebuffer(val);
 }
 
+DiffusionCurveRenderer::DiffusionSolver DiffusionCurveRenderer::DiffusionRenderer::GetCpuSolver() const
+{
+    return mCpuDiffusionRenderer->GetSolver();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetBackend(DiffusionBackend backend)
+{
+    if (mBackend == backend)
+        return;
+
+    mBackend = backend;
+    mResultValid = false;
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetCpuSolver(DiffusionSolver solver)
+{
+    if (mCpuDiffusionRenderer->GetSolver() == solver)
+        return;
+
+    mResultValid = false;
+    mCpuDiffusionRenderer->SetSolver(solver);
+}
+
+bool DiffusionCurveRenderer::DiffusionRenderer::NeedsRefinement() const
+{
+    return mWarmStarted;
+}
+
+int DiffusionCurveRenderer::DiffusionRenderer::GetDirectSolveSize() const
+{
+    return mCpuDiffusionRenderer->GetDirectSolveSize();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetDirectSolveSize(int size)
+{
+    if (mCpuDiffusionRenderer->GetDirectSolveSize() == size)
+        return;
+
+    mResultValid = false;
+    mCpuDiffusionRenderer->SetDirectSolveSize(size);
+}
+
+int DiffusionCurveRenderer::DiffusionRenderer::GetNumberOfCpuFactorizations() const
+{
+    return mCpuDiffusionRenderer->GetNumberOfFactorizations();
+}
+
 int DiffusionCurveRenderer::DiffusionRenderer::GetSmoothIterations() const
 {
     return mUpsampleRenderer->GetSmoothIterations();
 }
+
+DiffusionCurveRenderer::DiffusionPasses DiffusionCurveRenderer::DiffusionRenderer::GetPasses() const
+{
+    return mUpsampleRenderer->GetPasses();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetPasses(DiffusionPasses passes)
+{
+    if (mUpsampleRenderer->GetPasses() == passes)
+        return;
+
+    mResultValid = false;
+    mDownsampleRenderer->SetPasses(passes);
+    mUpsampleRenderer->SetPasses(passes);
+}
+
+DiffusionCurveRenderer::DiffusionInitialGuess DiffusionCurveRenderer::DiffusionRenderer::GetInitialGuess() const
+{
+    return mUpsampleRenderer->GetInitialGuess();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetInitialGuess(DiffusionInitialGuess initialGuess)
+{
+    if (mUpsampleRenderer->GetInitialGuess() == initialGuess)
+        return;
+
+    mResultValid = false;
+    mUpsampleRenderer->SetInitialGuess(initialGuess);
+}
+
+DiffusionCurveRenderer::DiffusionSmoother DiffusionCurveRenderer::DiffusionRenderer::GetSmoother() const
+{
+    return mUpsampleRenderer->GetSmoother();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetSmoother(DiffusionSmoother smoother)
+{
+    if (mUpsampleRenderer->GetSmoother() == smoother)
+        return;
+
+    mResultValid = false;
+    mUpsampleRenderer->SetSmoother(smoother);
+    mCpuDiffusionRenderer->SetSmoother(smoother);
+}
+
+float DiffusionCurveRenderer::DiffusionRenderer::GetRelaxationFactor() const
+{
+    return mUpsampleRenderer->GetRelaxationFactor();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetRelaxationFactor(float relaxationFactor)
+{
+    mResultValid = false;
+    mUpsampleRenderer->SetRelaxationFactor(relaxationFactor);
+    mCpuDiffusionRenderer->SetRelaxationFactor(relaxationFactor);
+}
+
+bool DiffusionCurveRenderer::DiffusionRenderer::GetAdaptiveSmoothing() const
+{
+    return mUpsampleRenderer->GetAdaptiveSmoothing();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetAdaptiveSmoothing(bool adaptiveSmoothing)
+{
+    mResultValid = false;
+    mUpsampleRenderer->SetAdaptiveSmoothing(adaptiveSmoothing);
+    mCpuDiffusionRenderer->SetAdaptiveSmoothing(adaptiveSmoothing);
+}
+
+float DiffusionCurveRenderer::DiffusionRenderer::GetChangeTolerance() const
+{
+    return mUpsampleRenderer->GetChangeTolerance();
+}
+
+void DiffusionCurveRenderer::DiffusionRenderer::SetChangeTolerance(float changeTolerance)
+{
+    mResultValid = false;
+    mUpsampleRenderer->SetChangeTolerance(changeTolerance);
+    mCpuDiffusionRenderer->SetChangeTolerance(changeTolerance);
+}
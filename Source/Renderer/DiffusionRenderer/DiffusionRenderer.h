@@ -1,19 +1,26 @@
 #pragma once
 
+#include "Core/Constants.h"
 #include "Core/CurveContainer.h"
 #include "Core/OrthographicCamera.h"
-#include "Renderer/Base/MultisampleFramebuffer.h"
+#include "Renderer/Base/FramebufferPool.h"
+#include "Renderer/Base/PatchBuffer.h"
 #include "Renderer/Base/Quad.h"
 #include "Renderer/Base/Shader.h"
+#include "Structs/Enums.h"
+#include "Structs/Pyramid.h"
 
+#include <QImage>
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLFramebufferObject>
-#include <map>
+#include <QRect>
 
 namespace DiffusionCurveRenderer
 {
     class ColorRenderer;
+    class CpuDiffusionRenderer;
     class DownsampleRenderer;
+    class JumpFloodRenderer;
     class UpsampleRenderer;
 
     class DiffusionRenderer : protected QOpenGLExtraFunctions
@@ -24,24 +31,117 @@ namespace DiffusionCurveRenderer
         void Initialize();
         void Render(QOpenGLFramebufferObject* target = nullptr);
 
+        // The result is warm started and is solved in full by one of the next frames without edits,
+        // frames have to be rendered until then
+        bool NeedsRefinement() const;
+
         int GetSmoothIterations() const;
 
-        void SetFramebufferSize(int size);
+        // Raw RGBA8 of the cached result of the current backend, rows are bottom to top
+        QImage GetResultImage();
+
+        // Smoothing passes of every level of the last GPU solve, the coarsest level is not smoothed
+        const QVector<int>& GetLevelPasses() const;
+
         void SetSmoothIterations(int smoothIterations);
         void SetUseMultisampleFramebuffer(bool val);
 
+        DiffusionBackend GetBackend() const { return mBackend; }
+        void SetBackend(DiffusionBackend backend);
+
+        DiffusionPasses GetPasses() const;
+        void SetPasses(DiffusionPasses passes);
+
+        DiffusionInitialGuess GetInitialGuess() const;
+        void SetInitialGuess(DiffusionInitialGuess initialGuess);
+
+        DiffusionSolver GetCpuSolver() const;
+        void SetCpuSolver(DiffusionSolver solver);
+
+        // Longer side of the finest level that the direct solver of the CPU backend solves, in pixels
+        int GetDirectSolveSize() const;
+        void SetDirectSolveSize(int size);
+        int GetNumberOfCpuFactorizations() const;
+
+        // Smoothing of the upsampled levels, applied to both backends
+        DiffusionSmoother GetSmoother() const;
+        void SetSmoother(DiffusionSmoother smoother);
+        float GetRelaxationFactor() const;
+        void SetRelaxationFactor(float relaxationFactor);
+        bool GetAdaptiveSmoothing() const;
+        void SetAdaptiveSmoothing(bool adaptiveSmoothing);
+        float GetChangeTolerance() const;
+        void SetChangeTolerance(float changeTolerance);
+
+        // Levels allocated for the last render and their GPU memory in bytes
+        const Pyramid& GetPyramid() const { return mPyramid; }
+        quint64 GetMemoryUsage() const { return EstimateMemory(mPyramid); }
+
       private:
+        void RenderGpu();
+        void RenderCpu();
+
+        // Renders the constraints and smooths the previous result around "region" of the finest level, in texels
+        void RefineGpu(const QRect& region);
+
+        // Texels of the cache around the curves changed since the last solve, false if the change is too large
+        // or not limited to single curves
+        bool ChooseWarmStartRegion(QRect& region) const;
+
+        // Pyramid of the current resolution settings, reallocates the framebuffers if it changed
+        Pyramid ChoosePyramid() const;
+        quint64 EstimateMemory(const Pyramid& pyramid) const;
+        void FitPyramid();
+
+        bool CacheContains(const BoundingBox& region);
+        void UpdateCacheRegion(const BoundingBox& visible);
+
+        // World size of the cache region and the finest texel size at which the pyramid covers "region"
+        QVector2D GetCacheSize() const;
+        float GetBestTexelSize(const BoundingBox& region) const;
+
         ColorRenderer* mColorRenderer;
         DownsampleRenderer* mDownsampleRenderer;
         UpsampleRenderer* mUpsampleRenderer;
+        JumpFloodRenderer* mJumpFloodRenderer;
+        CpuDiffusionRenderer* mCpuDiffusionRenderer;
+
+        // Result of the CPU backend
+        GLuint mCpuResultTexture{ 0 };
 
         Shader* mBlitter;
         Quad* mQuad;
 
-        QOpenGLFramebufferObjectFormat mFramebufferFormat;
-        std::unique_ptr<QOpenGLFramebufferObject> mFramebuffer{ nullptr };
+        DiffusionBackend mBackend{ DiffusionBackend::Gpu };
+
+        Pyramid mPyramid;
+
+        // The result is a cache of the diffusion in a world region, the region of "mCacheCamera".
+        // It is only solved again if the curves or a setting changed, the view leaves the region or,
+        // once the camera stops, the view is zoomed in too far for the resolution of the cache.
+        OrthographicCamera mCacheCamera;
+        GLuint mCacheSampler{ 0 };
+
+        bool mResultValid{ false };
+
+        // The result only smooths the latest edits, it is solved in full once the edits stop
+        bool mWarmStarted{ false };
+        int mFramesWithoutEdits{ 0 };
+        quint64 mCurveRevision{ 0 };
+        quint64 mTessellationRevision{ 0 };
+        quint64 mCameraRevision{ 0 };
+
+        // Fixed is a square of "FramebufferSize", the other modes follow the aspect of the viewport
+        DEFINE_MEMBER(DiffusionResolution, Resolution, DiffusionResolution::Viewport);
+        DEFINE_MEMBER(int, FramebufferSize, DEFAULT_FRAMEBUFFER_SIZE);
+        DEFINE_MEMBER(float, ResolutionScale, DEFAULT_RESOLUTION_SCALE);
+        DEFINE_MEMBER(int, MinimumLevelSize, DEFAULT_MINIMUM_LEVEL_SIZE);
+        DEFINE_MEMBER(int, MemoryBudget, DEFAULT_DIFFUSION_MEMORY_BUDGET);
+        DEFINE_MEMBER(bool, WarmStart, true); // Edits of the GPU backend start from the previous result
 
         DEFINE_MEMBER_PTR(OrthographicCamera, Camera);
         DEFINE_MEMBER_PTR(CurveContainer, CurveContainer);
+        DEFINE_MEMBER_PTR(PatchBuffer, PatchBuffer);
+        DEFINE_MEMBER_PTR(FramebufferPool, FramebufferPool);
     };
 }
\ No newline at end of file
@@ -2,12 +2,13 @@
 
 #include "Core/CurveContainer.h"
 #include "Core/OrthographicCamera.h"
-#include "Renderer/Base/Interval.h"
+#include "Renderer/Base/FramebufferPool.h"
+#include "Renderer/Base/MipmapFramebuffer.h"
+#include "Renderer/Base/PatchBuffer.h"
 #include "Renderer/Base/Shader.h"
 
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLFramebufferObject>
-#include <memory>
 
 namespace DiffusionCurveRenderer
 {
@@ -16,24 +17,21 @@ namespace DiffusionCurveRenderer
       public:
         ColorRenderer();
 
-        void Render(QOpenGLFramebufferObject* target);
-
-        void SetFramebufferSize(int size);
+        // Renders into the finest level of the first texture of "target"
+        void Render(MipmapFramebuffer* target);
 
       private:
-        void RenderPrivate(QOpenGLFramebufferObject* target);
-        void SetUniforms(BezierPtr curve);
-        void BlitFramebuffer(QOpenGLFramebufferObject* source, QOpenGLFramebufferObject* target);
+        // Clears and renders into the bound framebuffer
+        void RenderPrivate();
 
-        Interval* mInterval;
         Shader* mColorShader;
 
         DEFINE_MEMBER(bool, UseMultisampleFramebuffer, false);
 
         QOpenGLFramebufferObjectFormat mMultisampleFramebufferFormat;
-        std::unique_ptr<QOpenGLFramebufferObject> mMultisampleFramebuffer{ nullptr };
 
         DEFINE_MEMBER_PTR(OrthographicCamera, Camera);
-        DEFINE_MEMBER_PTR(CurveContainer, CurveContainer);
+        DEFINE_MEMBER_PTR(FramebufferPool, FramebufferPool);
+        DEFINE_MEMBER_PTR(PatchBuffer, PatchBuffer);
     };
 }
\ No newline at end of file
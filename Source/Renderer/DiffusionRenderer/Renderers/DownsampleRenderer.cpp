@@ -3,6 +3,12 @@
 #include "Core/Constants.h"
 #include "Util/Chronometer.h"
 
+namespace
+{
+    // Levels written by a dispatch are read by the next one and by the upsampling, either as images or as textures
+    constexpr GLbitfield COMPUTE_BARRIERS = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT;
+}
+
 DiffusionCurveRenderer::DownsampleRenderer::DownsampleRenderer()
 {
     initializeOpenGLFunctions();
@@ -14,66 +20,63 @@ DiffusionCurveRenderer::DownsampleRenderer::DownsampleRenderer()
     mDownsampleShader->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/Downsample.frag");
     mDownsampleShader->Initialize();
 
-    mFramebufferFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
-    mFramebufferFormat.setSamples(0);
-    mFramebufferFormat.setMipmap(false);
-    mFramebufferFormat.setTextureTarget(GL_TEXTURE_2D);
-    mFramebufferFormat.setInternalTextureFormat(GL_RGBA8);
+    mDownsampleComputeShader = new Shader("Downsample Compute Shader");
+    mDownsampleComputeShader->AddPath(QOpenGLShader::Compute, ":/Resources/Shaders/Downsample.comp");
+    mDownsampleComputeShader->Initialize();
 
-    SetFramebufferSize(DEFAULT_FRAMEBUFFER_SIZE);
+    mFramebuffer = new MipmapFramebuffer(1);
 }
 
-void DiffusionCurveRenderer::DownsampleRenderer::Downsample(QOpenGLFramebufferObject* source)
+void DiffusionCurveRenderer::DownsampleRenderer::Downsample()
 {
     MEASURE_CALL_TIME(DOWNSAMPLE_RENDERER);
 
-    BlitSourceFramebuffer(source);
-
-    for (int i = 1; i < mFramebuffers.size(); ++i)
+    if (mPasses == DiffusionPasses::Compute)
     {
-        Downsample(mFramebuffers[i - 1], mFramebuffers[i]);
+        DownsampleCompute();
+        return;
     }
-}
 
-void DiffusionCurveRenderer::DownsampleRenderer::BlitSourceFramebuffer(QOpenGLFramebufferObject* source)
-{
-    QOpenGLFramebufferObject::blitFramebuffer(
-        mFramebuffers[0],
-        QRect(0, 0, mFramebuffers[0]->width(), mFramebuffers[0]->height()),
-        source,
-        QRect(0, 0, source->width(), source->height()),
-        GL_COLOR_BUFFER_BIT,
-        GL_LINEAR,
-        0,
-        0);
-}
+    mDownsampleShader->Bind();
+    mDownsampleShader->SetSampler("colorTexture", 0, mFramebuffer->GetTexture(0));
 
-void DiffusionCurveRenderer::DownsampleRenderer::Downsample(QOpenGLFramebufferObject* source, QOpenGLFramebufferObject* target)
-{
-    target->bind();
-    glViewport(0, 0, target->width(), target->height());
-    glClearColor(0, 0, 0, 0);
-    glClear(GL_COLOR_BUFFER_BIT);
+    for (int i = 1; i < mFramebuffer->GetNumberOfLevels(); ++i)
+    {
+        mFramebuffer->Bind(0, i);
+        glClearColor(0, 0, 0, 0);
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        mDownsampleShader->SetUniformValue("sourceLevel", i - 1);
+        mQuad->Render();
+    }
 
-    mDownsampleShader->Bind();
-    mDownsampleShader->SetSampler("colorTexture", 0, source->textures().at(0));
-    mQuad->Render();
     mDownsampleShader->Release();
-    target->release();
+    mFramebuffer->Release();
 }
 
-void DiffusionCurveRenderer::DownsampleRenderer::SetFramebufferSize(int size)
+void DiffusionCurveRenderer::DownsampleRenderer::DownsampleCompute()
 {
-    for (int i = 0; i < mFramebuffers.size(); ++i)
-    {
-        delete mFramebuffers[i];
-    }
+    const GLuint texture = mFramebuffer->GetTexture(0);
 
-    mFramebuffers.clear();
+    mDownsampleComputeShader->Bind();
 
-    while (size > 2)
+    for (int i = 1; i < mFramebuffer->GetNumberOfLevels(); ++i)
     {
-        mFramebuffers << new QOpenGLFramebufferObject(size, size, mFramebufferFormat);
-        size /= 2;
+        const QSize size = mFramebuffer->GetSize(i);
+
+        glBindImageTexture(0, texture, i - 1, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+        glBindImageTexture(1, texture, i, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+        glDispatchCompute((size.width() + COMPUTE_DOWNSAMPLE_TILE_SIZE - 1) / COMPUTE_DOWNSAMPLE_TILE_SIZE,
+                          (size.height() + COMPUTE_DOWNSAMPLE_TILE_SIZE - 1) / COMPUTE_DOWNSAMPLE_TILE_SIZE,
+                          1);
+        glMemoryBarrier(COMPUTE_BARRIERS);
     }
+
+    mDownsampleComputeShader->Release();
+}
+
+void DiffusionCurveRenderer::DownsampleRenderer::SetPyramid(const Pyramid& pyramid)
+{
+    mFramebuffer->SetFramebufferPool(mFramebufferPool);
+    mFramebuffer->SetPyramid(pyramid);
 }
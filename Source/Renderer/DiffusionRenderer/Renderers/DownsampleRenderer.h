@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Core/Constants.h"
+#include "Renderer/Base/MipmapFramebuffer.h"
 #include "Renderer/Base/Quad.h"
 #include "Renderer/Base/Shader.h"
+#include "Structs/Enums.h"
+#include "Structs/Pyramid.h"
 #include "Util/Macros.h"
 
 #include <QOpenGLExtraFunctions>
@@ -15,19 +18,24 @@ namespace DiffusionCurveRenderer
       public:
         DownsampleRenderer();
 
-        void Downsample(QOpenGLFramebufferObject* source);
+        // Downsamples the finest level, the target of the color pass, into the coarser levels
+        void Downsample();
 
-        const QVector<QOpenGLFramebufferObject*>& GetFramebuffers() const { return mFramebuffers; }
+        // Levels are the mip chain of its only texture
+        MipmapFramebuffer* GetFramebuffer() const { return mFramebuffer; }
 
-        void SetFramebufferSize(int size);
+        void SetPyramid(const Pyramid& pyramid);
 
       private:
-        void BlitSourceFramebuffer(QOpenGLFramebufferObject* source);
-        void Downsample(QOpenGLFramebufferObject* source, QOpenGLFramebufferObject* target);
+        // Tiles of the source in shared memory, one dispatch per level
+        void DownsampleCompute();
 
         Quad* mQuad;
         Shader* mDownsampleShader;
-        QOpenGLFramebufferObjectFormat mFramebufferFormat;
-        QVector<QOpenGLFramebufferObject*> mFramebuffers;
+        Shader* mDownsampleComputeShader;
+        MipmapFramebuffer* mFramebuffer;
+
+        DEFINE_MEMBER(DiffusionPasses, Passes, DiffusionPasses::Fragment);
+        DEFINE_MEMBER_PTR(FramebufferPool, FramebufferPool);
     };
 }
\ No newline at end of file
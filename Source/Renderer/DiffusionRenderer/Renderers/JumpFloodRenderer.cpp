@@ -0,0 +1,98 @@
+#include "JumpFloodRenderer.h"
+
+#include "Util/Logger.h"
+
+#include <algorithm>
+#include <bit>
+
+DiffusionCurveRenderer::JumpFloodRenderer::JumpFloodRenderer()
+{
+    initializeOpenGLFunctions();
+
+    mQuad = new Quad;
+
+    mSeedShader = new Shader("Jump Flood Seed Shader");
+    mSeedShader->AddPath(QOpenGLShader::Vertex, ":/Resources/Shaders/Quad.vert");
+    mSeedShader->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/JumpFloodSeed.frag");
+    mSeedShader->Initialize();
+
+    mJumpFloodShader = new Shader("Jump Flood Shader");
+    mJumpFloodShader->AddPath(QOpenGLShader::Vertex, ":/Resources/Shaders/Quad.vert");
+    mJumpFloodShader->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/JumpFlood.frag");
+    mJumpFloodShader->Initialize();
+
+    mFillShader = new Shader("Jump Flood Fill Shader");
+    mFillShader->AddPath(QOpenGLShader::Vertex, ":/Resources/Shaders/Quad.vert");
+    mFillShader->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/JumpFloodFill.frag");
+    mFillShader->Initialize();
+
+    mSeedFramebufferFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+    mSeedFramebufferFormat.setSamples(0);
+    mSeedFramebufferFormat.setTextureTarget(GL_TEXTURE_2D);
+    mSeedFramebufferFormat.setInternalTextureFormat(GL_RG32F);
+}
+
+void DiffusionCurveRenderer::JumpFloodRenderer::Flood(MipmapFramebuffer* constraints)
+{
+    DCR_ASSERT(mSeeds == nullptr);
+
+    const QSize size = constraints->GetSize(0);
+
+    QOpenGLFramebufferObject* seeds[2] = { mFramebufferPool->Acquire(size, mSeedFramebufferFormat),
+                                           mFramebufferPool->Acquire(size, mSeedFramebufferFormat) };
+    int current = 0;
+
+    seeds[current]->bind();
+    glViewport(0, 0, size.width(), size.height());
+
+    mSeedShader->Bind();
+    mSeedShader->SetSampler("constraintTexture", 0, constraints->GetTexture(0));
+    mSeedShader->SetUniformValue("level", 0);
+    mQuad->Render();
+    mSeedShader->Release();
+
+    // Steps of half the next power of two down to 1, log2 passes reach every pixel
+    mJumpFloodShader->Bind();
+
+    for (int step = std::bit_ceil(unsigned(std::max(size.width(), size.height()))) / 2; 0 < step; step /= 2)
+    {
+        seeds[1 - current]->bind();
+
+        mJumpFloodShader->SetSampler("seedTexture", 0, seeds[current]->texture());
+        mJumpFloodShader->SetUniformValue("step", step);
+        mQuad->Render();
+
+        current = 1 - current;
+    }
+
+    mJumpFloodShader->Release();
+
+    QOpenGLFramebufferObject::bindDefault();
+
+    mSeeds = seeds[current];
+    mFramebufferPool->Release(seeds[1 - current]);
+}
+
+void DiffusionCurveRenderer::JumpFloodRenderer::Fill(MipmapFramebuffer* constraints, MipmapFramebuffer* target, int texture, int level)
+{
+    DCR_ASSERT(mSeeds != nullptr);
+
+    target->Bind(texture, level);
+
+    mFillShader->Bind();
+    mFillShader->SetSampler("seedTexture", 0, mSeeds->texture());
+    mFillShader->SetSampler("constraintTexture", 1, constraints->GetTexture(0));
+    mFillShader->SetUniformValue("level", level);
+    mQuad->Render();
+    mFillShader->Release();
+
+    target->Release();
+}
+
+void DiffusionCurveRenderer::JumpFloodRenderer::ReleaseSeeds()
+{
+    if (mSeeds)
+        mFramebufferPool->Release(mSeeds);
+
+    mSeeds = nullptr;
+}
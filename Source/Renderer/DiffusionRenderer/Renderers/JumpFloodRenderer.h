@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Renderer/Base/FramebufferPool.h"
+#include "Renderer/Base/MipmapFramebuffer.h"
+#include "Renderer/Base/Quad.h"
+#include "Renderer/Base/Shader.h"
+#include "Util/Macros.h"
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+
+namespace DiffusionCurveRenderer
+{
+    class JumpFloodRenderer : protected QOpenGLExtraFunctions
+    {
+      public:
+        JumpFloodRenderer();
+
+        // Finds the nearest constrained pixel of the finest level of "constraints", its first texture, for every
+        // pixel of the finest level by jump flooding. The seeds stay acquired until they are released.
+        void Flood(MipmapFramebuffer* constraints);
+
+        // Renders "level" of "constraints" into the same level of "texture" of "target", its empty pixels take the
+        // color of the finest constrained pixel nearest to their center. Needs the seeds of the last flood.
+        void Fill(MipmapFramebuffer* constraints, MipmapFramebuffer* target, int texture, int level);
+
+        void ReleaseSeeds();
+
+      private:
+        Quad* mQuad;
+
+        Shader* mSeedShader;
+        Shader* mJumpFloodShader;
+        Shader* mFillShader;
+
+        // Pixel coordinates of the nearest seed found so far, negative without one. Acquired from the pool
+        // from the flood until the levels are filled.
+        QOpenGLFramebufferObjectFormat mSeedFramebufferFormat;
+        QOpenGLFramebufferObject* mSeeds{ nullptr };
+
+        DEFINE_MEMBER_PTR(FramebufferPool, FramebufferPool);
+    };
+}
@@ -2,8 +2,23 @@
 
 #include "Core/Constants.h"
 #include "Util/Chronometer.h"
+#include "Util/Logger.h"
 
 #include <QImage>
+#include <QVector2D>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <limits>
+
+namespace
+{
+    // Levels written by a dispatch are read by the next one as images, by the finer level, the change
+    // reduction, copies and read backs
+    constexpr GLbitfield COMPUTE_BARRIERS = GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT | GL_TEXTURE_UPDATE_BARRIER_BIT |
+                                            GL_FRAMEBUFFER_BARRIER_BIT;
+}
 
 DiffusionCurveRenderer::UpsampleRenderer::UpsampleRenderer()
 {
@@ -21,103 +36,460 @@ DiffusionCurveRenderer::UpsampleRenderer::UpsampleRenderer()
     mJacobiShader->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/Jacobi.frag");
     mJacobiShader->Initialize();
 
-    mFramebufferFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
-    mFramebufferFormat.setSamples(0);
-    mFramebufferFormat.setMipmap(false);
-    mFramebufferFormat.setTextureTarget(GL_TEXTURE_2D);
-    mFramebufferFormat.setInternalTextureFormat(GL_RGBA8);
+    mChangeShader = new Shader("Change Shader");
+    mChangeShader->AddPath(QOpenGLShader::Vertex, ":/Resources/Shaders/Quad.vert");
+    mChangeShader->AddPath(QOpenGLShader::Fragment, ":/Resources/Shaders/Change.frag");
+    mChangeShader->Initialize();
+
+    mSmoothComputeShader = new Shader("Smooth Compute Shader");
+    mSmoothComputeShader->AddPath(QOpenGLShader::Compute, ":/Resources/Shaders/Smooth.comp");
+    mSmoothComputeShader->Initialize();
+
+    mFramebuffer = new MipmapFramebuffer(2);
 
-    SetFramebufferSize(DEFAULT_FRAMEBUFFER_SIZE);
+    mChangeFramebufferFormat.setAttachment(QOpenGLFramebufferObject::NoAttachment);
+    mChangeFramebufferFormat.setSamples(0);
+    mChangeFramebufferFormat.setMipmap(true);
+    mChangeFramebufferFormat.setTextureTarget(GL_TEXTURE_2D);
+    mChangeFramebufferFormat.setInternalTextureFormat(GL_R32F);
+
+    glGenFramebuffers(1, &mMipLevelFramebuffer);
+
+    glGenBuffers(1, &mChangeBuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mChangeBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(float), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 }
 
-void DiffusionCurveRenderer::UpsampleRenderer::Upsample(QVector<QOpenGLFramebufferObject*> downsamples)
+void DiffusionCurveRenderer::UpsampleRenderer::Upsample(MipmapFramebuffer* downsamples)
 {
     MEASURE_CALL_TIME(UPSAMPLE_RENDERER);
 
-    BlitSourceFramebuffer(downsamples.last());
+    const int coarsest = mFramebuffer->GetNumberOfLevels() - 1;
+
+    StartCoarsest(downsamples);
+
+    mLevelPasses.fill(0, coarsest + 1);
+
+    const GLuint constraint = downsamples->GetTexture(0);
+
+    if (mPasses == DiffusionPasses::Compute)
+    {
+        mSmoothComputeShader->Bind();
+        mSmoothComputeShader->SetUniformValue("redBlack", mSmoother == DiffusionSmoother::RedBlackSor ? 1 : 0);
+        mSmoothComputeShader->SetUniformValue("omega", mSmoother == DiffusionSmoother::Jacobi ? 1.0f : mRelaxationFactor);
+    }
+
+    for (int i = coarsest - 1; i >= 0; --i)
+    {
+        MEASURE_CALL_TIME_WITH_ARGS(LEVEL, "{} {:02}", UPSAMPLE_RENDERER_LEVEL, i);
+
+        const QRect levelRegion(QPoint(0, 0), mFramebuffer->GetSize(i));
+
+        float change;
+        int passes;
+
+        if (mPasses == DiffusionPasses::Compute)
+        {
+            passes = SmoothCompute(i, downsamples, levelRegion, true, change);
+        }
+        else
+        {
+            Start(i, downsamples);
+            passes = Smooth(i, constraint, levelRegion, change);
+        }
+
+        mLevelPasses[i] = passes;
+
+        // Changes are only read back in adaptive mode
+        Chronometer::Annotate(std::format("{} {:02}", UPSAMPLE_RENDERER_LEVEL, i),
+                              change < 0 ? std::format("{} passes", passes) : std::format("{} passes, change {:.2e}", passes, change));
+    }
+
+    if (mPasses == DiffusionPasses::Compute)
+        mSmoothComputeShader->Release();
+
+    if (mInitialGuess == DiffusionInitialGuess::JumpFlood)
+        mJumpFloodRenderer->ReleaseSeeds();
+
+    mFramebuffer->Release();
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::Refine(MipmapFramebuffer* downsamples, const QRect& region)
+{
+    MEASURE_CALL_TIME(UPSAMPLE_RENDERER_REFINE);
+
+    // No initial guess, the finest level continues from the last result with the settings of a full solve
+    const QRect levelSize(QPoint(0, 0), mFramebuffer->GetSize(0));
+    const QRect levelRegion = region.intersected(levelSize);
+    const GLuint constraint = downsamples->GetTexture(0);
+
+    float change;
+    int passes;
+
+    if (mPasses == DiffusionPasses::Compute)
+    {
+        mSmoothComputeShader->Bind();
+        mSmoothComputeShader->SetUniformValue("redBlack", mSmoother == DiffusionSmoother::RedBlackSor ? 1 : 0);
+        mSmoothComputeShader->SetUniformValue("omega", mSmoother == DiffusionSmoother::Jacobi ? 1.0f : mRelaxationFactor);
+
+        passes = SmoothCompute(0, downsamples, levelRegion, false, change);
 
-    for (int i = mUpsampleFramebuffers.size() - 2; i >= 0; --i)
+        mSmoothComputeShader->Release();
+    }
+    else
     {
-        Upsample(mUpsampleFramebuffers[i], mTemporaryFramebuffers[i], mUpsampleFramebuffers[i + 1], downsamples[i]);
+        // The scratch texture starts from the last result as well, the passes read it beyond the region
+        mFramebuffer->Copy(*mFramebuffer, GetTexture(0), 1 - GetTexture(0), 0, levelRegion.adjusted(-1, -1, 1, 1).intersected(levelSize));
+
+        passes = Smooth(0, constraint, levelRegion, change);
     }
+
+    Chronometer::Annotate(UPSAMPLE_RENDERER_REFINE,
+                          change < 0 ? std::format("{} passes", passes) : std::format("{} passes, change {:.2e}", passes, change));
+
+    mFramebuffer->Release();
+}
+
+GLuint DiffusionCurveRenderer::UpsampleRenderer::GetResult() const
+{
+    return mFramebuffer->GetTexture(GetTexture(0));
+}
+
+QImage DiffusionCurveRenderer::UpsampleRenderer::GetResultImage()
+{
+    return mFramebuffer->ToImage(GetTexture(0), 0);
 }
 
-void DiffusionCurveRenderer::UpsampleRenderer::Upsample(QOpenGLFramebufferObject* target, QOpenGLFramebufferObject* temporary, QOpenGLFramebufferObject* source, QOpenGLFramebufferObject* constraint)
+void DiffusionCurveRenderer::UpsampleRenderer::StartCoarsest(MipmapFramebuffer* downsamples)
 {
-    target->bind();
-    glViewport(0, 0, target->width(), target->height());
+    // Coarsest level starts from the downsampled colors, their empty pixels are otherwise only filled by smoothing
+    const int coarsest = mFramebuffer->GetNumberOfLevels() - 1;
+
+    if (mInitialGuess == DiffusionInitialGuess::JumpFlood)
+    {
+        mJumpFloodRenderer->Flood(downsamples);
+        mJumpFloodRenderer->Fill(downsamples, mFramebuffer, GetTexture(coarsest), coarsest);
+    }
+    else
+    {
+        mFramebuffer->Copy(*downsamples, 0, GetTexture(coarsest), coarsest);
+    }
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::Start(int level, MipmapFramebuffer* downsamples)
+{
+    // The jump flood guess fills the empty pixels of every level instead of the upsampled coarser level
+    if (mInitialGuess == DiffusionInitialGuess::JumpFlood)
+        mJumpFloodRenderer->Fill(downsamples, mFramebuffer, GetTexture(level), level);
+    else
+        Upsample(level, downsamples->GetTexture(0));
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::Upsample(int level, GLuint constraint)
+{
+    mFramebuffer->Bind(GetTexture(level), level);
     glClearColor(0, 0, 0, 0);
     glClear(GL_COLOR_BUFFER_BIT);
 
     mUpsampleShader->Bind();
-    mUpsampleShader->SetSampler("colorSourceTexture", 0, source->textures().at(0));
-    mUpsampleShader->SetSampler("colorTargetTexture", 1, constraint->textures().at(0));
+    mUpsampleShader->SetSampler("colorSourceTexture", 0, mFramebuffer->GetTexture(GetTexture(level + 1)));
+    mUpsampleShader->SetSampler("colorTargetTexture", 1, constraint);
+    mUpsampleShader->SetUniformValue("level", level);
     mQuad->Render();
     mUpsampleShader->Release();
+}
+
+int DiffusionCurveRenderer::UpsampleRenderer::Smooth(int level, GLuint constraint, const QRect& region, float& change)
+{
+    // An odd last iteration would end in the temporary texture
+    const int sweeps = mSmoothIterations / 2;
 
-    for (int j = 0; j < mSmoothIterations; j++)
+    change = -1.0f;
+
+    for (int sweep = 0; sweep < sweeps; ++sweep)
     {
-        if (j % 2 == 0)
+        if (!mAdaptiveSmoothing || (sweep + 1) % CHANGE_CHECK_INTERVAL != 0)
         {
-            temporary->bind();
-            glViewport(0, 0, temporary->width(), temporary->height());
-
-            mJacobiShader->Bind();
-            mJacobiShader->SetSampler("colorConstrainedTexture", 0, constraint->textures().at(0));
-            mJacobiShader->SetSampler("colorTargetTexture", 1, target->textures().at(0));
-            mQuad->Render();
-            mJacobiShader->Release();
-            temporary->release();
+            Sweep(level, constraint, region);
+            continue;
         }
 
-        else
+        const ChangeTarget target = AcquireChange(level, region);
+        Sweep(level, constraint, region, &target);
+
+        // The change of the previous check arrives while this one is reduced
+        const float previous = TakeChange();
+        RequestChange(target);
+        mFramebufferPool->Release(target.framebuffer);
+
+        if (0 <= previous)
+            change = previous;
+
+        if (0 <= previous && previous < mChangeTolerance)
         {
-            target->bind();
-            glViewport(0, 0, target->width(), target->height());
-
-            mJacobiShader->Bind();
-            mJacobiShader->SetSampler("colorConstrainedTexture", 0, constraint->textures().at(0));
-            mJacobiShader->SetSampler("colorTargetTexture", 1, temporary->textures().at(0));
-            mQuad->Render();
-            mJacobiShader->Release();
-            target->release();
+            DiscardChange();
+            return 2 * (sweep + 1);
         }
     }
+
+    DiscardChange();
+
+    return 2 * sweeps;
 }
 
-void DiffusionCurveRenderer::UpsampleRenderer::SetFramebufferSize(int size)
+void DiffusionCurveRenderer::UpsampleRenderer::Sweep(int level, GLuint constraint, const QRect& region, const ChangeTarget* change)
 {
-    for (int i = 0; i < mUpsampleFramebuffers.size(); ++i)
+    const int target = GetTexture(level);
+    const int temporary = 1 - target;
+
+    if (mSmoother == DiffusionSmoother::Jacobi)
     {
-        delete mUpsampleFramebuffers[i];
+        SmoothPass(level, temporary, target, constraint, region, -1);
+        SmoothPass(level, target, temporary, constraint, region, -1);
+
+        if (change)
+            WriteChange(*change, level, target, temporary, -1);
+    }
+    else
+    {
+        SmoothPass(level, temporary, target, constraint, region, 0);
+
+        if (change)
+            WriteChange(*change, level, temporary, target, 0);
+
+        SmoothPass(level, target, temporary, constraint, region, 1);
+
+        if (change)
+            WriteChange(*change, level, target, temporary, 1);
     }
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::SmoothPass(int level, int target, int source, GLuint constraint, const QRect& region, int parity)
+{
+    mFramebuffer->Bind(target, level);
+
+    // Enabled per pass, it would clip the clears and blits between the passes as well
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(region.x(), region.y(), region.width(), region.height());
+
+    mJacobiShader->Bind();
+    mJacobiShader->SetSampler("colorConstrainedTexture", 0, constraint);
+    mJacobiShader->SetSampler("colorTargetTexture", 1, mFramebuffer->GetTexture(source));
+    mJacobiShader->SetUniformValue("level", level);
+    mJacobiShader->SetUniformValue("parity", parity);
+    mJacobiShader->SetUniformValue("omega", mSmoother == DiffusionSmoother::Jacobi ? 1.0f : mRelaxationFactor);
+    mQuad->Render();
+    mJacobiShader->Release();
+
+    glDisable(GL_SCISSOR_TEST);
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::WriteChange(const ChangeTarget& change, int level, int current, int previous, int parity)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, mMipLevelFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, change.framebuffer->texture(), change.mipLevel);
+    glViewport(0, 0, change.size.width(), change.size.height());
+    glEnable(GL_SCISSOR_TEST);
+    glScissor(change.region.x(), change.region.y(), change.region.width(), change.region.height());
+
+    mChangeShader->Bind();
+    mChangeShader->SetSampler("previousTexture", 0, mFramebuffer->GetTexture(previous));
+    mChangeShader->SetSampler("currentTexture", 1, mFramebuffer->GetTexture(current));
+    mChangeShader->SetUniformValue("level", level);
+    mChangeShader->SetUniformValue("parity", parity);
+    mQuad->Render();
+    mChangeShader->Release();
+
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+int DiffusionCurveRenderer::UpsampleRenderer::SmoothCompute(int level, MipmapFramebuffer* downsamples, const QRect& region, bool start, float& change)
+{
+    const QRect levelSize(QPoint(0, 0), mFramebuffer->GetSize(level));
+    const GLuint constraint = downsamples->GetTexture(0);
+
+    // Work groups of the tiles that cover the region and the texels they write
+    const QPoint firstTile(region.left() / COMPUTE_SMOOTH_TILE_SIZE, region.top() / COMPUTE_SMOOTH_TILE_SIZE);
+    const QPoint lastTile(region.right() / COMPUTE_SMOOTH_TILE_SIZE, region.bottom() / COMPUTE_SMOOTH_TILE_SIZE);
+    const QRect tiles = QRect(COMPUTE_SMOOTH_TILE_SIZE * firstTile, COMPUTE_SMOOTH_TILE_SIZE * (lastTile + QPoint(1, 1)) - QPoint(1, 1)).intersected(levelSize);
+
+    // Same passes as the fragment path, a check ends a dispatch like it ends a sweep there
+    const int totalPasses = 2 * (mSmoothIterations / 2);
+    const int passesPerDispatch = mAdaptiveSmoothing ? 2 * CHANGE_CHECK_INTERVAL : COMPUTE_MAXIMUM_PASSES;
+    const int numberOfDispatches = std::max(1, (totalPasses + passesPerDispatch - 1) / passesPerDispatch);
 
-    for (int i = 0; i < mTemporaryFramebuffers.size(); ++i)
+    // Dispatches ping-pong between the two textures of the level, the last one writes the texture of the level
+    int target = numberOfDispatches % 2 == 1 ? GetTexture(level) : 1 - GetTexture(level);
+    int passes = 0;
+
+    // The jump flood guess replaces the upsampling, it is filled into the texture the first dispatch reads
+    const bool upsample = start && mInitialGuess != DiffusionInitialGuess::JumpFlood;
+
+    if (start && !upsample)
     {
-        delete mTemporaryFramebuffers[i];
+        mJumpFloodRenderer->Fill(downsamples, mFramebuffer, 1 - target, level);
+        mSmoothComputeShader->Bind();
     }
+    else if (!start)
+    {
+        // Both textures start from the last result, the dispatches read the halo of the tiles from either
+        const int halo = COMPUTE_MAXIMUM_PASSES;
+        mFramebuffer->Copy(*mFramebuffer, GetTexture(level), 1 - GetTexture(level), level, tiles.adjusted(-halo, -halo, halo, halo).intersected(levelSize));
+    }
+
+    change = -1.0f;
 
-    mUpsampleFramebuffers.clear();
-    mTemporaryFramebuffers.clear();
+    glBindImageTexture(1, constraint, level, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
 
-    while (size > 2)
+    mSmoothComputeShader->SetUniformValue("tileOffset", QVector2D(firstTile));
+
+    for (int dispatch = 0; dispatch < numberOfDispatches; ++dispatch)
     {
-        mUpsampleFramebuffers << new QOpenGLFramebufferObject(size, size, mFramebufferFormat);
+        const int dispatchPasses = std::min(passesPerDispatch, totalPasses - passes);
+        const bool measure = mAdaptiveSmoothing && 0 < dispatchPasses;
+
+        // The first dispatch upsamples the coarser level before smoothing
+        if (dispatch == 0 && upsample)
+            glBindImageTexture(0, mFramebuffer->GetTexture(GetTexture(level + 1)), level + 1, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+        else
+            glBindImageTexture(0, mFramebuffer->GetTexture(1 - target), level, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8);
+
+        glBindImageTexture(2, mFramebuffer->GetTexture(target), level, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+        ChangeTarget changeTarget;
+
+        if (measure)
+        {
+            changeTarget = AcquireChange(level, tiles);
+            glBindImageTexture(3, changeTarget.framebuffer->texture(), changeTarget.mipLevel, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        }
+
+        mSmoothComputeShader->SetUniformValue("upsample", dispatch == 0 && upsample ? 1 : 0);
+        mSmoothComputeShader->SetUniformValue("passes", dispatchPasses);
+        mSmoothComputeShader->SetUniformValue("measureChange", measure ? 1 : 0);
+
+        glDispatchCompute(lastTile.x() - firstTile.x() + 1, lastTile.y() - firstTile.y() + 1, 1);
+        glMemoryBarrier(COMPUTE_BARRIERS);
+
+        passes += dispatchPasses;
+
+        if (measure)
+        {
+            // The change of the previous dispatch arrives while this one runs
+            const float previous = TakeChange();
+            RequestChange(changeTarget);
+            mFramebufferPool->Release(changeTarget.framebuffer);
 
-        mTemporaryFramebuffers << new QOpenGLFramebufferObject(size, size, mFramebufferFormat);
+            if (0 <= previous)
+                change = previous;
 
-        size /= 2;
+            // Converged, the result may be in the other texture
+            if (0 <= previous && previous < mChangeTolerance)
+            {
+                if (target != GetTexture(level))
+                    mFramebuffer->Copy(*mFramebuffer, target, GetTexture(level), level, tiles);
+
+                break;
+            }
+        }
+
+        target = 1 - target;
     }
+
+    DiscardChange();
+
+    return passes;
+}
+
+DiffusionCurveRenderer::UpsampleRenderer::ChangeTarget DiffusionCurveRenderer::UpsampleRenderer::AcquireChange(int level, const QRect& region)
+{
+    const QSize finest = mFramebuffer->GetSize(0);
+    const QSize size = mFramebuffer->GetSize(level);
+
+    // Smallest mip level that covers the level, box filtering a power of two is an exact mean
+    const unsigned paddedSize = std::bit_ceil(unsigned(std::max(finest.width(), finest.height())));
+    const unsigned coveringSize = std::bit_ceil(unsigned(std::max(size.width(), size.height())));
+
+    ChangeTarget change;
+    change.framebuffer = mFramebufferPool->Acquire(QSize(paddedSize, paddedSize), mChangeFramebufferFormat);
+    change.mipLevel = std::countr_zero(paddedSize) - std::countr_zero(coveringSize);
+    change.size = size;
+    change.region = region;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, mMipLevelFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, change.framebuffer->texture(), change.mipLevel);
+    glClearColor(0, 0, 0, 0);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    return change;
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::RequestChange(const ChangeTarget& change)
+{
+    DCR_ASSERT(mChangeFence == nullptr);
+
+    // Reduce on the GPU from the mip level of the change, the 1x1 mip level is the mean of that mip level
+    const int lastMipLevel = std::countr_zero(unsigned(change.framebuffer->width()));
+
+    glBindTexture(GL_TEXTURE_2D, change.framebuffer->texture());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, change.mipLevel);
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    // Into the pixel buffer, glReadPixels returns without waiting for the GPU
+    glBindFramebuffer(GL_FRAMEBUFFER, mMipLevelFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, change.framebuffer->texture(), lastMipLevel);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mChangeBuffer);
+    glReadPixels(0, 0, 1, 1, GL_RED, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    QOpenGLFramebufferObject::bindDefault();
+
+    mChangeFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    // Padding and the pixels outside of the region are zero, so only the pixels of the region count
+    const double mipLevelSize = change.framebuffer->width() >> change.mipLevel;
+    mChangeScale = mipLevelSize * mipLevelSize / (double(change.region.width()) * change.region.height());
+}
+
+float DiffusionCurveRenderer::UpsampleRenderer::TakeChange()
+{
+    if (mChangeFence == nullptr)
+        return -1.0f;
+
+    glClientWaitSync(mChangeFence, GL_SYNC_FLUSH_COMMANDS_BIT, std::numeric_limits<GLuint64>::max());
+    glDeleteSync(mChangeFence);
+    mChangeFence = nullptr;
+
+    float value = 0.0f;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, mChangeBuffer);
+
+    if (const void* data = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, sizeof(float), GL_MAP_READ_BIT))
+    {
+        std::memcpy(&value, data, sizeof(float));
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    return float(value * mChangeScale);
+}
+
+void DiffusionCurveRenderer::UpsampleRenderer::DiscardChange()
+{
+    if (mChangeFence == nullptr)
+        return;
+
+    glDeleteSync(mChangeFence);
+    mChangeFence = nullptr;
 }
 
-void DiffusionCurveRenderer::UpsampleRenderer::BlitSourceFramebuffer(QOpenGLFramebufferObject* source)
+void DiffusionCurveRenderer::UpsampleRenderer::SetPyramid(const Pyramid& pyramid)
 {
-    QOpenGLFramebufferObject::blitFramebuffer(mUpsampleFramebuffers.last(),
-                                              QRect(0, 0, mUpsampleFramebuffers.last()->width(), mUpsampleFramebuffers.last()->height()),
-                                              source,
-                                              QRect(0, 0, source->width(), source->height()),
-                                              GL_COLOR_BUFFER_BIT,
-                                              GL_LINEAR,
-                                              0,
-                                              0);
+    mFramebuffer->SetFramebufferPool(mFramebufferPool);
+    mFramebuffer->SetPyramid(pyramid);
 }
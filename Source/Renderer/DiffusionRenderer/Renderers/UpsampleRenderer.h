@@ -1,12 +1,18 @@
 #pragma once
 
 #include "Core/Constants.h"
+#include "Renderer/Base/FramebufferPool.h"
+#include "Renderer/Base/MipmapFramebuffer.h"
 #include "Renderer/Base/Quad.h"
 #include "Renderer/Base/Shader.h"
+#include "Renderer/DiffusionRenderer/Renderers/JumpFloodRenderer.h"
+#include "Structs/Pyramid.h"
+#include "Structs/Enums.h"
 #include "Util/Macros.h"
 
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLFramebufferObject>
+#include <QVector>
 
 namespace DiffusionCurveRenderer
 {
@@ -15,25 +21,106 @@ namespace DiffusionCurveRenderer
       public:
         UpsampleRenderer();
 
-        void Upsample(QVector<QOpenGLFramebufferObject*> downsamples);
+        // Upsamples the downsampled levels, the constraints, from the coarsest to the finest
+        void Upsample(MipmapFramebuffer* downsamples);
 
-        QOpenGLFramebufferObject* GetResult() const { return mUpsampleFramebuffers.first(); }
+        // Smooths "region" of the finest level, in texels, starting from its last result. Only the finest level of
+        // the downsamples, the constraints, is read. The rest of the level is kept and bounds the smoothing.
+        void Refine(MipmapFramebuffer* downsamples, const QRect& region);
 
-        void SetFramebufferSize(int size);
+        // Finest level of the last upsampling as texture, level 0 of it, and as raw RGBA8 with rows bottom to top
+        GLuint GetResult() const;
+        QImage GetResultImage();
+
+        // Smoothing passes of every level of the last upsampling, the coarsest level is not smoothed
+        const QVector<int>& GetLevelPasses() const { return mLevelPasses; }
+
+        void SetPyramid(const Pyramid& pyramid);
 
       private:
-        void BlitSourceFramebuffer(QOpenGLFramebufferObject* source);
-        void Upsample(QOpenGLFramebufferObject* target, QOpenGLFramebufferObject* temporary, QOpenGLFramebufferObject* source, QOpenGLFramebufferObject* constraint);
+        // Levels alternate between the two textures so that upsampling never reads the texture it renders to,
+        // the other texture of a level is the scratch of smoothing. The finest level is in the first texture.
+        static int GetTexture(int level) { return level % 2; }
+
+        // Mip level "mipLevel" of a pooled square framebuffer, a power of two texels wide, holds the change of the
+        // last update of every pixel of a level in its lower left corner. The rest of the mip level is zero so that
+        // the last mip level is the exact sum of the changes divided by the texels of the mip level. One framebuffer
+        // covers every level. Only the pixels of "region" are written and counted.
+        struct ChangeTarget
+        {
+            QOpenGLFramebufferObject* framebuffer{ nullptr };
+            int mipLevel{ 0 };
+            QSize size;
+            QRect region;
+        };
+
+        // Initial guesses of the coarsest level and of a finer level, the first floods for the jump flood guess
+        void StartCoarsest(MipmapFramebuffer* downsamples);
+        void Start(int level, MipmapFramebuffer* downsamples);
+
+        void Upsample(int level, GLuint constraint);
+
+        // Smooths "region" of "level", in texels, with the other texture as scratch and returns the number of passes,
+        // every sweep is two passes and ends in the texture of the level. The passes read a texel beyond the region in
+        // both textures. In adaptive mode the mean change of the region is measured every CHANGE_CHECK_INTERVAL sweeps
+        // and smoothing stops at the check after the one that was below the tolerance, see TakeChange.
+        // "change" is the last mean change that was read back or -1.
+        int Smooth(int level, GLuint constraint, const QRect& region, float& change);
+
+        // Two passes of the smoother that end in the texture of "level". If "change" is given, writes the largest
+        // channel difference of the last update of every pixel to it, red-black passes update each pixel in one pass.
+        void Sweep(int level, GLuint constraint, const QRect& region, const ChangeTarget* change = nullptr);
+        void SmoothPass(int level, int target, int source, GLuint constraint, const QRect& region, int parity);
+        void WriteChange(const ChangeTarget& change, int level, int current, int previous, int parity);
+
+        // Smooths "level" with Smooth.comp, several passes per dispatch in shared memory, in the tiles that cover
+        // "region". If "start" is set, the first dispatch also upsamples unless the level starts from the jump flood
+        // guess, otherwise the level starts from its last result. In adaptive mode every dispatch is a check and
+        // writes the changes. The shader must be bound.
+        int SmoothCompute(int level, MipmapFramebuffer* downsamples, const QRect& region, bool start, float& change);
+
+        // Acquires the change target of "region" of "level" and clears its mip level
+        ChangeTarget AcquireChange(int level, const QRect& region);
+
+        // Reduces the change target to its mean on the GPU and starts reading it back into a pixel buffer.
+        // Only one read back is pending at a time.
+        void RequestChange(const ChangeTarget& change);
+
+        // Mean change of the pending read back or -1 if there is none. It was requested at the previous check,
+        // so the GPU has usually finished it and waiting for it does not stall the smoothing queued since.
+        float TakeChange();
+        void DiscardChange();
 
         Quad* mQuad;
 
         Shader* mUpsampleShader;
         Shader* mJacobiShader;
+        Shader* mChangeShader;
+        Shader* mSmoothComputeShader;
+
+        MipmapFramebuffer* mFramebuffer;
+
+        // Single channel float with mipmaps, acquired from the pool while the change of a level is measured.
+        // The mip level framebuffer attaches single mip levels of it for clearing, drawing and reading back.
+        QOpenGLFramebufferObjectFormat mChangeFramebufferFormat;
+        GLuint mMipLevelFramebuffer{ 0 };
+
+        // Pending read back of a mean change, the fence is null if there is none
+        GLuint mChangeBuffer{ 0 };
+        GLsync mChangeFence{ nullptr };
+        double mChangeScale{ 0 };
+
+        QVector<int> mLevelPasses;
 
-        QOpenGLFramebufferObjectFormat mFramebufferFormat;
-        QVector<QOpenGLFramebufferObject*> mUpsampleFramebuffers;
-        QVector<QOpenGLFramebufferObject*> mTemporaryFramebuffers;
+        DEFINE_MEMBER(int, SmoothIterations, DEFAULT_SMOOTH_ITERATIONS); // Maximum in adaptive mode
+        DEFINE_MEMBER(DiffusionSmoother, Smoother, DiffusionSmoother::Jacobi);
+        DEFINE_MEMBER(float, RelaxationFactor, DEFAULT_RELAXATION_FACTOR);
+        DEFINE_MEMBER(bool, AdaptiveSmoothing, false);
+        DEFINE_MEMBER(float, ChangeTolerance, DEFAULT_CHANGE_TOLERANCE);
+        DEFINE_MEMBER(DiffusionPasses, Passes, DiffusionPasses::Fragment);
+        DEFINE_MEMBER(DiffusionInitialGuess, InitialGuess, DiffusionInitialGuess::Downsampled);
 
-        DEFINE_MEMBER(int, SmoothIterations, DEFAULT_SMOOTH_ITERATIONS);
+        DEFINE_MEMBER_PTR(FramebufferPool, FramebufferPool);
+        DEFINE_MEMBER_PTR(JumpFloodRenderer, JumpFloodRenderer);
     };
 }
\ No newline at end of file
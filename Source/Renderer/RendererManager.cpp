@@ -12,37 +12,39 @@ void DiffusionCurveRenderer::RendererManager::Initialize()
 {
     initializeOpenGLFunctions();
 
+    // The camera of the patch buffer is set by the diffusion renderer
+    mPatchBuffer = new PatchBuffer;
+    mPatchBuffer->SetCurveContainer(mCurveContainer);
+
+    mFramebufferPool = new FramebufferPool;
+
     mContourRenderer = new ContourRenderer;
     mContourRenderer->SetCamera(mCamera);
     mContourRenderer->SetCurveContainer(mCurveContainer);
+    mContourRenderer->SetPatchBuffer(mPatchBuffer);
     mContourRenderer->Initialize();
 
     mDiffusionRenderer = new DiffusionRenderer;
     mDiffusionRenderer->SetCamera(mCamera);
     mDiffusionRenderer->SetCurveContainer(mCurveContainer);
+    mDiffusionRenderer->SetPatchBuffer(mPatchBuffer);
+    mDiffusionRenderer->SetFramebufferPool(mFramebufferPool);
     mDiffusionRenderer->Initialize();
 
-    mCurveSelectionRenderer = new CurveSelectionRenderer;
-    mCurveSelectionRenderer->SetCamera(mCamera);
-    mCurveSelectionRenderer->SetCurveContainer(mCurveContainer);
-
     mBitmapRenderer = new BitmapRenderer;
     mBitmapRenderer->SetCamera(mCamera);
 
     SetFramebufferSize(DEFAULT_FRAMEBUFFER_SIZE);
 }
 
-void DiffusionCurveRenderer::RendererManager::Resize(int width, int height)
-{
-    mCurveSelectionRenderer->Resize(width, height);
-}
-
 void DiffusionCurveRenderer::RendererManager::Clear()
 {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glViewport(0, 0, mCamera->GetWidth(), mCamera->GetHeight());
     glClearColor(1, 1, 1, 1);
     glClear(GL_COLOR_BUFFER_BIT);
+
+    mPatchBuffer->ResetStatistics();
 }
 
 void DiffusionCurveRenderer::RendererManager::RenderDiffusion()
@@ -50,14 +52,14 @@ void DiffusionCurveRenderer::RendererManager::RenderDiffusion()
     mDiffusionRenderer->Render();
 }
 
-void DiffusionCurveRenderer::RendererManager::RenderContours()
+bool DiffusionCurveRenderer::RendererManager::NeedsDiffusionRefinement() const
 {
-    mContourRenderer->Render();
+    return mDiffusionRenderer->NeedsRefinement();
 }
 
-void DiffusionCurveRenderer::RendererManager::RenderForCurveSelection()
+void DiffusionCurveRenderer::RendererManager::RenderContours()
 {
-    mCurveSelectionRenderer->Render();
+    mContourRenderer->Render();
 }
 
 void DiffusionCurveRenderer::RendererManager::RenderCurve(CurvePtr curve)
@@ -67,21 +69,23 @@ void DiffusionCurveRenderer::RendererManager::RenderCurve(CurvePtr curve)
 
 void DiffusionCurveRenderer::RendererManager::Save(const QString& path, RenderModes renderModes)
 {
-    mSaveFramebuffer = std::make_unique<QOpenGLFramebufferObject>(mCamera->GetWidth(), mCamera->GetHeight());
+    QOpenGLFramebufferObject* framebuffer = mFramebufferPool->Acquire(QSize(mCamera->GetWidth(), mCamera->GetHeight()), QOpenGLFramebufferObjectFormat());
 
     // Clear
-    glBindFramebuffer(GL_FRAMEBUFFER, mSaveFramebuffer->handle());
-    glViewport(0, 0, mSaveFramebuffer->width(), mSaveFramebuffer->height());
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer->handle());
+    glViewport(0, 0, framebuffer->width(), framebuffer->height());
     glClearColor(1, 1, 1, 1);
     glClear(GL_COLOR_BUFFER_BIT);
 
     if (renderModes.testAnyFlags(RenderMode::Diffusion))
-        mDiffusionRenderer->Render(mSaveFramebuffer.get());
+        mDiffusionRenderer->Render(framebuffer);
 
     if (renderModes.testAnyFlag(RenderMode::Contour))
-        mContourRenderer->Render(mSaveFramebuffer.get());
+        mContourRenderer->Render(framebuffer);
 
-    mSaveFramebuffer->toImage().save(path);
+    framebuffer->toImage().save(path);
+
+    mFramebufferPool->Release(framebuffer);
 }
 
 void DiffusionCurveRenderer::RendererManager::SetFramebufferSize(int size)
@@ -90,6 +94,71 @@ void DiffusionCurveRenderer::RendererManager::SetFramebufferSize(int size)
     mDiffusionRenderer->SetFramebufferSize(size);
 }
 
+void DiffusionCurveRenderer::RendererManager::SetDiffusionResolution(DiffusionResolution resolution)
+{
+    mDiffusionRenderer->SetResolution(resolution);
+}
+
+void DiffusionCurveRenderer::RendererManager::SetResolutionScale(float scale)
+{
+    mDiffusionRenderer->SetResolutionScale(scale);
+}
+
+void DiffusionCurveRenderer::RendererManager::SetMinimumLevelSize(int size)
+{
+    mDiffusionRenderer->SetMinimumLevelSize(size);
+}
+
+void DiffusionCurveRenderer::RendererManager::SetDiffusionMemoryBudget(int megabytes)
+{
+    mDiffusionRenderer->SetMemoryBudget(megabytes);
+}
+
+DiffusionCurveRenderer::DiffusionResolution DiffusionCurveRenderer::RendererManager::GetDiffusionResolution() const
+{
+    return mDiffusionRenderer->GetResolution();
+}
+
+float DiffusionCurveRenderer::RendererManager::GetResolutionScale() const
+{
+    return mDiffusionRenderer->GetResolutionScale();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetMinimumLevelSize() const
+{
+    return mDiffusionRenderer->GetMinimumLevelSize();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetDiffusionMemoryBudget() const
+{
+    return mDiffusionRenderer->GetMemoryBudget();
+}
+
+const DiffusionCurveRenderer::Pyramid& DiffusionCurveRenderer::RendererManager::GetDiffusionPyramid() const
+{
+    return mDiffusionRenderer->GetPyramid();
+}
+
+quint64 DiffusionCurveRenderer::RendererManager::GetDiffusionMemoryUsage() const
+{
+    return mDiffusionRenderer->GetMemoryUsage();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetNumberOfPooledFramebuffers() const
+{
+    return mFramebufferPool->GetNumberOfFramebuffers();
+}
+
+quint64 DiffusionCurveRenderer::RendererManager::GetAcquiredFramebufferBytes() const
+{
+    return mFramebufferPool->GetAcquiredBytes();
+}
+
+quint64 DiffusionCurveRenderer::RendererManager::GetIdleFramebufferBytes() const
+{
+    return mFramebufferPool->GetIdleBytes();
+}
+
 void DiffusionCurveRenderer::RendererManager::SetSmoothIterations(int smoothIterations)
 {
     mDiffusionRenderer->SetSmoothIterations(smoothIterations);
@@ -100,12 +169,147 @@ void DiffusionCurveRenderer::RendererManager::SetUseMultisampleFramebuffer(bool
     mDiffusionRenderer->SetUseMultisampleFramebuffer(val);
 }
 
-int DiffusionCurveRenderer::RendererManager::GetSmoothIterations() const
+void DiffusionCurveRenderer::RendererManager::SetDiffusionBackend(DiffusionBackend backend)
 {
-    return mDiffusionRenderer->GetSmoothIterations();
+    mDiffusionRenderer->SetBackend(backend);
+}
+
+DiffusionCurveRenderer::DiffusionBackend DiffusionCurveRenderer::RendererManager::GetDiffusionBackend() const
+{
+    return mDiffusionRenderer->GetBackend();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetCpuDiffusionSolver(DiffusionSolver solver)
+{
+    mDiffusionRenderer->SetCpuSolver(solver);
+}
+
+DiffusionCurveRenderer::DiffusionSolver DiffusionCurveRenderer::RendererManager::GetCpuDiffusionSolver() const
+{
+    return mDiffusionRenderer->GetCpuSolver();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetDirectSolveSize(int size)
+{
+    mDiffusionRenderer->SetDirectSolveSize(size);
+}
+
+int DiffusionCurveRenderer::RendererManager::GetDirectSolveSize() const
+{
+    return mDiffusionRenderer->GetDirectSolveSize();
 }
 
-DiffusionCurveRenderer::CurveQueryInfo DiffusionCurveRenderer::RendererManager::Query(const QPoint& queryPoint)
+void DiffusionCurveRenderer::RendererManager::SetDiffusionPasses(DiffusionPasses passes)
 {
-    return mCurveSelectionRenderer->Query(queryPoint);
+    mDiffusionRenderer->SetPasses(passes);
+}
+
+DiffusionCurveRenderer::DiffusionPasses DiffusionCurveRenderer::RendererManager::GetDiffusionPasses() const
+{
+    return mDiffusionRenderer->GetPasses();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetWarmStart(bool warmStart)
+{
+    mDiffusionRenderer->SetWarmStart(warmStart);
+}
+
+bool DiffusionCurveRenderer::RendererManager::GetWarmStart() const
+{
+    return mDiffusionRenderer->GetWarmStart();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetSmoother(DiffusionSmoother smoother)
+{
+    mDiffusionRenderer->SetSmoother(smoother);
+}
+
+DiffusionCurveRenderer::DiffusionSmoother DiffusionCurveRenderer::RendererManager::GetSmoother() const
+{
+    return mDiffusionRenderer->GetSmoother();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetRelaxationFactor(float relaxationFactor)
+{
+    mDiffusionRenderer->SetRelaxationFactor(relaxationFactor);
+}
+
+float DiffusionCurveRenderer::RendererManager::GetRelaxationFactor() const
+{
+    return mDiffusionRenderer->GetRelaxationFactor();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetAdaptiveSmoothing(bool adaptiveSmoothing)
+{
+    mDiffusionRenderer->SetAdaptiveSmoothing(adaptiveSmoothing);
+}
+
+bool DiffusionCurveRenderer::RendererManager::GetAdaptiveSmoothing() const
+{
+    return mDiffusionRenderer->GetAdaptiveSmoothing();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetChangeTolerance(float changeTolerance)
+{
+    mDiffusionRenderer->SetChangeTolerance(changeTolerance);
+}
+
+float DiffusionCurveRenderer::RendererManager::GetChangeTolerance() const
+{
+    return mDiffusionRenderer->GetChangeTolerance();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetAdaptiveTessellation(bool adaptiveTessellation)
+{
+    mPatchBuffer->SetAdaptiveTessellation(adaptiveTessellation);
+}
+
+bool DiffusionCurveRenderer::RendererManager::GetAdaptiveTessellation() const
+{
+    return mPatchBuffer->GetAdaptiveTessellation();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetTessellationTolerance(float tessellationTolerance)
+{
+    mPatchBuffer->SetTessellationTolerance(tessellationTolerance);
+}
+
+float DiffusionCurveRenderer::RendererManager::GetTessellationTolerance() const
+{
+    return mPatchBuffer->GetTessellationTolerance();
+}
+
+void DiffusionCurveRenderer::RendererManager::SetTessellationBudget(int tessellationBudget)
+{
+    mPatchBuffer->SetTessellationBudget(tessellationBudget);
+}
+
+int DiffusionCurveRenderer::RendererManager::GetTessellationBudget() const
+{
+    return mPatchBuffer->GetTessellationBudget();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetNumberOfPatches() const
+{
+    return mPatchBuffer->GetNumberOfPatches();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetNumberOfTessellationSamples() const
+{
+    return mPatchBuffer->GetNumberOfSamples();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetNumberOfDrawnPatches() const
+{
+    return mPatchBuffer->GetNumberOfDrawnPatches();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetNumberOfCulledPatches() const
+{
+    return mPatchBuffer->GetNumberOfCulledPatches();
+}
+
+int DiffusionCurveRenderer::RendererManager::GetSmoothIterations() const
+{
+    return mDiffusionRenderer->GetSmoothIterations();
 }
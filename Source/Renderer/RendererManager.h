@@ -3,15 +3,16 @@
 #include "Core/Constants.h"
 #include "Core/CurveContainer.h"
 #include "Core/OrthographicCamera.h"
+#include "Renderer/Base/FramebufferPool.h"
 #include "Renderer/Base/MultisampleFramebuffer.h"
+#include "Renderer/Base/PatchBuffer.h"
 #include "Renderer/Base/Quad.h"
 #include "Renderer/Base/Shader.h"
-#include "Renderer/CurveSelectionRenderer/CurveSelectionRenderer.h"
+#include "Structs/Pyramid.h"
 
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLFramebufferObject>
 #include <map>
-#include <memory>
 
 namespace DiffusionCurveRenderer
 {
@@ -25,12 +26,13 @@ namespace DiffusionCurveRenderer
         RendererManager() = default;
 
         void Initialize();
-        void Resize(int width, int height);
 
         void Clear();
         void RenderDiffusion();
         void RenderContours();
-        void RenderForCurveSelection();
+
+        // The diffusion of the last frame is warm started, frames have to be rendered until it is solved in full
+        bool NeedsDiffusionRefinement() const;
         void RenderCurve(CurvePtr curve);
 
         void Save(const QString& path, RenderModes renderModes);
@@ -38,24 +40,70 @@ namespace DiffusionCurveRenderer
         BitmapRenderer* GetBitmapRenderer() { return mBitmapRenderer; }
 
         void SetFramebufferSize(int size);
+        void SetDiffusionResolution(DiffusionResolution resolution);
+        void SetResolutionScale(float scale);
+        void SetMinimumLevelSize(int size);
+        void SetDiffusionMemoryBudget(int megabytes);
         void SetSmoothIterations(int smoothIterations);
         void SetUseMultisampleFramebuffer(bool val);
+        void SetDiffusionBackend(DiffusionBackend backend);
+        void SetCpuDiffusionSolver(DiffusionSolver solver);
+        void SetDirectSolveSize(int size);
+        void SetDiffusionPasses(DiffusionPasses passes);
+        void SetWarmStart(bool warmStart);
+        void SetSmoother(DiffusionSmoother smoother);
+        void SetRelaxationFactor(float relaxationFactor);
+        void SetAdaptiveSmoothing(bool adaptiveSmoothing);
+        void SetChangeTolerance(float changeTolerance);
+        void SetAdaptiveTessellation(bool adaptiveTessellation);
+        void SetTessellationTolerance(float tessellationTolerance);
+        void SetTessellationBudget(int tessellationBudget);
 
         int GetSmoothIterations() const;
         int GetFramebufferSize() const { return mFramebufferSize; };
+        DiffusionResolution GetDiffusionResolution() const;
+        float GetResolutionScale() const;
+        int GetMinimumLevelSize() const;
+        int GetDiffusionMemoryBudget() const;
+        DiffusionBackend GetDiffusionBackend() const;
+        DiffusionSolver GetCpuDiffusionSolver() const;
+        int GetDirectSolveSize() const;
+        DiffusionPasses GetDiffusionPasses() const;
+        bool GetWarmStart() const;
+        DiffusionSmoother GetSmoother() const;
+        float GetRelaxationFactor() const;
+        bool GetAdaptiveSmoothing() const;
+        float GetChangeTolerance() const;
+        bool GetAdaptiveTessellation() const;
+        float GetTessellationTolerance() const;
+        int GetTessellationBudget() const;
+
+        // Of the last frame, every sample is two vertices of a strip
+        int GetNumberOfPatches() const;
+        int GetNumberOfTessellationSamples() const;
+
+        // Diffusion pyramid of the last frame and its GPU memory in bytes
+        const Pyramid& GetDiffusionPyramid() const;
+        quint64 GetDiffusionMemoryUsage() const;
 
-        CurveQueryInfo Query(const QPoint& queryPoint);
+        // Framebuffers in the pool and their bytes, acquired ones are in use by a pass
+        int GetNumberOfPooledFramebuffers() const;
+        quint64 GetAcquiredFramebufferBytes() const;
+        quint64 GetIdleFramebufferBytes() const;
+
+        // Summed over the passes of the last frame
+        int GetNumberOfDrawnPatches() const;
+        int GetNumberOfCulledPatches() const;
 
       private:
         ContourRenderer* mContourRenderer;
         DiffusionRenderer* mDiffusionRenderer;
-        CurveSelectionRenderer* mCurveSelectionRenderer;
         BitmapRenderer* mBitmapRenderer;
+        PatchBuffer* mPatchBuffer;
+        FramebufferPool* mFramebufferPool;
 
         int mFramebufferSize{ DEFAULT_FRAMEBUFFER_SIZE };
 
-        std::unique_ptr<QOpenGLFramebufferObject> mSaveFramebuffer{ nullptr };
-
         DEFINE_MEMBER_PTR(OrthographicCamera, Camera);
         DEFINE_MEMBER_PTR(CurveContainer, CurveContainer);
     };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QVector2D>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace DiffusionCurveRenderer
+{
+    // Axis-aligned box, default constructed boxes are empty
+    struct BoundingBox
+    {
+        QVector2D min{ std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+        QVector2D max{ -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+
+        bool IsEmpty() const { return max.x() < min.x() || max.y() < min.y(); }
+
+        void Expand(const QVector2D& point)
+        {
+            min = QVector2D(std::min(min.x(), point.x()), std::min(min.y(), point.y()));
+            max = QVector2D(std::max(max.x(), point.x()), std::max(max.y(), point.y()));
+        }
+
+        void Expand(const BoundingBox& other)
+        {
+            min = QVector2D(std::min(min.x(), other.min.x()), std::min(min.y(), other.min.y()));
+            max = QVector2D(std::max(max.x(), other.max.x()), std::max(max.y(), other.max.y()));
+        }
+
+        BoundingBox Padded(float padding) const
+        {
+            return BoundingBox{ min - QVector2D(padding, padding), max + QVector2D(padding, padding) };
+        }
+
+        bool Intersects(const BoundingBox& other) const
+        {
+            return min.x() <= other.max.x() && other.min.x() <= max.x() && min.y() <= other.max.y() && other.min.y() <= max.y();
+        }
+
+        bool Contains(const QVector2D& point) const
+        {
+            return min.x() <= point.x() && point.x() <= max.x() && min.y() <= point.y() && point.y() <= max.y();
+        }
+
+        // Zero inside the box
+        float DistanceTo(const QVector2D& point) const
+        {
+            const float dx = std::max({ min.x() - point.x(), 0.0f, point.x() - max.x() });
+            const float dy = std::max({ min.y() - point.y(), 0.0f, point.y() - max.y() });
+            return std::hypot(dx, dy);
+        }
+    };
+}
@@ -18,6 +18,7 @@ namespace DiffusionCurveRenderer
         EdgeTracer,
         Potrace,
         CurveContructor,
+        CubicNormalizer,
         ColorSampler,
         Finished
     };
@@ -36,6 +37,47 @@ namespace DiffusionCurveRenderer
         Diffusion = 0x02
     };
 
+    enum class DiffusionBackend
+    {
+        Gpu,
+        Cpu
+    };
+
+    // Shader stage of the downsample, upsample and smoothing passes of the GPU backend
+    enum class DiffusionPasses
+    {
+        Fragment,
+        Compute
+    };
+
+    // Start of the levels of the GPU backend, the downsampled constraints with empty pixels in between, filled
+    // by the upsampled coarser level, or every empty pixel filled with the color of its nearest finest constraint.
+    // Only InitialGuessBenchmark selects the jump flood, it needs more passes than the downsampled guess.
+    enum class DiffusionInitialGuess
+    {
+        Downsampled,
+        JumpFlood
+    };
+
+    enum class DiffusionSmoother
+    {
+        Jacobi,
+        RedBlackSor
+    };
+
+    enum class DiffusionSolver
+    {
+        Multigrid,
+        Direct
+    };
+
+    enum class DiffusionResolution
+    {
+        Fixed,
+        Viewport,
+        MemoryBudget
+    };
+
     enum class ColorPointType
     {
         Left,
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QSize>
+#include <QVector>
+#include <algorithm>
+
+namespace DiffusionCurveRenderer
+{
+    // Sizes of the levels of the diffusion pyramid, finest first. Every level is exactly half of the
+    // previous one so that texels of neighboring levels map 2:1, the finest level is rounded up to allow it.
+    struct Pyramid
+    {
+        QVector<QSize> levels;
+
+        bool IsEmpty() const { return levels.isEmpty(); }
+        QSize GetSize() const { return levels.isEmpty() ? QSize() : levels.first(); }
+
+        bool operator==(const Pyramid&) const = default;
+
+        // Levels are halved while the shorter side of the coarsest level is at least "minimumLevelSize"
+        static Pyramid Create(int width, int height, int minimumLevelSize)
+        {
+            width = std::max(width, minimumLevelSize);
+            height = std::max(height, minimumLevelSize);
+
+            int numberOfLevels = 1;
+
+            while (minimumLevelSize <= (std::min(width, height) >> numberOfLevels))
+                ++numberOfLevels;
+
+            const int unit = 1 << (numberOfLevels - 1);
+
+            width = (width + unit - 1) / unit * unit;
+            height = (height + unit - 1) / unit * unit;
+
+            Pyramid pyramid;
+
+            for (int level = 0; level < numberOfLevels; ++level)
+                pyramid.levels << QSize(width >> level, height >> level);
+
+            return pyramid;
+        }
+    };
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Util/Logger.h"
+
+#include <QtGlobal>
+#include <array>
+#include <bit>
+#include <iterator>
+
+namespace DiffusionCurveRenderer
+{
+    // Fixed capacity storage that lives inside its owner and never allocates. Elements stay in the slot
+    // they were inserted into until they are removed, so pointers to them are stable handles, the
+    // logical order is kept separately as a list of slot indices. Each slot counts its removals, see SlotHandle.
+    template<typename T, int Capacity>
+    class SlotArray
+    {
+        static_assert(0 < Capacity && Capacity <= 64);
+
+      public:
+        template<typename Owner, typename Element>
+        class Iterator
+        {
+          public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Element*;
+            using reference = Element&;
+
+            Iterator(Owner* owner, int index)
+                : mOwner(owner)
+                , mIndex(index)
+            {
+            }
+
+            reference operator*() const { return (*mOwner)[mIndex]; }
+            pointer operator->() const { return &(*mOwner)[mIndex]; }
+
+            Iterator& operator++()
+            {
+                ++mIndex;
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return mIndex == other.mIndex; }
+
+          private:
+            Owner* mOwner;
+            int mIndex;
+        };
+
+        using iterator = Iterator<SlotArray, T>;
+        using const_iterator = Iterator<const SlotArray, const T>;
+
+        int Size() const { return mSize; }
+        bool IsEmpty() const { return mSize == 0; }
+        bool IsFull() const { return mSize == Capacity; }
+        static constexpr int GetCapacity() { return Capacity; }
+
+        T& operator[](int index) { return mSlots[mOrder[index]]; }
+        const T& operator[](int index) const { return mSlots[mOrder[index]]; }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, mSize); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, mSize); }
+
+        // Returns the inserted element or nullptr if the array is full
+        T* Insert(int index, const T& value)
+        {
+            DCR_ASSERT(0 <= index && index <= mSize);
+
+            if (IsFull())
+                return nullptr;
+
+            const int slot = std::countr_one(mUsedSlots);
+            mUsedSlots |= quint64(1) << slot;
+            mSlots[slot] = value;
+
+            for (int i = mSize; i > index; --i)
+                mOrder[i] = mOrder[i - 1];
+
+            mOrder[index] = quint8(slot);
+            ++mSize;
+
+            return &mSlots[slot];
+        }
+
+        T* Append(const T& value) { return Insert(mSize, value); }
+
+        void RemoveAt(int index)
+        {
+            DCR_ASSERT(0 <= index && index < mSize);
+
+            mUsedSlots &= ~(quint64(1) << mOrder[index]);
+            ++mGenerations[mOrder[index]];
+
+            for (int i = index; i + 1 < mSize; ++i)
+                mOrder[i] = mOrder[i + 1];
+
+            --mSize;
+        }
+
+        void Resize(int size)
+        {
+            while (mSize > size)
+                RemoveAt(mSize - 1);
+
+            while (mSize < size)
+                Append(T());
+        }
+
+        void Clear()
+        {
+            for (int i = 0; i < mSize; ++i)
+                ++mGenerations[mOrder[i]];
+
+            mUsedSlots = 0;
+            mSize = 0;
+        }
+
+        // Logical index of the element at "element", -1 if it is not stored here
+        int IndexOf(const T* element) const
+        {
+            for (int i = 0; i < mSize; ++i)
+                if (&mSlots[mOrder[i]] == element)
+                    return i;
+
+            return -1;
+        }
+
+        // Incremented whenever the element in the slot of "element" is removed
+        const quint32* GetGeneration(const T* element) const
+        {
+            DCR_ASSERT(mSlots.data() <= element && element < mSlots.data() + Capacity);
+            return &mGenerations[element - mSlots.data()];
+        }
+
+        // Stable insertion sort of the order, the elements do not move
+        template<typename Less>
+        void Sort(Less less)
+        {
+            for (int i = 1; i < mSize; ++i)
+            {
+                const quint8 slot = mOrder[i];
+                int j = i;
+
+                for (; j > 0 && less(mSlots[slot], mSlots[mOrder[j - 1]]); --j)
+                    mOrder[j] = mOrder[j - 1];
+
+                mOrder[j] = slot;
+            }
+        }
+
+      private:
+        std::array<T, Capacity> mSlots{};
+        std::array<quint8, Capacity> mOrder{};
+        std::array<quint32, Capacity> mGenerations{};
+        quint64 mUsedSlots{ 0 };
+        int mSize{ 0 };
+    };
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Util/Logger.h"
+
+#include <QtGlobal>
+#include <cstddef>
+#include <memory>
+
+namespace DiffusionCurveRenderer
+{
+    // Handle to an element of a SlotArray. Besides the pointer it remembers the generation of the slot
+    // when it was handed out. SlotArray bumps the generation whenever the element is removed, so a handle
+    // that outlives its element is stale and behaves like a null handle even after the slot is reused.
+    // Handles to elements that are not stored in a SlotArray have no generation and are never stale.
+    template<typename T>
+    class SlotHandle
+    {
+      public:
+        SlotHandle() = default;
+
+        SlotHandle(std::nullptr_t) {}
+
+        SlotHandle(std::shared_ptr<T> element)
+            : mElement(std::move(element))
+        {
+        }
+
+        SlotHandle(std::shared_ptr<T> element, const quint32* generation)
+            : mElement(std::move(element))
+            , mGeneration(generation)
+            , mExpectedGeneration(generation ? *generation : 0)
+        {
+        }
+
+        bool IsStale() const { return mGeneration && *mGeneration != mExpectedGeneration; }
+
+        // nullptr if the handle is null or stale
+        T* get() const { return IsStale() ? nullptr : mElement.get(); }
+
+        T& operator*() const
+        {
+            DCR_ASSERT(get() != nullptr);
+            return *mElement;
+        }
+
+        T* operator->() const
+        {
+            DCR_ASSERT(get() != nullptr);
+            return mElement.get();
+        }
+
+        explicit operator bool() const { return get() != nullptr; }
+
+        bool operator==(const SlotHandle& other) const { return get() == other.get(); }
+        bool operator==(std::nullptr_t) const { return get() == nullptr; }
+
+      private:
+        std::shared_ptr<T> mElement;
+        const quint32* mGeneration{ nullptr };
+        quint32 mExpectedGeneration{ 0 };
+    };
+}
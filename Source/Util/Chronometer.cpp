@@ -48,11 +48,32 @@ std::string DiffusionCurveRenderer::Chronometer::Print(const std::string& name)
 {
     const auto stats = QueryAverageStats(name);
 
-    return std::format("{:<40}: {:<5.3} ms,   {:<5.3} ms,   {:<5.3} ms",
+    return std::format("{:<40}: {:<5.3} ms,   {:<5.3} ms,   {:<5.3} ms{}",
                        name,
                        stats.callTime.count() / 1000.0f,
                        stats.lastCallTime.count() / 1000.0f,
-                       stats.longestCallTime.count() / 1000.0f);
+                       stats.longestCallTime.count() / 1000.0f,
+                       stats.annotation.empty() ? "" : ",   " + stats.annotation);
+}
+
+void DiffusionCurveRenderer::Chronometer::Annotate(const std::string& name, const std::string& annotation)
+{
+    std::scoped_lock lock(MUTEX);
+    STATS_OF_INSTANCES[name].annotation = annotation;
+}
+
+std::vector<std::string> DiffusionCurveRenderer::Chronometer::QueryNames(const std::string& prefix)
+{
+    std::scoped_lock lock(MUTEX);
+    std::vector<std::string> names;
+
+    for (const auto& [name, stats] : STATS_OF_INSTANCES)
+    {
+        if (name.starts_with(prefix))
+            names.push_back(name);
+    }
+
+    return names;
 }
 
 std::mutex DiffusionCurveRenderer::Chronometer::MUTEX = std::mutex();
@@ -4,6 +4,7 @@
 #include <map>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace DiffusionCurveRenderer
 {
@@ -18,6 +19,7 @@ namespace DiffusionCurveRenderer
         std::chrono::microseconds callTime{ 0 };
         std::chrono::microseconds lastCallTime{ 0 };
         std::chrono::microseconds longestCallTime{ 0 };
+        std::string annotation;
     };
 
     class Chronometer
@@ -29,6 +31,12 @@ namespace DiffusionCurveRenderer
         static Stats QueryAverageStats(const std::string& name);
         static std::string Print(const std::string& name);
 
+        // Free text appended to the printed stats, e.g. iteration counts
+        static void Annotate(const std::string& name, const std::string& annotation);
+
+        // Names of the measured calls that start with "prefix", for IDs built at runtime
+        static std::vector<std::string> QueryNames(const std::string& prefix);
+
       private:
         Clock mStartTime{ std::chrono::system_clock::now() };
         std::string mName;
@@ -9,6 +9,7 @@
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <algorithm>
 
 QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::Importer::ImportFromXml(const QString& filename)
 {
@@ -34,6 +35,9 @@ QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::Importer::Impo
     {
         BezierPtr curve = std::make_shared<Bezier>();
 
+        // Indexed by ColorPointType
+        QVector<ColorPoint> colorPoints[2];
+
         if (component.tagName() == "curve")
         {
             QDomElement child = component.firstChild().toElement();
@@ -81,13 +85,15 @@ QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::Importer::Impo
                     for (int i = 0; i < colors.size(); ++i)
                     {
                         const auto type = child.tagName() == "left_colors_set" ? ColorPointType::Left : ColorPointType::Right;
-                        curve->AddColorPoint(type, colors[i], positions[i] / maxGlobalID);
+                        colorPoints[int(type)] << ColorPoint{ type, colors[i], positions[i] / maxGlobalID };
                     }
                 }
                 child = child.nextSibling().toElement();
             }
         }
 
+        AddColorPoints(curve, colorPoints[0], colorPoints[1]);
+
         curve->AddBlurPoint(0, DEFAULT_BLUR_STRENGTH);
         curve->AddBlurPoint(0, DEFAULT_BLUR_STRENGTH);
 
@@ -99,6 +105,37 @@ QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::Importer::Impo
     return curves;
 }
 
+void DiffusionCurveRenderer::Importer::AddColorPoints(BezierPtr curve, const QVector<ColorPoint>& left, const QVector<ColorPoint>& right)
+{
+    const int total = left.size() + right.size();
+
+    if (total > Bezier::MAX_COLOR_POINTS)
+        LOG_WARN("Importer::AddColorPoints: A curve has {} color points, keeping {} evenly spaced ones.", total, Bezier::MAX_COLOR_POINTS);
+
+    // Each side keeps a share of the capacity proportional to its size, including its first and last points
+    const auto add = [=](const QVector<ColorPoint>& points, int budget) {
+        const int n = points.size();
+        const int count = std::min(n, budget);
+
+        for (int i = 0; i < count; ++i)
+        {
+            const ColorPoint& point = points[count == 1 ? 0 : qRound(float(i) * (n - 1) / (count - 1))];
+            curve->AddColorPoint(point.type, point.color, point.position);
+        }
+    };
+
+    int leftBudget = left.size();
+
+    if (total > Bezier::MAX_COLOR_POINTS)
+    {
+        leftBudget = qRound(float(Bezier::MAX_COLOR_POINTS) * left.size() / total);
+        leftBudget = std::clamp(leftBudget, std::min(int(left.size()), 2), Bezier::MAX_COLOR_POINTS - std::min(int(right.size()), 2));
+    }
+
+    add(left, leftBudget);
+    add(right, Bezier::MAX_COLOR_POINTS - std::min(int(left.size()), leftBudget));
+}
+
 QVector<DiffusionCurveRenderer::CurvePtr> DiffusionCurveRenderer::Importer::ImportFromJson(const QString& filename)
 {
     // Read the file
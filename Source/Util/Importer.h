@@ -1,6 +1,6 @@
 #pragma once
 
-#include "Curve/Curve.h"
+#include "Curve/Bezier.h"
 
 namespace DiffusionCurveRenderer
 {
@@ -11,5 +11,9 @@ namespace DiffusionCurveRenderer
 
         static QVector<CurvePtr> ImportFromXml(const QString& filename);
         static QVector<CurvePtr> ImportFromJson(const QString& filename);
+
+      private:
+        // Thins out the color points evenly if there are more than the curve can store
+        static void AddColorPoints(BezierPtr curve, const QVector<ColorPoint>& left, const QVector<ColorPoint>& right);
     };
 }
\ No newline at end of file
@@ -0,0 +1,18 @@
+#include "Simd.h"
+
+#include "Util/Logger.h"
+
+void DiffusionCurveRenderer::Simd::Normalize(std::span<float> xs, std::span<float> ys, float scale)
+{
+    DCR_ASSERT(xs.size() == ys.size());
+
+    ForEach(xs.size(), [&]<typename L>(int i) {
+        const auto x = L::Load(&xs[i]);
+        const auto y = L::Load(&ys[i]);
+        const auto lengthSquared = L::Add(L::Mul(x, x), L::Mul(y, y));
+        const auto factor = L::Div(L::Set(scale), L::Sqrt(lengthSquared));
+        const auto valid = L::Greater(lengthSquared, L::Set(0.00001f));
+        L::Store(&xs[i], L::Select(valid, L::Mul(x, factor), L::Set(0.0f)));
+        L::Store(&ys[i], L::Select(valid, L::Mul(y, factor), L::Set(0.0f)));
+    });
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cmath>
+#include <span>
+
+#if defined(__AVX2__)
+#define DCR_SIMD_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DCR_SIMD_SSE
+#include <emmintrin.h>
+#endif
+
+namespace DiffusionCurveRenderer
+{
+    // Thin wrappers around the vector registers available at compile time.
+    // Kernels are written once as templates over a lane type and instantiated
+    // with Simd::Native for the bulk of the data and Simd::Scalar for the tail.
+    class Simd
+    {
+      public:
+        Simd() = delete;
+
+        struct Scalar
+        {
+            using Type = float;
+            using Mask = bool;
+            static constexpr int WIDTH = 1;
+
+            static Type Load(const float* source) { return *source; }
+            static void Store(float* target, Type value) { *target = value; }
+            static Type Set(float value) { return value; }
+            static Type Add(Type a, Type b) { return a + b; }
+            static Type Sub(Type a, Type b) { return a - b; }
+            static Type Mul(Type a, Type b) { return a * b; }
+            static Type Div(Type a, Type b) { return a / b; }
+            static Type Sqrt(Type a) { return std::sqrt(a); }
+            static Type Min(Type a, Type b) { return a < b ? a : b; }
+            static Type Max(Type a, Type b) { return a < b ? b : a; }
+            static Mask LessEqual(Type a, Type b) { return a <= b; }
+            static Mask Greater(Type a, Type b) { return a > b; }
+            static Type Select(Mask mask, Type a, Type b) { return mask ? a : b; }
+        };
+
+#if defined(DCR_SIMD_SSE)
+        struct Sse
+        {
+            using Type = __m128;
+            using Mask = __m128;
+            static constexpr int WIDTH = 4;
+
+            static Type Load(const float* source) { return _mm_loadu_ps(source); }
+            static void Store(float* target, Type value) { _mm_storeu_ps(target, value); }
+            static Type Set(float value) { return _mm_set1_ps(value); }
+            static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+            static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+            static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+            static Type Div(Type a, Type b) { return _mm_div_ps(a, b); }
+            static Type Sqrt(Type a) { return _mm_sqrt_ps(a); }
+            static Type Min(Type a, Type b) { return _mm_min_ps(a, b); }
+            static Type Max(Type a, Type b) { return _mm_max_ps(a, b); }
+            static Mask LessEqual(Type a, Type b) { return _mm_cmple_ps(a, b); }
+            static Mask Greater(Type a, Type b) { return _mm_cmpgt_ps(a, b); }
+            static Type Select(Mask mask, Type a, Type b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+        };
+
+        using Native = Sse;
+#elif defined(DCR_SIMD_AVX2)
+        struct Avx2
+        {
+            using Type = __m256;
+            using Mask = __m256;
+            static constexpr int WIDTH = 8;
+
+            static Type Load(const float* source) { return _mm256_loadu_ps(source); }
+            static void Store(float* target, Type value) { _mm256_storeu_ps(target, value); }
+            static Type Set(float value) { return _mm256_set1_ps(value); }
+            static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+            static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+            static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+            static Type Div(Type a, Type b) { return _mm256_div_ps(a, b); }
+            static Type Sqrt(Type a) { return _mm256_sqrt_ps(a); }
+            static Type Min(Type a, Type b) { return _mm256_min_ps(a, b); }
+            static Type Max(Type a, Type b) { return _mm256_max_ps(a, b); }
+            static Mask LessEqual(Type a, Type b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+            static Mask Greater(Type a, Type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+            static Type Select(Mask mask, Type a, Type b) { return _mm256_blendv_ps(b, a, mask); }
+        };
+
+        using Native = Avx2;
+#else
+        using Native = Scalar;
+#endif
+
+        // Runs "kernel.template operator()<Lanes>(offset)" over [0, count) with the widest lanes first.
+        template<typename Kernel>
+        static void ForEach(int count, Kernel&& kernel)
+        {
+            int offset = 0;
+
+            for (; offset + Native::WIDTH <= count; offset += Native::WIDTH)
+                kernel.template operator()<Native>(offset);
+
+            for (; offset < count; ++offset)
+                kernel.template operator()<Scalar>(offset);
+        }
+
+        // Normalizes (xs[i], ys[i]) in place and multiplies the result by "scale".
+        // Vectors that are (almost) zero become zero, same as QVector2D::normalized().
+        static void Normalize(std::span<float> xs, std::span<float> ys, float scale = 1.0f);
+    };
+}
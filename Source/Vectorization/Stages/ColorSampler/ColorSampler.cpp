@@ -1,5 +1,7 @@
 #include "ColorSampler.h"
 
+#include <algorithm>
+
 DiffusionCurveRenderer::ColorSampler::ColorSampler(QObject* parent)
     : VectorizationStageBase(parent)
 {
@@ -33,30 +35,41 @@ void DiffusionCurveRenderer::ColorSampler::Run(const QVector<CurvePtr>& curves,
 
 void DiffusionCurveRenderer::ColorSampler::Sample(BezierPtr bezier, cv::Mat& image, cv::Mat& imageLab, const double sampleDensity)
 {
-    SampleAlongNormal(bezier, 0.0f, ColorPointType::Left, image, imageLab);
-    SampleAlongNormal(bezier, 0.0f, ColorPointType::Right, image, imageLab);
+    // Even entries are sampled on the left side, odd entries on the right side.
+    // Samples are stratified in arc length, one jittered sample per stratum, so that
+    // the fast parts of an unevenly parameterized curve are not undersampled.
+    const ArcLengthTable& table = bezier->GetArcLengthTable();
+    const float middle = table.ParameterAtFraction(0.5f);
+
+    QVector<float> parameters{ 0.0f, 0.0f, middle, middle, 1.0f, 1.0f };
+
+    const int nStrata = std::min(int(sampleDensity * table.GetLength()) - 3, (Bezier::MAX_COLOR_POINTS - int(parameters.size())) / 2);
 
-    SampleAlongNormal(bezier, 0.5, ColorPointType::Left, image, imageLab);
-    SampleAlongNormal(bezier, 0.5, ColorPointType::Right, image, imageLab);
+    for (int i = 0; i < nStrata; i++)
+    {
+        parameters << table.ParameterAtFraction((i + mRandomGenerator.bounded(1.0f)) / nStrata);
+        parameters << table.ParameterAtFraction((i + mRandomGenerator.bounded(1.0f)) / nStrata);
+    }
 
-    SampleAlongNormal(bezier, 1.0f, ColorPointType::Left, image, imageLab);
-    SampleAlongNormal(bezier, 1.0f, ColorPointType::Right, image, imageLab);
+    QVector<float> xs(parameters.size());
+    QVector<float> ys(parameters.size());
+    QVector<float> normalXs(parameters.size());
+    QVector<float> normalYs(parameters.size());
 
-    int nSamples = sampleDensity * bezier->CalculateLength();
+    bezier->PositionsAt(parameters, xs, ys);
+    bezier->NormalsAt(parameters, normalXs, normalYs);
 
-    for (int i = 0; i < nSamples - 3; i++)
+    for (int i = 0; i < parameters.size(); i++)
     {
-        SampleAlongNormal(bezier, mRandomGenerator.bounded(1.0f), ColorPointType::Left, image, imageLab);
-        SampleAlongNormal(bezier, mRandomGenerator.bounded(1.0f), ColorPointType::Right, image, imageLab);
+        const ColorPointType type = i % 2 == 0 ? ColorPointType::Left : ColorPointType::Right;
+        SampleAlongNormal(bezier, parameters[i], QVector2D(xs[i], ys[i]), QVector2D(normalXs[i], normalYs[i]), type, image, imageLab);
     }
 }
 
-void DiffusionCurveRenderer::ColorSampler::SampleAlongNormal(CurvePtr curve, float parameter, ColorPointType type, cv::Mat& image, cv::Mat& imageLab, const double distance)
+void DiffusionCurveRenderer::ColorSampler::SampleAlongNormal(CurvePtr curve, float parameter, QVector2D point, QVector2D normal, ColorPointType type, cv::Mat& image, cv::Mat& imageLab, const double distance)
 {
     const int width = image.cols;
     const int height = image.rows;
-    QVector2D point = curve->PositionAt(parameter);
-    QVector2D normal = curve->NormalAt(parameter);
 
     if (type == ColorPointType::Right)
         normal = -normal;
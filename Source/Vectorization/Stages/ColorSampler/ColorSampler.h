@@ -21,7 +21,7 @@ namespace DiffusionCurveRenderer
 
       private:
         void Sample(BezierPtr bezier, cv::Mat& image, cv::Mat& imageLab, const double sampleDensity);
-        void SampleAlongNormal(CurvePtr curve, float parameter, ColorPointType type, cv::Mat& image, cv::Mat& imageLab, const double distance = 3.0);
+        void SampleAlongNormal(CurvePtr curve, float parameter, QVector2D point, QVector2D normal, ColorPointType type, cv::Mat& image, cv::Mat& imageLab, const double distance = 3.0);
 
       private:
         QRandomGenerator mRandomGenerator;
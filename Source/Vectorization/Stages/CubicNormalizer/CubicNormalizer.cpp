@@ -0,0 +1,115 @@
+#include "CubicNormalizer.h"
+
+#include "Curve/Bernstein.h"
+#include "Util/Logger.h"
+
+#include <QVarLengthArray>
+#include <algorithm>
+
+DiffusionCurveRenderer::CubicNormalizer::CubicNormalizer(QObject* parent)
+    : VectorizationStageBase(parent)
+{
+}
+
+void DiffusionCurveRenderer::CubicNormalizer::Run(const QVector<CurvePtr>& curves, float tolerance)
+{
+    const int nCurves = curves.size();
+
+    mNumberOfInexactPieces = 0;
+
+    for (int i = 0; i < nCurves; i++)
+    {
+        const auto bezier = std::dynamic_pointer_cast<Bezier>(curves[i]);
+
+        if (bezier && bezier->GetDegree() > 3)
+            Normalize(bezier, tolerance);
+        else
+            mCurves << curves[i];
+
+        emit ProgressChanged(float(i) / (nCurves - 1));
+    }
+
+    if (mNumberOfInexactPieces > 0)
+        LOG_WARN("CubicNormalizer::Run: {} cubic pieces still deviate more than {} pixels at the maximum subdivision depth.", mNumberOfInexactPieces, tolerance);
+
+    emit Finished();
+}
+
+void DiffusionCurveRenderer::CubicNormalizer::Normalize(BezierPtr bezier, float tolerance)
+{
+    QVector<float> breaks{ 0.0f };
+    Subdivide(*bezier, 0.0f, 1.0f, tolerance, 0, breaks);
+
+    for (int i = 0; i + 1 < breaks.size(); ++i)
+    {
+        QVector2D positions[4];
+        GetCubicOn(*bezier, breaks[i], breaks[i + 1], positions);
+
+        BezierPtr cubic = std::make_shared<Bezier>();
+        cubic->SetControlPointPositions(positions);
+        cubic->SetContourColor(bezier->GetContourColor());
+        cubic->SetContourThickness(bezier->GetContourThickness());
+        cubic->SetDiffusionWidth(bezier->GetDiffusionWidth());
+        cubic->SetDiffusionGap(bezier->GetDiffusionGap());
+        cubic->Update();
+        mCurves << cubic;
+    }
+}
+
+void DiffusionCurveRenderer::CubicNormalizer::Subdivide(const Bezier& bezier, float start, float end, float tolerance, int depth, QVector<float>& breaks)
+{
+    QVector2D cubic[4];
+    GetCubicOn(bezier, start, end, cubic);
+
+    // Parametric distance at interior samples, an upper bound of the distance between the two curves
+    float maxError = 0.0f;
+
+    for (int i = 1; i < NUMBER_OF_ERROR_SAMPLES; ++i)
+    {
+        const float u = float(i) / NUMBER_OF_ERROR_SAMPLES;
+        const QVector2D original = bezier.PositionAt(start + u * (end - start));
+        maxError = std::max(maxError, original.distanceToPoint(Bernstein::Evaluate(cubic, u)));
+    }
+
+    if (maxError > tolerance && depth < MAX_DEPTH)
+    {
+        const float middle = 0.5f * (start + end);
+        Subdivide(bezier, start, middle, tolerance, depth + 1, breaks);
+        Subdivide(bezier, middle, end, tolerance, depth + 1, breaks);
+    }
+    else
+    {
+        if (maxError > tolerance)
+            ++mNumberOfInexactPieces;
+
+        breaks << end;
+    }
+}
+
+void DiffusionCurveRenderer::CubicNormalizer::GetCubicOn(const Bezier& bezier, float start, float end, QVector2D* cubic)
+{
+    // Hermite data of the original curve on [start, end], the derivatives are scaled to the local parameter
+    const int order = bezier.GetOrder();
+
+    QVarLengthArray<QVector2D, Bernstein::MAX_ORDER> positions(order);
+
+    for (int i = 0; i < order; ++i)
+        positions[i] = bezier.GetControlPointPosition(i);
+
+    const float scale = (end - start) / 3.0f;
+
+    cubic[0] = Bernstein::Evaluate(positions, start);
+    cubic[3] = Bernstein::Evaluate(positions, end);
+    cubic[1] = cubic[0] + scale * Bernstein::Derivative(positions, start);
+    cubic[2] = cubic[3] - scale * Bernstein::Derivative(positions, end);
+}
+
+const QVector<DiffusionCurveRenderer::CurvePtr>& DiffusionCurveRenderer::CubicNormalizer::GetCurves() const
+{
+    return mCurves;
+}
+
+void DiffusionCurveRenderer::CubicNormalizer::Reset()
+{
+    mCurves.clear();
+}
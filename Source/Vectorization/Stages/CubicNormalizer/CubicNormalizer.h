@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Curve/Bezier.h"
+#include "Vectorization/Stages/Base/VectorizationStageBase.h"
+
+#include <QVector>
+
+namespace DiffusionCurveRenderer
+{
+    class CubicNormalizer : public VectorizationStageBase
+    {
+      public:
+        explicit CubicNormalizer(QObject* parent);
+
+        // Replaces every Bezier of degree higher than 3 by a chain of cubic Beziers which deviate at most
+        // "tolerance" pixels from it. Each cubic is the Hermite interpolant of the original curve on an
+        // interval of its parameter, so the chain is tangent continuous. Other curves are passed as they are.
+        // Runs before ColorSampler, so the curves carry no color or blur points yet.
+        void Run(const QVector<CurvePtr>& curves, float tolerance);
+
+        const QVector<CurvePtr>& GetCurves() const;
+
+        void Reset() override;
+
+      private:
+        void Normalize(BezierPtr bezier, float tolerance);
+
+        // Appends the interval [start, end] if its cubic is within tolerance, splits it in half otherwise.
+        // Intervals at MAX_DEPTH are appended regardless and counted if they exceed the tolerance.
+        void Subdivide(const Bezier& bezier, float start, float end, float tolerance, int depth, QVector<float>& breaks);
+
+        static void GetCubicOn(const Bezier& bezier, float start, float end, QVector2D* cubic);
+
+      private:
+        QVector<CurvePtr> mCurves;
+        int mNumberOfInexactPieces{ 0 };
+
+        static constexpr int MAX_DEPTH = 8;
+        static constexpr int NUMBER_OF_ERROR_SAMPLES = 16;
+    };
+}
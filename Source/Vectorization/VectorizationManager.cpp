@@ -17,6 +17,7 @@ DiffusionCurveRenderer::VectorizationManager::VectorizationManager(QObject* pare
     , mPotrace(this)
     , mSplineCurveConstructor(this)
     , mBezierCurveConstructor(this)
+    , mCubicNormalizer(this)
     , mColorSampler(this)
 {
     Setup();
@@ -37,10 +38,13 @@ void DiffusionCurveRenderer::VectorizationManager::Setup()
             { emit ProgressChanged(0.40f + 0.20f * fraction); });
 
     connect(&mBezierCurveConstructor, &VectorizationStageBase::ProgressChanged, this, [=](float fraction)
-            { emit ProgressChanged(0.60f + 0.20f * fraction); });
+            { emit ProgressChanged(0.60f + 0.15f * fraction); });
 
     connect(&mSplineCurveConstructor, &VectorizationStageBase::ProgressChanged, this, [=](float fraction)
-            { emit ProgressChanged(0.60f + 0.20f * fraction); });
+            { emit ProgressChanged(0.60f + 0.15f * fraction); });
+
+    connect(&mCubicNormalizer, &VectorizationStageBase::ProgressChanged, this, [=](float fraction)
+            { emit ProgressChanged(0.75f + 0.05f * fraction); });
 
     connect(&mColorSampler, &VectorizationStageBase::ProgressChanged, this, [=](float fraction)
             { emit ProgressChanged(0.80f + 0.20f * fraction); });
@@ -54,6 +58,7 @@ void DiffusionCurveRenderer::VectorizationManager::Reset()
     mPotrace.Reset();
     mSplineCurveConstructor.Reset();
     mBezierCurveConstructor.Reset();
+    mCubicNormalizer.Reset();
     mColorSampler.Reset();
 }
 
@@ -86,12 +91,13 @@ void DiffusionCurveRenderer::VectorizationManager::Prepare()
     emit VectorizationStageFinished(VectorizationStage::EdgeStack, mEdgeStack.GetHeight() - 1);
 }
 
-void DiffusionCurveRenderer::VectorizationManager::Vectorize(VectorizationCurveType curveType, int edgeLevel)
+void DiffusionCurveRenderer::VectorizationManager::Vectorize(VectorizationCurveType curveType, int edgeLevel, float cubicTolerance)
 {
     mEdgeTracer.Reset();
     mPotrace.Reset();
     mSplineCurveConstructor.Reset();
     mBezierCurveConstructor.Reset();
+    mCubicNormalizer.Reset();
     mColorSampler.Reset();
 
     qDebug() << "VectorizationManager::LoadImage: Current Thread: " << QThread::currentThread();
@@ -123,16 +129,29 @@ void DiffusionCurveRenderer::VectorizationManager::Vectorize(VectorizationCurveT
     mCurrentCurveConstructor->Run(mPotrace.GetPolylines());
     emit VectorizationStageFinished(VectorizationStage::CurveContructor);
 
+    const QVector<CurvePtr>* curves = &mCurrentCurveConstructor->GetCurves();
+
+    if (cubicTolerance > 0.0f)
+    {
+        SetVectorizationStage(VectorizationStage::CubicNormalizer);
+        mCubicNormalizer.Run(*curves, cubicTolerance);
+        emit VectorizationStageFinished(VectorizationStage::CubicNormalizer);
+
+        qInfo() << "Number of curves after splitting into cubic patches is:" << mCubicNormalizer.GetCurves().size();
+
+        curves = &mCubicNormalizer.GetCurves();
+    }
+
     cv::Mat imageLAB;
     cv::cvtColor(mOriginalImage, imageLAB, cv::COLOR_BGR2Lab);
 
     SetVectorizationStage(VectorizationStage::ColorSampler);
-    mColorSampler.Run(mCurrentCurveConstructor->GetCurves(), mOriginalImage, imageLAB, 0.05);
+    mColorSampler.Run(*curves, mOriginalImage, imageLAB, 0.05);
     emit VectorizationStageFinished(VectorizationStage::ColorSampler);
 
     SetVectorizationStage(VectorizationStage::Finished);
 
-    emit VectorizationFinished(mCurrentCurveConstructor->GetCurves());
+    emit VectorizationFinished(*curves);
 }
 
 void DiffusionCurveRenderer::VectorizationManager::SetVectorizationStage(VectorizationStage stage)
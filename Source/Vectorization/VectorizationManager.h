@@ -4,6 +4,7 @@
 #include "Util/Logger.h"
 #include "Util/Macros.h"
 #include "Vectorization/Stages/ColorSampler/ColorSampler.h"
+#include "Vectorization/Stages/CubicNormalizer/CubicNormalizer.h"
 #include "Vectorization/Stages/CurveConstructor/BezierCurveConstructor.h"
 #include "Vectorization/Stages/CurveConstructor/SplineCurveConstructor.h"
 #include "Vectorization/Stages/EdgeStack/EdgeStack.h"
@@ -25,7 +26,8 @@ namespace DiffusionCurveRenderer
         explicit VectorizationManager(QObject* parent = nullptr);
 
         void LoadImage(const QString& path);
-        void Vectorize(VectorizationCurveType curveType, int edgeLevel);
+        // Beziers are split into cubic patches within "cubicTolerance" pixels if it is positive
+        void Vectorize(VectorizationCurveType curveType, int edgeLevel, float cubicTolerance = 0.0f);
 
         cv::Mat GetGaussianStackLayer(int index) { return mGaussianStack.GetLayer(index); }
         cv::Mat GetEdgeStackLayer(int index) { return mEdgeStack.GetLayer(index); }
@@ -59,6 +61,7 @@ namespace DiffusionCurveRenderer
         Potrace mPotrace;
         SplineCurveConstructor mSplineCurveConstructor;
         BezierCurveConstructor mBezierCurveConstructor;
+        CubicNormalizer mCubicNormalizer;
         ColorSampler mColorSampler;
 
         CurveConstructor* mCurrentCurveConstructor{ nullptr };
@@ -0,0 +1,148 @@
+#include "HeadlessRenderer.h"
+
+#include "Util/Importer.h"
+#include "Util/Logger.h"
+
+#include <QOpenGLFunctions>
+#include <QSurfaceFormat>
+#include <algorithm>
+#include <cstdlib>
+
+DiffusionCurveRenderer::HeadlessRenderer::~HeadlessRenderer()
+{
+    if (mContext.isValid() && mContext.makeCurrent(&mSurface))
+    {
+        delete mTarget;
+        mContext.doneCurrent();
+    }
+}
+
+bool DiffusionCurveRenderer::HeadlessRenderer::Initialize(int size)
+{
+    QSurfaceFormat format;
+    format.setVersion(4, 5);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+
+    mContext.setFormat(format);
+
+    if (!mContext.create() || mContext.format().version() < qMakePair(4, 5))
+    {
+        LOG_FATAL("HeadlessRenderer::Initialize: Could not create an OpenGL 4.5 core context.");
+        return false;
+    }
+
+    mSurface.setFormat(mContext.format());
+    mSurface.create();
+
+    if (!mContext.makeCurrent(&mSurface))
+    {
+        LOG_FATAL("HeadlessRenderer::Initialize: Could not make the OpenGL context current.");
+        return false;
+    }
+
+    LOG_INFO("HeadlessRenderer::Initialize: Renderer is {}.", reinterpret_cast<const char*>(mContext.functions()->glGetString(GL_RENDERER)));
+
+    mSize = size;
+
+    mCamera.Resize(size, size, 1.0f);
+
+    mPatchBuffer = new PatchBuffer;
+    mPatchBuffer->SetCurveContainer(&mCurveContainer);
+
+    mFramebufferPool = new FramebufferPool;
+
+    mDiffusionRenderer = new DiffusionRenderer;
+    mDiffusionRenderer->SetCamera(&mCamera);
+    mDiffusionRenderer->SetCurveContainer(&mCurveContainer);
+    mDiffusionRenderer->SetPatchBuffer(mPatchBuffer);
+    mDiffusionRenderer->SetFramebufferPool(mFramebufferPool);
+    mDiffusionRenderer->Initialize();
+    mDiffusionRenderer->SetResolution(DiffusionResolution::Fixed);
+    mDiffusionRenderer->SetFramebufferSize(size);
+
+    mTarget = new QOpenGLFramebufferObject(size, size);
+
+    return true;
+}
+
+bool DiffusionCurveRenderer::HeadlessRenderer::LoadScene(const QString& filename)
+{
+    const QVector<CurvePtr> curves = Importer::ImportFromXml(filename);
+
+    if (curves.isEmpty())
+    {
+        LOG_FATAL("HeadlessRenderer::LoadScene: No curves in '{}'.", filename.toStdString());
+        return false;
+    }
+
+    mCurveContainer.Clear();
+    mCurveContainer.AddCurves(curves);
+
+    // Whole scene in the middle of the view
+    const BoundingBox box = mCurveContainer.GetBoundingBox();
+    const QVector2D center = 0.5f * (box.min + box.max);
+    const float zoom = std::max(box.max.x() - box.min.x(), box.max.y() - box.min.y()) / mSize;
+
+    mCamera.SetZoom(zoom);
+    mCamera.SetLeft(center.x() - 0.5f * zoom * mSize);
+    mCamera.SetTop(center.y() - 0.5f * zoom * mSize);
+
+    return true;
+}
+
+QImage DiffusionCurveRenderer::HeadlessRenderer::Render()
+{
+    mDiffusionRenderer->Render(mTarget);
+    mContext.functions()->glFinish();
+
+    return mDiffusionRenderer->GetResultImage();
+}
+
+QImage DiffusionCurveRenderer::HeadlessRenderer::RenderFrame()
+{
+    // Blits to the default framebuffer of the surface
+    mDiffusionRenderer->Render();
+    mContext.functions()->glFinish();
+
+    return mDiffusionRenderer->GetResultImage();
+}
+
+DiffusionCurveRenderer::ImageDifference DiffusionCurveRenderer::CompareImages(const QImage& image, const QImage& reference, int tolerance)
+{
+    DCR_ASSERT(image.size() == reference.size());
+
+    ImageDifference result;
+
+    quint64 totalDifference = 0;
+    quint64 numberOfDifferentPixels = 0;
+
+    for (int y = 0; y < image.height(); ++y)
+    {
+        const uchar* imageRow = image.constScanLine(y);
+        const uchar* referenceRow = reference.constScanLine(y);
+
+        for (int x = 0; x < image.width(); ++x)
+        {
+            int pixelDifference = 0;
+
+            for (int c = 0; c < 4; ++c)
+            {
+                const int difference = std::abs(int(imageRow[4 * x + c]) - int(referenceRow[4 * x + c]));
+                pixelDifference = std::max(pixelDifference, difference);
+                totalDifference += difference;
+            }
+
+            result.maximum = std::max(result.maximum, pixelDifference);
+
+            if (tolerance < pixelDifference)
+                ++numberOfDifferentPixels;
+        }
+    }
+
+    const double numberOfPixels = double(image.width()) * image.height();
+
+    result.mean = totalDifference / (4 * numberOfPixels);
+    result.fractionAboveTolerance = numberOfDifferentPixels / numberOfPixels;
+
+    return result;
+}
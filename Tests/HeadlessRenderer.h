@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Core/CurveContainer.h"
+#include "Core/OrthographicCamera.h"
+#include "Renderer/Base/FramebufferPool.h"
+#include "Renderer/Base/PatchBuffer.h"
+#include "Renderer/DiffusionRenderer/DiffusionRenderer.h"
+
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QString>
+
+namespace DiffusionCurveRenderer
+{
+    // DiffusionRenderer on an offscreen OpenGL 4.5 core context without a window, for the tests and benchmarks.
+    // The camera shows the whole scene on a square of "size" pixels and the pyramid has the same fixed size.
+    class HeadlessRenderer
+    {
+      public:
+        HeadlessRenderer() = default;
+        ~HeadlessRenderer();
+
+        // False if no OpenGL 4.5 core context could be created
+        bool Initialize(int size);
+
+        // Loads an XML scene of Resources/CurveData
+        bool LoadScene(const QString& filename);
+
+        // Solves the diffusion if a setting changed since the last call and returns the raw result
+        QImage Render();
+
+        // Same as a frame of the window, edits of single curves are warm started
+        QImage RenderFrame();
+
+        DiffusionRenderer* GetDiffusionRenderer() const { return mDiffusionRenderer; }
+        CurveContainer* GetCurveContainer() { return &mCurveContainer; }
+
+      private:
+        QOffscreenSurface mSurface;
+        QOpenGLContext mContext;
+
+        OrthographicCamera mCamera;
+        CurveContainer mCurveContainer;
+
+        PatchBuffer* mPatchBuffer{ nullptr };
+        FramebufferPool* mFramebufferPool{ nullptr };
+        DiffusionRenderer* mDiffusionRenderer{ nullptr };
+        QOpenGLFramebufferObject* mTarget{ nullptr };
+
+        int mSize{ 0 };
+    };
+
+    struct ImageDifference
+    {
+        int maximum{ 0 };                   // Largest difference of a channel, out of 255
+        double mean{ 0 };                   // Mean difference of the channels, out of 255
+        double fractionAboveTolerance{ 0 }; // Pixels with a channel differing by more than the tolerance
+    };
+
+    // Per pixel difference of two RGBA8 images of the same size
+    ImageDifference CompareImages(const QImage& image, const QImage& reference, int tolerance);
+}
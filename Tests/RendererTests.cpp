@@ -0,0 +1,213 @@
+#include "HeadlessRenderer.h"
+
+#include "Util/Logger.h"
+
+#include <QGuiApplication>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <string>
+
+using namespace DiffusionCurveRenderer;
+
+namespace
+{
+    // Small enough for a software rasterizer, large enough for a few levels
+    constexpr int SCENE_SIZE = 512;
+    const QString SCENE = DCR_RESOURCES_DIR "/CurveData/zephyr.xml";
+
+    // Converges the smoothing of both the warm started region and every level of the full solve
+    constexpr int WARM_START_TEST_ITERATIONS = 400;
+    constexpr int WARM_START_TEST_CURVE = 0;
+
+    // Jacobi needs passes in the order of the squared size to converge, the direct solver is compared to a long
+    // multigrid solve of a smaller pyramid
+    constexpr int DIRECT_TEST_SIZE = 256;
+    constexpr int MULTIGRID_TEST_ITERATIONS = 4000;
+
+    bool ExpectSimilar(const std::string& name, const QImage& image, const QImage& reference, int tolerance, double maximumMean, double maximumFraction)
+    {
+        if (image.size() != reference.size())
+        {
+            LOG_FATAL("{}: Sizes of the results do not match.", name);
+            return false;
+        }
+
+        const ImageDifference difference = CompareImages(image, reference, tolerance);
+        const bool passed = difference.mean <= maximumMean && difference.fractionAboveTolerance <= maximumFraction;
+
+        LOG_INFO("{}: Max. difference is {}, mean difference is {:.4f} (at most {}), {:.4f}% of the pixels differ by more than {} (at most {}%).",
+                 name,
+                 difference.maximum,
+                 difference.mean,
+                 maximumMean,
+                 100 * difference.fractionAboveTolerance,
+                 tolerance,
+                 100 * maximumFraction);
+
+        return passed;
+    }
+
+    // The CPU backend reproduces the fragment passes on float buffers, the GPU stores every level as RGBA8.
+    // On llvmpipe the mean difference is 1.04 and 0.78% of the pixels differ by more than 8, mostly where the
+    // two rasterizers cover the ends of thin curves differently.
+    bool CpuMatchesGpu(HeadlessRenderer& renderer)
+    {
+        DiffusionRenderer* diffusion = renderer.GetDiffusionRenderer();
+
+        diffusion->SetPasses(DiffusionPasses::Fragment);
+        diffusion->SetBackend(DiffusionBackend::Gpu);
+        const QImage gpu = renderer.Render();
+
+        diffusion->SetBackend(DiffusionBackend::Cpu);
+        const QImage cpu = renderer.Render();
+
+        return ExpectSimilar("CpuMatchesGpu", gpu, cpu, 8, 1.5, 0.01);
+    }
+
+    // Smooth.comp runs the passes of Jacobi.frag in shared memory with the same RGBA8 rounding between passes,
+    // only the rounding of the arithmetic may differ. The limits are set from llvmpipe: Jacobi differs by at most 3
+    // with a mean of 0.16. Over-relaxation amplifies the rounding of red-black SOR to a mean of 0.39 and 0.09% of
+    // the pixels above 4.
+    bool ComputeMatchesFragment(HeadlessRenderer& renderer)
+    {
+        DiffusionRenderer* diffusion = renderer.GetDiffusionRenderer();
+        diffusion->SetBackend(DiffusionBackend::Gpu);
+
+        bool passed = true;
+
+        for (const DiffusionSmoother smoother : { DiffusionSmoother::Jacobi, DiffusionSmoother::RedBlackSor })
+        {
+            diffusion->SetSmoother(smoother);
+
+            diffusion->SetPasses(DiffusionPasses::Fragment);
+            const QImage fragment = renderer.Render();
+
+            diffusion->SetPasses(DiffusionPasses::Compute);
+            const QImage compute = renderer.Render();
+
+            if (smoother == DiffusionSmoother::Jacobi)
+                passed &= ExpectSimilar("ComputeMatchesFragment (Jacobi)", compute, fragment, 4, 0.25, 0.0005);
+            else
+                passed &= ExpectSimilar("ComputeMatchesFragment (red-black SOR)", compute, fragment, 4, 0.5, 0.002);
+        }
+
+        return passed;
+    }
+
+    // A moved control point smooths the previous result around the curve. With enough passes the warm started
+    // result converges to the full solve of the moved curve. On llvmpipe both passes differ by at most 13 with a
+    // mean of 0.004, the result before the move differs from the full solve by up to 210 with a mean of 0.03.
+    bool WarmStartMatchesFullSolve(HeadlessRenderer& renderer)
+    {
+        DiffusionRenderer* diffusion = renderer.GetDiffusionRenderer();
+        CurveContainer* curves = renderer.GetCurveContainer();
+
+        diffusion->SetBackend(DiffusionBackend::Gpu);
+        diffusion->SetSmoothIterations(WARM_START_TEST_ITERATIONS);
+
+        // A few texels of the finest level
+        const BoundingBox box = curves->GetBoundingBox();
+        const float offset = 4.0f * std::max(box.max.x() - box.min.x(), box.max.y() - box.min.y()) / SCENE_SIZE;
+
+        bool passed = true;
+
+        for (const DiffusionPasses passes : { DiffusionPasses::Fragment, DiffusionPasses::Compute })
+        {
+            const std::string name = passes == DiffusionPasses::Fragment ? "WarmStartMatchesFullSolve (fragment)" : "WarmStartMatchesFullSolve (compute)";
+
+            diffusion->SetPasses(passes);
+            renderer.Render();
+
+            const CurvePtr curve = curves->GetCurve(WARM_START_TEST_CURVE);
+            curve->GetControlPoint(0)->position += QVector2D(offset, offset);
+            curve->Update();
+            curves->UpdateCurve(curve);
+
+            const QImage warmStarted = renderer.RenderFrame();
+
+            if (!diffusion->NeedsRefinement())
+            {
+                LOG_FATAL("{}: The edit was solved in full instead of warm started.", name);
+                passed = false;
+                continue;
+            }
+
+            // Rendering into a target solves the warm started result in full
+            const QImage full = renderer.Render();
+
+            passed &= ExpectSimilar(name, warmStarted, full, 16, 0.01, 0.0001);
+        }
+
+        return passed;
+    }
+
+    // The direct solver solves the finest level exactly, a long multigrid solve converges to the same fixed point.
+    // On llvmpipe they differ by at most 2 with a mean of 0.025, at 2000 passes of a 512 pyramid the mean is still
+    // 0.85. A recolor keeps the constrained pixels and so the factorization.
+    bool DirectMatchesMultigrid(HeadlessRenderer& renderer)
+    {
+        DiffusionRenderer* diffusion = renderer.GetDiffusionRenderer();
+        CurveContainer* curves = renderer.GetCurveContainer();
+
+        diffusion->SetBackend(DiffusionBackend::Cpu);
+        diffusion->SetFramebufferSize(DIRECT_TEST_SIZE);
+        diffusion->SetDirectSolveSize(DIRECT_TEST_SIZE);
+        diffusion->SetSmoothIterations(MULTIGRID_TEST_ITERATIONS);
+
+        diffusion->SetCpuSolver(DiffusionSolver::Multigrid);
+        const QImage multigrid = renderer.Render();
+
+        diffusion->SetCpuSolver(DiffusionSolver::Direct);
+        const QImage direct = renderer.Render();
+
+        bool passed = ExpectSimilar("DirectMatchesMultigrid", direct, multigrid, 2, 0.05, 0.0001);
+
+        const int factorizations = diffusion->GetNumberOfCpuFactorizations();
+
+        const CurvePtr curve = curves->GetCurve(WARM_START_TEST_CURVE);
+        curve->AddColorPoint(ColorPointType::Left, QVector4D(1, 0, 0, 1), 0.5f);
+        curves->MarkAsChanged(curve);
+
+        const QImage recolored = renderer.Render();
+
+        if (diffusion->GetNumberOfCpuFactorizations() != factorizations)
+        {
+            LOG_FATAL("DirectMatchesMultigrid (recolored): The recolor factorized the system again.");
+            passed = false;
+        }
+
+        diffusion->SetCpuSolver(DiffusionSolver::Multigrid);
+        const QImage recoloredMultigrid = renderer.Render();
+
+        passed &= ExpectSimilar("DirectMatchesMultigrid (recolored)", recolored, recoloredMultigrid, 2, 0.05, 0.0001);
+
+        return passed;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    const std::map<std::string, std::function<bool(HeadlessRenderer&)>> tests = {
+        { "CpuMatchesGpu", CpuMatchesGpu },
+        { "ComputeMatchesFragment", ComputeMatchesFragment },
+        { "WarmStartMatchesFullSolve", WarmStartMatchesFullSolve },
+        { "DirectMatchesMultigrid", DirectMatchesMultigrid },
+    };
+
+    if (argc != 2 || !tests.contains(argv[1]))
+    {
+        LOG_FATAL("Usage: DiffusionCurveRendererTests <test>");
+        return EXIT_FAILURE;
+    }
+
+    HeadlessRenderer renderer;
+
+    if (!renderer.Initialize(SCENE_SIZE) || !renderer.LoadScene(SCENE))
+        return EXIT_FAILURE;
+
+    return tests.at(argv[1])(renderer) ? EXIT_SUCCESS : EXIT_FAILURE;
+}